@@ -12,6 +12,7 @@
   qt6,
   breakpad,
   jemalloc,
+  zstd,
   cli11,
   wayland,
   wayland-protocols,
@@ -38,6 +39,7 @@
   debug ? false,
   withCrashReporter ? true,
   withJemalloc ? true, # masks heap fragmentation
+  withLogCompression ? true,
   withQtSvg ? true,
   withWayland ? true,
   withX11 ? true,
@@ -74,6 +76,7 @@
     ++ lib.optional withQtSvg qt6.qtsvg
     ++ lib.optional withCrashReporter breakpad
     ++ lib.optional withJemalloc jemalloc
+    ++ lib.optional withLogCompression zstd
     ++ lib.optional (withWayland && lib.strings.compareVersions qt6.qtbase.version "6.10.0" == -1) qt6.qtwayland
     ++ lib.optionals withWayland [ wayland wayland-protocols ]
     ++ lib.optionals (withWayland && libgbm != null) [ libdrm libgbm ]
@@ -91,6 +94,7 @@
       (lib.cmakeFeature "GIT_REVISION" gitRev)
       (lib.cmakeBool "CRASH_REPORTER" withCrashReporter)
       (lib.cmakeBool "USE_JEMALLOC" withJemalloc)
+      (lib.cmakeBool "LOG_COMPRESSION" withLogCompression)
       (lib.cmakeBool "WAYLAND" withWayland)
       (lib.cmakeBool "SCREENCOPY" (libgbm != null))
       (lib.cmakeBool "SERVICE_PIPEWIRE" withPipewire)
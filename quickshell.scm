@@ -1,5 +1,6 @@
 (define-module (quickshell)
   #:use-module ((guix licenses) #:prefix license:)
+  #:use-module (gnu packages compression)
   #:use-module (gnu packages cpp)
   #:use-module (gnu packages freedesktop)
   #:use-module (gnu packages gcc)
@@ -49,13 +50,15 @@
                   qtdeclarative
                   qtwayland
                   vulkan-headers
-                  wayland))
+                  wayland
+                  (list zstd "lib")))
     (arguments
      (list #:tests? #f
            #:configure-flags
            #~(list "-GNinja"
                    "-DDISTRIBUTOR=\"In-tree Guix channel\""
                    "-DDISTRIBUTOR_DEBUGINFO_AVAILABLE=NO"
+                   "-DLOG_COMPRESSION=ON"
                    ;; Breakpad is not currently packaged for Guix.
                    "-DCRASH_REPORTER=OFF")
            #:phases
@@ -1,33 +1,366 @@
 #include "colorquantizer.hpp"
 #include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include <qatomic.h>
 #include <qcolor.h>
+#include <qcoreapplication.h>
+#include <qdatastream.h>
 #include <qdatetime.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qhashfunctions.h>
 #include <qimage.h>
 #include <qlist.h>
 #include <qlogging.h>
 #include <qloggingcategory.h>
+#include <qmath.h>
 #include <qminmax.h>
 #include <qnamespace.h>
 #include <qnumeric.h>
 #include <qobject.h>
 #include <qqmllist.h>
 #include <qrgb.h>
+#include <qsavefile.h>
 #include <qthreadpool.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
 
 #include "logcat.hpp"
+#include "paths.hpp"
 
 namespace {
 QS_LOGGING_CATEGORY(logColorQuantizer, "quickshell.colorquantizer", QtWarningMsg);
+
+// 5 bits per channel, laid out as 0b0rrrrrgggggbbbbb.
+constexpr qint32 HISTOGRAM_BITS = 5;
+constexpr qint32 HISTOGRAM_SIDE = 1 << HISTOGRAM_BITS;
+constexpr qint32 HISTOGRAM_SIZE = HISTOGRAM_SIDE * HISTOGRAM_SIDE * HISTOGRAM_SIDE;
+
+struct HistogramBin {
+	quint64 count = 0;
+	std::array<quint64, 3> sum {};
+};
+
+using ColorHistogram = std::vector<HistogramBin>;
+
+constexpr qint32 histogramIndex(qint32 r, qint32 g, qint32 b) {
+	return (r << (HISTOGRAM_BITS * 2)) | (g << HISTOGRAM_BITS) | b;
+}
+
+// Maps 0xAARRGGBB to the 5 most significant bits of each color channel.
+constexpr quint32 histogramIndex(QRgb pixel) {
+	return ((pixel >> 9) & 0x7c00) | ((pixel >> 6) & 0x03e0) | ((pixel >> 3) & 0x001f);
+}
+
+inline void addHistogramPixel(HistogramBin& bin, QRgb pixel) {
+	bin.count += 1;
+	bin.sum[0] += qRed(pixel);
+	bin.sum[1] += qGreen(pixel);
+	bin.sum[2] += qBlue(pixel);
+}
+
+void addHistogramLine(ColorHistogram& histogram, const QRgb* line, qint32 width) {
+	qint32 x = 0;
+
+#if defined(__SSE2__)
+	const auto rMask = _mm_set1_epi32(0x7c00);
+	const auto gMask = _mm_set1_epi32(0x03e0);
+	const auto bMask = _mm_set1_epi32(0x001f);
+	const auto zero = _mm_setzero_si128();
+	alignas(16) std::array<quint32, 4> indices {};
+
+	for (; x + 4 <= width; x += 4) {
+		auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + x)); // NOLINT
+
+		auto index = _mm_or_si128(
+		    _mm_or_si128(
+		        _mm_and_si128(_mm_srli_epi32(pixels, 9), rMask),
+		        _mm_and_si128(_mm_srli_epi32(pixels, 6), gMask)
+		    ),
+		    _mm_and_si128(_mm_srli_epi32(pixels, 3), bMask)
+		);
+
+		auto transparent = _mm_cmpeq_epi32(_mm_srli_epi32(pixels, 24), zero);
+		auto skipMask = _mm_movemask_ps(_mm_castsi128_ps(transparent));
+		_mm_store_si128(reinterpret_cast<__m128i*>(indices.data()), index); // NOLINT
+
+		if (skipMask == 0) {
+			// common case for opaque images, avoids per pixel branching
+			for (auto i = 0; i != 4; ++i) {
+				addHistogramPixel(histogram[indices[i]], line[x + i]); // NOLINT
+			}
+		} else if (skipMask != 0xf) {
+			for (auto i = 0; i != 4; ++i) {
+				if (skipMask & (1 << i)) continue;
+				addHistogramPixel(histogram[indices[i]], line[x + i]); // NOLINT
+			}
+		}
+	}
+#elif defined(__ARM_NEON)
+	const auto rMask = vdupq_n_u32(0x7c00);
+	const auto gMask = vdupq_n_u32(0x03e0);
+	const auto bMask = vdupq_n_u32(0x001f);
+	std::array<quint32, 4> indices {};
+	std::array<quint32, 4> opaque {};
+
+	for (; x + 4 <= width; x += 4) {
+		auto pixels = vld1q_u32(line + x); // NOLINT
+
+		auto index = vorrq_u32(
+		    vorrq_u32(vandq_u32(vshrq_n_u32(pixels, 9), rMask), vandq_u32(vshrq_n_u32(pixels, 6), gMask)),
+		    vandq_u32(vshrq_n_u32(pixels, 3), bMask)
+		);
+
+		vst1q_u32(indices.data(), index);
+		vst1q_u32(opaque.data(), vshrq_n_u32(pixels, 24));
+
+		for (auto i = 0; i != 4; ++i) {
+			if (opaque[i] == 0) continue;
+			addHistogramPixel(histogram[indices[i]], line[x + i]); // NOLINT
+		}
+	}
+#endif
+
+	for (; x != width; ++x) {
+		auto pixel = line[x]; // NOLINT
+		if (qAlpha(pixel) == 0) continue;
+		addHistogramPixel(histogram[histogramIndex(pixel)], pixel);
+	}
+}
+
+// Inclusive bounds of a region of the histogram in 5 bit color space.
+struct HistogramBox {
+	std::array<qint32, 3> min {};
+	std::array<qint32, 3> max {};
+	quint64 count = 0;
+	std::array<quint64, 3> sum {};
+
+	// Shrinks the box to the bounds of its non empty bins and recomputes its totals.
+	void shrink(const ColorHistogram& histogram) {
+		auto newMin = std::array<qint32, 3> {HISTOGRAM_SIDE, HISTOGRAM_SIDE, HISTOGRAM_SIDE};
+		auto newMax = std::array<qint32, 3> {-1, -1, -1};
+		this->count = 0;
+		this->sum = {};
+
+		for (auto r = this->min[0]; r <= this->max[0]; ++r) {
+			for (auto g = this->min[1]; g <= this->max[1]; ++g) {
+				for (auto b = this->min[2]; b <= this->max[2]; ++b) {
+					const auto& bin = histogram[histogramIndex(r, g, b)];
+					if (bin.count == 0) continue;
+
+					newMin = {qMin(newMin[0], r), qMin(newMin[1], g), qMin(newMin[2], b)};
+					newMax = {qMax(newMax[0], r), qMax(newMax[1], g), qMax(newMax[2], b)};
+
+					this->count += bin.count;
+					this->sum[0] += bin.sum[0];
+					this->sum[1] += bin.sum[1];
+					this->sum[2] += bin.sum[2];
+				}
+			}
+		}
+
+		if (this->count != 0) {
+			this->min = newMin;
+			this->max = newMax;
+		}
+	}
+
+	[[nodiscard]] QColor average() const {
+		return QColor(
+		    qRound(static_cast<double>(this->sum[0]) / static_cast<double>(this->count)),
+		    qRound(static_cast<double>(this->sum[1]) / static_cast<double>(this->count)),
+		    qRound(static_cast<double>(this->sum[2]) / static_cast<double>(this->count))
+		);
+	}
+
+	// Matches the channel preference order of findBiggestColorRange.
+	[[nodiscard]] qint32 biggestRangeChannel() const {
+		auto rRange = this->max[0] - this->min[0];
+		auto gRange = this->max[1] - this->min[1];
+		auto bRange = this->max[2] - this->min[2];
+
+		auto biggestRange = qMax(rRange, qMax(gRange, bRange));
+		if (biggestRange == rRange) return 0;
+		else if (biggestRange == gRange) return 1;
+		else return 2;
+	}
+};
+
+constexpr quint32 CACHE_MAGIC = 0x51534351; // QSCQ
+constexpr quint8 CACHE_VERSION = 1;
+
+} // namespace
+
+std::optional<ColorQuantizerCacheKey> ColorQuantizerCacheKey::forSource(
+    const QUrl& source,
+    qreal depth,
+    qreal rescaleSize,
+    ColorQuantizerAlgorithm::Enum algorithm
+) {
+	auto path = source.toLocalFile();
+	if (path.isEmpty()) return std::nullopt;
+
+	struct stat info {};
+	if (stat(path.toLocal8Bit().constData(), &info) != 0) return std::nullopt;
+
+	return ColorQuantizerCacheKey {
+	    .device = static_cast<quint64>(info.st_dev),
+	    .inode = static_cast<quint64>(info.st_ino),
+	    .mtime = static_cast<qint64>(info.st_mtim.tv_sec) * 1'000'000'000 + info.st_mtim.tv_nsec,
+	    .size = static_cast<qint64>(info.st_size),
+	    .depth = depth,
+	    .rescaleSize = rescaleSize,
+	    .algorithm = static_cast<quint8>(algorithm),
+	};
+}
+
+size_t qHash(const ColorQuantizerCacheKey& key, size_t seed) noexcept {
+	return qHashMulti(
+	    seed,
+	    key.device,
+	    key.inode,
+	    key.mtime,
+	    key.size,
+	    key.depth,
+	    key.rescaleSize,
+	    key.algorithm
+	);
+}
+
+ColorQuantizerCache::ColorQuantizerCache()
+    : path(QsPaths::instance()->shellCacheDir().filePath("colorquantizer.cache")) {
+	this->saveTimer.setSingleShot(true);
+	this->saveTimer.setInterval(1000);
+	QObject::connect(&this->saveTimer, &QTimer::timeout, [this]() { this->save(); });
+
+	// flush recency updates that haven't been written yet
+	QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [this]() {
+		if (this->saveTimer.isActive()) {
+			this->saveTimer.stop();
+			this->save();
+		}
+	});
+
+	this->load();
+}
+
+ColorQuantizerCache* ColorQuantizerCache::instance() {
+	static auto* instance = new ColorQuantizerCache(); // NOLINT
+	return instance;
+}
+
+const QList<QColor>* ColorQuantizerCache::lookup(const ColorQuantizerCacheKey& key) {
+	auto it = this->entries.find(key);
+	if (it == this->entries.end()) return nullptr;
+
+	it->lastUsed = ++this->useCounter;
+	this->scheduleSave();
+	return &it->colors;
+}
+
+void ColorQuantizerCache::insert(const ColorQuantizerCacheKey& key, const QList<QColor>& colors) {
+	this->entries.insert(key, Entry {.colors = colors, .lastUsed = ++this->useCounter});
+
+	while (this->entries.size() > MAX_ENTRIES) {
+		auto oldest = this->entries.begin();
+		for (auto it = this->entries.begin(); it != this->entries.end(); ++it) {
+			if (it->lastUsed < oldest->lastUsed) oldest = it;
+		}
+
+		this->entries.erase(oldest);
+	}
+
+	this->scheduleSave();
+}
+
+void ColorQuantizerCache::scheduleSave() {
+	if (!this->saveTimer.isActive()) this->saveTimer.start();
+}
+
+void ColorQuantizerCache::load() {
+	auto file = QFile(this->path);
+	if (!file.open(QFile::ReadOnly)) return;
+
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_6_6);
+
+	quint32 magic = 0;
+	quint8 version = 0;
+	qint64 count = 0;
+	stream >> magic >> version >> count;
+
+	if (magic != CACHE_MAGIC || version != CACHE_VERSION || count < 0) {
+		qCInfo(logColorQuantizer) << "Discarding incompatible color quantizer cache at" << this->path;
+		return;
+	}
+
+	for (qint64 i = 0; i != count; ++i) {
+		ColorQuantizerCacheKey key;
+		Entry entry;
+
+		stream >> key.device >> key.inode >> key.mtime >> key.size >> key.depth >> key.rescaleSize
+		    >> key.algorithm >> entry.lastUsed >> entry.colors;
+
+		if (stream.status() != QDataStream::Ok) {
+			qCWarning(logColorQuantizer) << "Color quantizer cache at" << this->path << "is corrupt.";
+			this->entries.clear();
+			this->useCounter = 0;
+			return;
+		}
+
+		this->useCounter = qMax(this->useCounter, entry.lastUsed);
+		this->entries.insert(key, entry);
+	}
+
+	qCDebug(logColorQuantizer) << "Loaded" << this->entries.size() << "cached palettes from"
+	                           << this->path;
+}
+
+void ColorQuantizerCache::save() {
+	auto file = QSaveFile(this->path);
+	if (!file.open(QFile::WriteOnly)) {
+		qCWarning(logColorQuantizer) << "Could not open color quantizer cache at" << this->path
+		                             << "for writing:" << file.errorString();
+		return;
+	}
+
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_6_6);
+	stream << CACHE_MAGIC << CACHE_VERSION << static_cast<qint64>(this->entries.size());
+
+	for (auto [key, entry]: this->entries.asKeyValueRange()) {
+		stream << key.device << key.inode << key.mtime << key.size << key.depth << key.rescaleSize
+		       << key.algorithm << entry.lastUsed << entry.colors;
+	}
+
+	if (!file.commit()) {
+		qCWarning(logColorQuantizer) << "Could not write color quantizer cache at" << this->path
+		                             << ":" << file.errorString();
+	}
 }
 
-ColorQuantizerOperation::ColorQuantizerOperation(QUrl* source, qreal depth, qreal rescaleSize)
+ColorQuantizerOperation::ColorQuantizerOperation(
+    QUrl* source,
+    qreal depth,
+    qreal rescaleSize,
+    ColorQuantizerAlgorithm::Enum algorithm
+)
     : source(source)
     , maxDepth(depth)
-    , rescaleSize(rescaleSize) {
+    , rescaleSize(rescaleSize)
+    , algorithm(algorithm) {
 	this->setAutoDelete(false);
 }
 
@@ -53,19 +386,23 @@ void ColorQuantizerOperation::quantizeImage(const QAtomicInteger<bool>& shouldCa
 		return;
 	}
 
-	QList<QColor> pixels;
-	for (int y = 0; y != image.height(); ++y) {
-		for (int x = 0; x != image.width(); ++x) {
-			auto pixel = image.pixel(x, y);
-			if (qAlpha(pixel) == 0) continue;
+	auto startTime = QDateTime::currentDateTime();
 
-			pixels.append(QColor::fromRgb(pixel));
+	if (this->algorithm == ColorQuantizerAlgorithm::Histogram) {
+		this->colors = this->histogramQuantization(image);
+	} else {
+		QList<QColor> pixels;
+		for (int y = 0; y != image.height(); ++y) {
+			for (int x = 0; x != image.width(); ++x) {
+				auto pixel = image.pixel(x, y);
+				if (qAlpha(pixel) == 0) continue;
+
+				pixels.append(QColor::fromRgb(pixel));
+			}
 		}
-	}
 
-	auto startTime = QDateTime::currentDateTime();
-
-	this->colors = this->quantization(pixels, 0);
+		this->colors = this->quantization(pixels, 0);
+	}
 
 	auto endTime = QDateTime::currentDateTime();
 	auto milliseconds = startTime.msecsTo(endTime);
@@ -156,6 +493,94 @@ char ColorQuantizerOperation::findBiggestColorRange(const QList<QColor>& rgbValu
 	}
 }
 
+QList<QColor> ColorQuantizerOperation::histogramQuantization(const QImage& image) {
+	// Both formats are laid out as 0xAARRGGBB, with RGB32 having a fixed alpha of 0xff.
+	auto format = image.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32;
+	auto converted = image.convertToFormat(format);
+
+	auto histogram = ColorHistogram(HISTOGRAM_SIZE);
+	for (auto y = 0; y != converted.height(); ++y) {
+		if (this->shouldCancel.loadAcquire()) return QList<QColor>();
+
+		auto* line = reinterpret_cast<const QRgb*>(converted.constScanLine(y)); // NOLINT
+		addHistogramLine(histogram, line, converted.width());
+	}
+
+	auto root = HistogramBox {
+	    .min = {0, 0, 0},
+	    .max = {HISTOGRAM_SIDE - 1, HISTOGRAM_SIDE - 1, HISTOGRAM_SIDE - 1},
+	};
+
+	root.shrink(histogram);
+
+	QList<QColor> result;
+
+	auto split = [&](auto& split, const HistogramBox& box, qint32 depth) -> void {
+		if (this->shouldCancel.loadAcquire() || box.count == 0) return;
+
+		if (depth >= this->maxDepth) {
+			result.append(box.average());
+			return;
+		}
+
+		auto channel = box.biggestRangeChannel();
+
+		if (box.min[channel] == box.max[channel]) {
+			// The box is a single bin and cannot be split further. Emit as many copies as
+			// the exact algorithm would produce when splitting a list of identical colors.
+			auto leaves = qMin(qCeil(this->maxDepth - depth), 30);
+			auto copies = qMin(box.count, static_cast<quint64>(1) << leaves);
+			auto color = box.average();
+			for (quint64 i = 0; i != copies; ++i) result.append(color);
+			return;
+		}
+
+		auto planes = std::array<quint64, HISTOGRAM_SIDE> {};
+		for (auto r = box.min[0]; r <= box.max[0]; ++r) {
+			for (auto g = box.min[1]; g <= box.max[1]; ++g) {
+				for (auto b = box.min[2]; b <= box.max[2]; ++b) {
+					auto plane = channel == 0 ? r : channel == 1 ? g : b;
+					planes[plane] += histogram[histogramIndex(r, g, b)].count;
+				}
+			}
+		}
+
+		// Split on the plane that gets the lower half closest to the exact median.
+		// Both ends of a shrunk box are non empty, so either half will have colors.
+		auto target = box.count / 2;
+		auto splitPlane = box.min[channel];
+		auto bestDistance = std::numeric_limits<quint64>::max();
+		quint64 lowerCount = 0;
+
+		for (auto plane = box.min[channel]; plane < box.max[channel]; ++plane) {
+			lowerCount += planes[plane];
+			auto distance = lowerCount > target ? lowerCount - target : target - lowerCount;
+
+			if (distance < bestDistance) {
+				bestDistance = distance;
+				splitPlane = plane;
+			}
+
+			if (lowerCount >= target) break;
+		}
+
+		auto lower = box;
+		lower.max[channel] = splitPlane;
+		lower.shrink(histogram);
+
+		auto upper = box;
+		upper.min[channel] = splitPlane + 1;
+		upper.shrink(histogram);
+
+		split(split, lower, depth + 1);
+		split(split, upper, depth + 1);
+	};
+
+	split(split, root, 0);
+
+	return result;
+}
+
 void ColorQuantizerOperation::finishRun() {
 	QMetaObject::invokeMethod(this, &ColorQuantizerOperation::finished, Qt::QueuedConnection);
 }
@@ -211,18 +636,54 @@ void ColorQuantizer::setRescaleSize(int rescaleSize) {
 	}
 }
 
+void ColorQuantizer::setAlgorithm(ColorQuantizerAlgorithm::Enum algorithm) {
+	if (this->mAlgorithm != algorithm) {
+		this->mAlgorithm = algorithm;
+		emit this->algorithmChanged();
+
+		if (this->componentCompleted) this->quantizeAsync();
+	}
+}
+
 void ColorQuantizer::operationFinished(const QList<QColor>& result) {
 	this->bColors = result;
 	this->liveOperation = nullptr;
+
+	if (this->liveCacheKey && !result.isEmpty()) {
+		ColorQuantizerCache::instance()->insert(*this->liveCacheKey, result);
+	}
+
+	this->liveCacheKey.reset();
 	emit this->colorsChanged();
 }
 
 void ColorQuantizer::quantizeAsync() {
 	if (this->liveOperation) this->cancelAsync();
 
+	this->liveCacheKey = ColorQuantizerCacheKey::forSource(
+	    this->mSource,
+	    this->mDepth,
+	    this->mRescaleSize,
+	    this->mAlgorithm
+	);
+
+	if (this->liveCacheKey) {
+		if (const auto* colors = ColorQuantizerCache::instance()->lookup(*this->liveCacheKey)) {
+			qCDebug(logColorQuantizer) << "Using cached color quantization for" << this->mSource;
+			this->liveCacheKey.reset();
+			this->bColors = *colors;
+			emit this->colorsChanged();
+			return;
+		}
+	}
+
 	qCDebug(logColorQuantizer) << "Starting color quantization asynchronously";
-	this->liveOperation =
-	    new ColorQuantizerOperation(&this->mSource, this->mDepth, this->mRescaleSize);
+	this->liveOperation = new ColorQuantizerOperation(
+	    &this->mSource,
+	    this->mDepth,
+	    this->mRescaleSize,
+	    this->mAlgorithm
+	);
 
 	QObject::connect(
 	    this->liveOperation,
@@ -242,4 +703,5 @@ void ColorQuantizer::cancelAsync() {
 
 	QObject::disconnect(this->liveOperation, nullptr, this, nullptr);
 	this->liveOperation = nullptr;
+	this->liveCacheKey.reset();
 }
@@ -3,6 +3,7 @@
 #include <utility>
 
 #include <qcontainerfwd.h>
+#include <qdatetime.h>
 #include <qdebug.h>
 #include <qdir.h>
 #include <qfile.h>
@@ -15,20 +16,30 @@
 #include <qpair.h>
 #include <qproperty.h>
 #include <qscopeguard.h>
+#include <qset.h>
 #include <qtenvironmentvariables.h>
 #include <qthreadpool.h>
 #include <qtmetamacros.h>
+#include <qtypes.h>
 #include <ranges>
 
 #include "../io/processcore.hpp"
+#include "desktopentrycache.hpp"
 #include "desktopentrymonitor.hpp"
 #include "logcat.hpp"
 #include "model.hpp"
+#include "paths.hpp"
 #include "qmlglobal.hpp"
 
 namespace {
 QS_LOGGING_CATEGORY(logDesktopEntry, "quickshell.desktopentry", QtWarningMsg);
+
+QString systemLocaleName() {
+	auto lstr = qEnvironmentVariable("LC_MESSAGES");
+	if (lstr.isEmpty()) lstr = qEnvironmentVariable("LANG");
+	return lstr;
 }
+} // namespace
 
 struct Locale {
 	explicit Locale() = default;
@@ -77,9 +88,7 @@ struct Locale {
 		static Locale* locale = nullptr; // NOLINT
 
 		if (locale == nullptr) {
-			auto lstr = qEnvironmentVariable("LC_MESSAGES");
-			if (lstr.isEmpty()) lstr = qEnvironmentVariable("LANG");
-			locale = new Locale(lstr);
+			locale = new Locale(systemLocaleName());
 		}
 
 		return *locale;
@@ -333,40 +342,156 @@ void DesktopAction::execute() const {
 	DesktopEntry::doExec(this->bCommand.value(), this->entry->bWorkingDirectory.value());
 }
 
-DesktopEntryScanner::DesktopEntryScanner(DesktopEntryManager* manager): manager(manager) {
+void DesktopEntryHeuristicIndex::rebuild(const QList<DesktopEntry*>& entries) {
+	this->startupClasses.clear();
+	this->lowercaseStartupClasses.clear();
+	this->fallbacks.clear();
+
+	auto insert = [](QHash<QString, DesktopEntry*>& hash, const QString& key, DesktopEntry* entry) {
+		if (key.isEmpty()) return;
+
+		auto& slot = hash[key];
+		if (!slot || (slot->bNoDisplay && !entry->bNoDisplay)) slot = entry;
+	};
+
+	for (auto* entry: entries) {
+		const auto& startupClass = entry->bStartupClass.value();
+		insert(this->startupClasses, startupClass, entry);
+		insert(this->lowercaseStartupClasses, startupClass.toLower(), entry);
+	}
+
+	// Skips env and its variable assignments to find the executable.
+	for (auto* entry: entries) {
+		const auto& command = entry->bCommand.value();
+		auto iter = command.begin();
+
+		if (iter != command.end() && QFileInfo(*iter).fileName() == "env") {
+			++iter;
+			while (iter != command.end() && iter->contains('=')) ++iter;
+		}
+
+		if (iter != command.end()) {
+			insert(this->fallbacks, QFileInfo(*iter).fileName().toLower(), entry);
+		}
+	}
+
+	for (auto* entry: entries) {
+		const auto& id = entry->mId;
+		auto dotIdx = id.lastIndexOf('.');
+		if (dotIdx != -1) insert(this->fallbacks, id.sliced(dotIdx + 1).toLower(), entry);
+	}
+}
+
+DesktopEntry*
+DesktopEntryHeuristicIndex::lookup(const QString& name, const QString& lowerName) const {
+	if (auto* entry = this->startupClasses.value(name)) return entry;
+	if (auto* entry = this->lowercaseStartupClasses.value(lowerName)) return entry;
+	return this->fallbacks.value(lowerName);
+}
+
+DesktopEntryScanner::DesktopEntryScanner(
+    DesktopEntryManager* manager,
+    const DesktopEntryFiles& files
+)
+    : manager(manager)
+    , files(files) {
+	this->setAutoDelete(true);
+}
+
+DesktopEntryScanner::DesktopEntryScanner(
+    DesktopEntryManager* manager,
+    const DesktopEntryFiles& files,
+    QStringList changedFiles
+)
+    : manager(manager)
+    , files(files)
+    , changedFiles(std::move(changedFiles))
+    , fullScan(false) {
 	this->setAutoDelete(true);
 }
 
 void DesktopEntryScanner::run() {
 	const auto& desktopPaths = DesktopEntryManager::desktopPaths();
-	auto scanResults = QList<ParsedDesktopEntryData>();
+	auto newFiles = DesktopEntryFiles();
+
+	if (this->fullScan) {
+		for (const auto& path: desktopPaths | std::views::reverse) {
+			auto file = QFileInfo(path);
+			if (!file.isDir()) continue;
 
-	for (const auto& path: desktopPaths | std::views::reverse) {
-		auto file = QFileInfo(path);
-		if (!file.isDir()) continue;
+			this->scanDirectory(QDir(path), QString(), newFiles);
+		}
+
+		for (auto [path, record]: this->files.asKeyValueRange()) {
+			if (!newFiles.contains(path)) this->updatedIds.insert(record.data.id);
+		}
+	} else {
+		newFiles = this->files;
+
+		for (const auto& path: this->changedFiles) {
+			auto id = DesktopEntryManager::idForPath(path);
+			if (id.isEmpty()) continue;
+
+			this->updateFile(path, id, newFiles);
+		}
+	}
+
+	// Entries are merged in order, so entries from higher priority paths
+	// (earlier in desktopPaths) must come last to replace lower priority ones.
+	struct OrderedFile {
+		qsizetype pathIndex;
+		const QString* path;
+		const ParsedDesktopEntryData* data;
+	};
+
+	auto orderedFiles = QList<OrderedFile>();
+	orderedFiles.reserve(newFiles.size());
 
-		this->scanDirectory(QDir(path), QString(), scanResults);
+	for (auto [path, record]: newFiles.asKeyValueRange()) {
+		qsizetype pathIndex = -1;
+		DesktopEntryManager::idForPath(path, &pathIndex);
+		orderedFiles.append({.pathIndex = pathIndex, .path = &path, .data = &record.data});
 	}
 
+	std::ranges::sort(orderedFiles, [](const OrderedFile& a, const OrderedFile& b) {
+		if (a.pathIndex != b.pathIndex) return a.pathIndex > b.pathIndex;
+		return *a.path < *b.path;
+	});
+
+	auto scanResults = QList<ParsedDesktopEntryData>();
+	scanResults.reserve(orderedFiles.size());
+	for (const auto& file: orderedFiles) scanResults.append(*file.data);
+
+	if (!this->updatedIds.isEmpty() || newFiles.size() != this->files.size()) {
+		DesktopEntryCache::save(this->manager->cachePath, systemLocaleName(), newFiles);
+	}
+
+	qCDebug(logDesktopEntry) << "Scan finished with" << newFiles.size() << "desktop files,"
+	                         << this->updatedIds.size() << "ids updated";
+
 	QMetaObject::invokeMethod(
 	    this->manager,
-	    "onScanCompleted",
-	    Qt::QueuedConnection,
-	    Q_ARG(QList<ParsedDesktopEntryData>, scanResults)
+	    [manager = this->manager,
+	     scanResults = std::move(scanResults),
+	     newFiles = std::move(newFiles),
+	     updatedIds = std::move(this->updatedIds)]() mutable {
+		    manager->onScanCompleted(scanResults, std::move(newFiles), updatedIds);
+	    },
+	    Qt::QueuedConnection
 	);
 }
 
 void DesktopEntryScanner::scanDirectory(
     const QDir& dir,
     const QString& idPrefix,
-    QList<ParsedDesktopEntryData>& entries
+    DesktopEntryFiles& newFiles
 ) {
 	auto dirEntries = dir.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
 
 	for (auto& entry: dirEntries) {
 		if (entry.isDir()) {
 			auto subdirPrefix = idPrefix.isEmpty() ? entry.fileName() : idPrefix + '-' + entry.fileName();
-			this->scanDirectory(QDir(entry.absoluteFilePath()), subdirPrefix, entries);
+			this->scanDirectory(QDir(entry.absoluteFilePath()), subdirPrefix, newFiles);
 		} else if (entry.isFile()) {
 			auto path = entry.filePath();
 			if (!path.endsWith(".desktop")) {
@@ -374,20 +499,54 @@ void DesktopEntryScanner::scanDirectory(
 				continue;
 			}
 
-			auto file = QFile(path);
-			if (!file.open(QFile::ReadOnly)) {
-				qCDebug(logDesktopEntry) << "Could not open file" << path;
-				continue;
-			}
-
 			auto basename = QFileInfo(entry.fileName()).completeBaseName();
 			auto id = idPrefix.isEmpty() ? basename : idPrefix + '-' + basename;
-			auto content = QString::fromUtf8(file.readAll());
+			this->updateFile(path, id, newFiles);
+		}
+	}
+}
+
+void DesktopEntryScanner::updateFile(
+    const QString& path,
+    const QString& id,
+    DesktopEntryFiles& newFiles
+) {
+	auto info = QFileInfo(path);
+
+	if (!info.isFile()) {
+		if (newFiles.remove(path)) this->updatedIds.insert(id);
+		return;
+	}
 
-			auto data = DesktopEntry::parseText(id, content);
-			entries.append(std::move(data));
+	auto mtime = info.lastModified().toMSecsSinceEpoch();
+	auto size = info.size();
+
+	if (auto it = this->files.constFind(path); it != this->files.constEnd()) {
+		if (it->mtime == mtime && it->size == size) {
+			newFiles.insert(path, *it);
+			return;
 		}
 	}
+
+	auto file = QFile(path);
+	if (!file.open(QFile::ReadOnly)) {
+		qCDebug(logDesktopEntry) << "Could not open file" << path;
+		if (newFiles.remove(path)) this->updatedIds.insert(id);
+		return;
+	}
+
+	auto content = QString::fromUtf8(file.readAll());
+
+	newFiles.insert(
+	    path,
+	    DesktopEntryFileRecord {
+	        .mtime = mtime,
+	        .size = size,
+	        .data = DesktopEntry::parseText(id, content),
+	    }
+	);
+
+	this->updatedIds.insert(id);
 }
 
 DesktopEntryManager::DesktopEntryManager(): monitor(new DesktopEntryMonitor(this)) {
@@ -398,7 +557,12 @@ DesktopEntryManager::DesktopEntryManager(): monitor(new DesktopEntryMonitor(this
 	    &DesktopEntryManager::handleFileChanges
 	);
 
-	DesktopEntryScanner(this).run();
+	this->cachePath = QsPaths::instance()->shellCacheDir().filePath("desktopentries.cache");
+
+	// Changes reported before the initial scan is delivered are queued behind it.
+	this->scanInProgress = true;
+	auto cached = DesktopEntryCache::load(this->cachePath, systemLocaleName());
+	DesktopEntryScanner(this, cached).run();
 }
 
 void DesktopEntryManager::scanDesktopEntries() {
@@ -410,9 +574,13 @@ void DesktopEntryManager::scanDesktopEntries() {
 		return;
 	}
 
-	this->scanInProgress = true;
 	this->scanQueued = false;
-	auto* scanner = new DesktopEntryScanner(this);
+	this->queuedChanges.clear();
+	this->startScan(new DesktopEntryScanner(this, this->files));
+}
+
+void DesktopEntryManager::startScan(DesktopEntryScanner* scanner) {
+	this->scanInProgress = true;
 	QThreadPool::globalInstance()->start(scanner);
 }
 
@@ -432,39 +600,26 @@ DesktopEntry* DesktopEntryManager::byId(const QString& id) {
 }
 
 DesktopEntry* DesktopEntryManager::heuristicLookup(const QString& name) {
-	if (auto* entry = this->byId(name)) return entry;
-
-	auto list = this->desktopEntries.values();
-
-	auto iter = std::ranges::find_if(list, [&](DesktopEntry* entry) {
-		return name == entry->bStartupClass.value();
-	});
+	if (auto* entry = this->desktopEntries.value(name)) return entry;
 
-	if (iter != list.end()) return *iter;
+	auto lowerName = name.toLower();
+	if (auto* entry = this->lowercaseDesktopEntries.value(lowerName)) return entry;
 
-	iter = std::ranges::find_if(list, [&](DesktopEntry* entry) {
-		return name.toLower() == entry->bStartupClass.value().toLower();
-	});
-
-	if (iter != list.end()) return *iter;
-	return nullptr;
+	return this->heuristicIndex.lookup(name, lowerName);
 }
 
 ObjectModel<DesktopEntry>* DesktopEntryManager::applications() { return &this->mApplications; }
 
-void DesktopEntryManager::handleFileChanges() {
-	qCDebug(logDesktopEntry) << "Directory change detected, performing full rescan";
+void DesktopEntryManager::handleFileChanges(const QStringList& changedFiles) {
+	qCDebug(logDesktopEntry) << "Desktop files changed, rescanning" << changedFiles;
 
 	if (this->scanInProgress) {
-		qCDebug(logDesktopEntry) << "Scan already in progress, queuing another scan";
-		this->scanQueued = true;
+		qCDebug(logDesktopEntry) << "Scan already in progress, queuing changed files";
+		this->queuedChanges.append(changedFiles);
 		return;
 	}
 
-	this->scanInProgress = true;
-	this->scanQueued = false;
-	auto* scanner = new DesktopEntryScanner(this);
-	QThreadPool::globalInstance()->start(scanner);
+	this->startScan(new DesktopEntryScanner(this, this->files, changedFiles));
 }
 
 const QStringList& DesktopEntryManager::desktopPaths() {
@@ -489,15 +644,40 @@ const QStringList& DesktopEntryManager::desktopPaths() {
 	return paths;
 }
 
-void DesktopEntryManager::onScanCompleted(const QList<ParsedDesktopEntryData>& scanResults) {
+QString DesktopEntryManager::idForPath(const QString& path, qsizetype* pathIndex) {
+	const auto& paths = DesktopEntryManager::desktopPaths();
+
+	for (auto i = 0; i < paths.length(); i++) {
+		const auto& dir = paths.at(i);
+		if (path.length() <= dir.length() + 1 || !path.startsWith(dir) || path.at(dir.length()) != '/')
+			continue;
+
+		if (pathIndex) *pathIndex = i;
+
+		auto id = path.sliced(dir.length() + 1);
+		if (id.endsWith(".desktop")) id.chop(8);
+		return id.replace('/', '-');
+	}
+
+	return QString();
+}
+
+void DesktopEntryManager::onScanCompleted(
+    const QList<ParsedDesktopEntryData>& scanResults,
+    DesktopEntryFiles files,
+    const QSet<QString>& updatedIds
+) {
 	auto guard = qScopeGuard([this] {
 		this->scanInProgress = false;
 		if (this->scanQueued) {
-			this->scanQueued = false;
 			this->scanDesktopEntries();
+		} else if (!this->queuedChanges.isEmpty()) {
+			this->handleFileChanges(std::exchange(this->queuedChanges, {}));
 		}
 	});
 
+	this->files = std::move(files);
+
 	auto oldEntries = this->desktopEntries;
 	auto newEntries = QHash<QString, DesktopEntry*>();
 	auto newLowercaseEntries = QHash<QString, DesktopEntry*>();
@@ -523,7 +703,8 @@ void DesktopEntryManager::onScanCompleted(const QList<ParsedDesktopEntryData>& s
 		if (auto it = oldEntries.find(data.id); it != oldEntries.end()) {
 			dentry = it.value();
 			oldEntries.erase(it);
-			dentry->updateState(data);
+			// unchanged files keep their current state
+			if (updatedIds.contains(data.id)) dentry->updateState(data);
 		} else {
 			dentry = new DesktopEntry(data.id, this);
 			dentry->updateState(data);
@@ -564,6 +745,21 @@ void DesktopEntryManager::onScanCompleted(const QList<ParsedDesktopEntryData>& s
 	this->desktopEntries = newEntries;
 	this->lowercaseDesktopEntries = newLowercaseEntries;
 
+	// Scan results are ordered from lowest to highest priority.
+	auto orderedEntries = QList<DesktopEntry*>();
+	auto seenEntries = QSet<DesktopEntry*>();
+	orderedEntries.reserve(newEntries.size());
+
+	for (const auto& data: scanResults | std::views::reverse) {
+		auto* entry = newEntries.value(data.id);
+		if (entry && !seenEntries.contains(entry)) {
+			seenEntries.insert(entry);
+			orderedEntries.append(entry);
+		}
+	}
+
+	this->heuristicIndex.rebuild(orderedEntries);
+
 	auto newApplications = QVector<DesktopEntry*>();
 	for (auto* entry: this->desktopEntries.values())
 		if (!entry->bNoDisplay) newApplications.append(entry);
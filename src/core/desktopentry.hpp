@@ -7,9 +7,12 @@
 #include <qhash.h>
 #include <qobject.h>
 #include <qproperty.h>
+#include <qset.h>
 #include <qqmlintegration.h>
 #include <qrunnable.h>
+#include <qstringlist.h>
 #include <qtmetamacros.h>
+#include <qtypes.h>
 
 #include "desktopentrymonitor.hpp"
 #include "doc.hpp"
@@ -46,6 +49,15 @@ struct ParsedDesktopEntryData {
 	QHash<QString, DesktopActionData> actions;
 };
 
+// A parsed desktop entry file, valid while its mtime and size are unchanged.
+struct DesktopEntryFileRecord {
+	qint64 mtime = 0;
+	qint64 size = 0;
+	ParsedDesktopEntryData data;
+};
+
+using DesktopEntryFiles = QHash<QString, DesktopEntryFileRecord>;
+
 /// A desktop entry. See @@DesktopEntries for details.
 class DesktopEntry: public QObject {
 	Q_OBJECT;
@@ -234,19 +246,48 @@ private:
 	friend class DesktopEntry;
 };
 
+// Indexes of desktop entries by startup class and fallback names, used by heuristic lookups.
+class DesktopEntryHeuristicIndex {
+public:
+	// Entries are given by precedence, except that entries shown in menus
+	// take precedence over NoDisplay entries.
+	void rebuild(const QList<DesktopEntry*>& entries);
+
+	// Matches name against startup classes, then lowercased startup classes, then fallback names.
+	// lowerName must be name.toLower().
+	[[nodiscard]] DesktopEntry* lookup(const QString& name, const QString& lowerName) const;
+
+private:
+	QHash<QString, DesktopEntry*> startupClasses;
+	QHash<QString, DesktopEntry*> lowercaseStartupClasses;
+	// lowercased executable names, then the last components of reverse DNS ids
+	QHash<QString, DesktopEntry*> fallbacks;
+};
+
 class DesktopEntryManager;
 
 class DesktopEntryScanner: public QRunnable {
 public:
-	explicit DesktopEntryScanner(DesktopEntryManager* manager);
-
+	// Scans every desktop entry directory, only parsing files missing from or changed since files.
+	explicit DesktopEntryScanner(DesktopEntryManager* manager, const DesktopEntryFiles& files);
+	// Only rescans the given files, which may have been added, changed or removed.
+	explicit DesktopEntryScanner(
+	    DesktopEntryManager* manager,
+	    const DesktopEntryFiles& files,
+	    QStringList changedFiles
+	);
 	void run() override;
-	// clang-format off
-	void scanDirectory(const QDir& dir, const QString& idPrefix, QList<ParsedDesktopEntryData>& entries);
-	// clang-format on
+	void scanDirectory(const QDir& dir, const QString& idPrefix, DesktopEntryFiles& newFiles);
 
 private:
+	void updateFile(const QString& path, const QString& id, DesktopEntryFiles& newFiles);
+
 	DesktopEntryManager* manager;
+	DesktopEntryFiles files;
+	QStringList changedFiles;
+	bool fullScan = true;
+	// ids of files parsed or removed by this scan
+	QSet<QString> updatedIds;
 };
 
 class DesktopEntryManager: public QObject {
@@ -263,23 +304,36 @@ public:
 	static DesktopEntryManager* instance();
 
 	static const QStringList& desktopPaths();
+	// Returns the id of the desktop file at path, or an empty string if it is not in a desktop path.
+	static QString idForPath(const QString& path, qsizetype* pathIndex = nullptr);
 
 signals:
 	void applicationsChanged();
 
 private slots:
-	void handleFileChanges();
-	void onScanCompleted(const QList<ParsedDesktopEntryData>& scanResults);
+	void handleFileChanges(const QStringList& changedFiles);
 
 private:
 	explicit DesktopEntryManager();
 
+	void startScan(DesktopEntryScanner* scanner);
+	void onScanCompleted(
+	    const QList<ParsedDesktopEntryData>& scanResults,
+	    DesktopEntryFiles files,
+	    const QSet<QString>& updatedIds
+	);
+
 	QHash<QString, DesktopEntry*> desktopEntries;
 	QHash<QString, DesktopEntry*> lowercaseDesktopEntries;
+	DesktopEntryHeuristicIndex heuristicIndex;
 	ObjectModel<DesktopEntry> mApplications {this};
 	DesktopEntryMonitor* monitor = nullptr;
+	// parsed desktop files by path, as of the last completed scan
+	DesktopEntryFiles files;
+	QString cachePath;
 	bool scanInProgress = false;
 	bool scanQueued = false;
+	QStringList queuedChanges;
 
 	friend class DesktopEntryScanner;
 };
@@ -310,6 +364,8 @@ public:
 	/// Look up a desktop entry by name using heuristics. Unlike @@byId(),
 	/// if no exact matches are found this function will try to guess - potentially incorrectly.
 	/// May return null.
+	///
+	/// Names are matched against ids, @@DesktopEntry.startupClass, then executable names.
 	Q_INVOKABLE [[nodiscard]] static DesktopEntry* heuristicLookup(const QString& name);
 
 	[[nodiscard]] static ObjectModel<DesktopEntry>* applications();
@@ -0,0 +1,123 @@
+#include "desktopentrycache.hpp"
+
+#include <qbytearray.h>
+#include <qdatastream.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qlogging.h>
+#include <qloggingcategory.h>
+#include <qsavefile.h>
+#include <qstring.h>
+#include <qtypes.h>
+
+#include "desktopentry.hpp"
+#include "logcat.hpp"
+
+namespace {
+QS_LOGGING_CATEGORY(logDesktopEntryCache, "quickshell.desktopentry.cache", QtWarningMsg);
+
+constexpr quint32 CACHE_MAGIC = 0x51534445; // QSDE
+constexpr quint8 CACHE_VERSION = 1;
+} // namespace
+
+// NOLINTBEGIN(misc-use-internal-linkage)
+QDataStream& operator<<(QDataStream& stream, const DesktopActionData& action) {
+	return stream << action.id << action.name << action.icon << action.execString << action.command
+	              << action.entries;
+}
+
+QDataStream& operator>>(QDataStream& stream, DesktopActionData& action) {
+	return stream >> action.id >> action.name >> action.icon >> action.execString >> action.command
+	    >> action.entries;
+}
+
+QDataStream& operator<<(QDataStream& stream, const ParsedDesktopEntryData& data) {
+	return stream << data.id << data.name << data.genericName << data.startupClass << data.noDisplay
+	              << data.hidden << data.comment << data.icon << data.execString << data.command
+	              << data.workingDirectory << data.terminal << data.categories << data.keywords
+	              << data.entries << data.actions;
+}
+
+QDataStream& operator>>(QDataStream& stream, ParsedDesktopEntryData& data) {
+	return stream >> data.id >> data.name >> data.genericName >> data.startupClass >> data.noDisplay
+	    >> data.hidden >> data.comment >> data.icon >> data.execString >> data.command
+	    >> data.workingDirectory >> data.terminal >> data.categories >> data.keywords >> data.entries
+	    >> data.actions;
+}
+// NOLINTEND(misc-use-internal-linkage)
+
+DesktopEntryFiles DesktopEntryCache::load(const QString& path, const QString& locale) {
+	auto file = QFile(path);
+	if (!file.open(QFile::ReadOnly)) return DesktopEntryFiles();
+
+	// The cache is mapped instead of read to avoid copying it before deserialization.
+	auto size = file.size();
+	auto* mapped = file.map(0, size);
+	auto bytes = mapped == nullptr
+	               ? file.readAll()
+	               : QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), size); // NOLINT
+
+	auto stream = QDataStream(bytes);
+	stream.setVersion(QDataStream::Qt_6_6);
+
+	quint32 magic = 0;
+	quint8 version = 0;
+	QString cacheLocale;
+	stream >> magic >> version >> cacheLocale;
+
+	if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+		qCInfo(logDesktopEntryCache) << "Discarding incompatible desktop entry cache at" << path;
+		return DesktopEntryFiles();
+	}
+
+	if (cacheLocale != locale) {
+		qCDebug(logDesktopEntryCache) << "Discarding desktop entry cache for locale" << cacheLocale;
+		return DesktopEntryFiles();
+	}
+
+	DesktopEntryFiles files;
+	qint64 count = 0;
+	stream >> count;
+
+	for (qint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+		QString filePath;
+		DesktopEntryFileRecord record;
+		stream >> filePath >> record.mtime >> record.size >> record.data;
+		files.insert(filePath, record);
+	}
+
+	if (stream.status() != QDataStream::Ok) {
+		qCWarning(logDesktopEntryCache) << "Desktop entry cache at" << path << "is corrupt.";
+		return DesktopEntryFiles();
+	}
+
+	qCDebug(logDesktopEntryCache) << "Loaded" << files.size() << "desktop entries from" << path;
+	return files;
+}
+
+void DesktopEntryCache::save(
+    const QString& path,
+    const QString& locale,
+    const DesktopEntryFiles& files
+) {
+	auto file = QSaveFile(path);
+	if (!file.open(QFile::WriteOnly)) {
+		qCWarning(logDesktopEntryCache) << "Could not open desktop entry cache at" << path
+		                                << "for writing:" << file.errorString();
+		return;
+	}
+
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_6_6);
+	stream << CACHE_MAGIC << CACHE_VERSION << locale;
+
+	stream << static_cast<qint64>(files.size());
+	for (auto [filePath, record]: files.asKeyValueRange()) {
+		stream << filePath << record.mtime << record.size << record.data;
+	}
+
+	if (!file.commit()) {
+		qCWarning(logDesktopEntryCache) << "Failed to write desktop entry cache at" << path << ':'
+		                                << file.errorString();
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <qcontainerfwd.h>
+#include <qhash.h>
+#include <qstring.h>
+#include <qtypes.h>
+
+#include "desktopentry.hpp"
+
+// Persistent cache of parsed desktop entry files, so launches do not have to parse
+// every desktop entry on the system.
+//
+// Localized keys are resolved while parsing, so the cache is discarded when the
+// locale it was written for differs from the current one.
+class DesktopEntryCache {
+public:
+	// Returns an empty set of files if the cache is missing or incompatible.
+	static DesktopEntryFiles load(const QString& path, const QString& locale);
+	// Safe to call from any thread.
+	static void save(const QString& path, const QString& locale, const DesktopEntryFiles& files);
+};
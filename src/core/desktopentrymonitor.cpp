@@ -1,9 +1,13 @@
 #include "desktopentrymonitor.hpp"
+#include <utility>
 
+#include <qdatetime.h>
 #include <qdir.h>
 #include <qfileinfo.h>
 #include <qfilesystemwatcher.h>
 #include <qobject.h>
+#include <qpair.h>
+#include <qset.h>
 #include <qstring.h>
 #include <qtmetamacros.h>
 
@@ -47,22 +51,87 @@ void DesktopEntryMonitor::startMonitoring() {
 	for (const auto& path: DesktopEntryManager::desktopPaths()) {
 		if (!QDir(path).exists()) continue;
 		addPathAndParents(this->watcher, path);
-		this->scanAndWatch(path);
+		this->scanAndWatch(path, nullptr);
 	}
 }
 
-void DesktopEntryMonitor::scanAndWatch(const QString& dirPath) {
+void DesktopEntryMonitor::scanAndWatch(const QString& dirPath, QStringList* changedFiles) {
 	auto dir = QDir(dirPath);
-	if (!dir.exists()) return;
+	if (!dir.exists()) {
+		this->removeDir(dirPath, changedFiles);
+		return;
+	}
 
 	this->watcher.addPath(dirPath);
 
-	auto subdirs = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
-	for (const auto& subdir: subdirs) this->watcher.addPath(subdir.absoluteFilePath());
+	auto& snapshot = this->snapshots[dirPath];
+	auto oldFiles = std::exchange(snapshot.files, {});
+	auto oldSubdirs = std::exchange(snapshot.subdirs, {});
+
+	auto entries = dir.entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+	for (const auto& entry: entries) {
+		if (entry.isDir()) {
+			// Symlinked directories may form loops. Symlinked desktop files are still read.
+			if (!entry.isSymLink()) snapshot.subdirs.append(entry.absoluteFilePath());
+		} else if (entry.fileName().endsWith(".desktop")) {
+			auto stat = qMakePair(entry.lastModified().toMSecsSinceEpoch(), entry.size());
+			snapshot.files.insert(entry.fileName(), stat);
+
+			auto old = oldFiles.find(entry.fileName());
+			if (old == oldFiles.end() || *old != stat) {
+				if (changedFiles) changedFiles->append(entry.filePath());
+			}
+
+			if (old != oldFiles.end()) oldFiles.erase(old);
+		}
+	}
+
+	if (changedFiles) {
+		for (const auto& name: oldFiles.keys()) changedFiles->append(dir.filePath(name));
+	}
+
+	// the snapshot reference is invalidated by recursion
+	auto subdirs = snapshot.subdirs;
+
+	for (const auto& subdir: oldSubdirs) {
+		if (!subdirs.contains(subdir)) this->removeDir(subdir, changedFiles);
+	}
+
+	for (const auto& subdir: subdirs) {
+		if (!this->snapshots.contains(subdir)) this->scanAndWatch(subdir, changedFiles);
+	}
+}
+
+void DesktopEntryMonitor::removeDir(const QString& dirPath, QStringList* changedFiles) {
+	auto snapshot = this->snapshots.take(dirPath);
+	this->watcher.removePath(dirPath);
+
+	if (changedFiles) {
+		for (const auto& name: snapshot.files.keys()) changedFiles->append(dirPath + '/' + name);
+	}
+
+	for (const auto& subdir: snapshot.subdirs) this->removeDir(subdir, changedFiles);
 }
 
-void DesktopEntryMonitor::onDirectoryChanged(const QString& /*path*/) {
+void DesktopEntryMonitor::onDirectoryChanged(const QString& path) {
+	this->pendingDirs.insert(path);
 	this->debounceTimer.start();
 }
 
-void DesktopEntryMonitor::processChanges() { emit this->desktopEntriesChanged(); }
\ No newline at end of file
+void DesktopEntryMonitor::processChanges() {
+	QStringList changedFiles;
+
+	// Data directories created after startup are only seen through their watched parents.
+	for (const auto& path: DesktopEntryManager::desktopPaths()) {
+		if (!this->snapshots.contains(path) && QDir(path).exists()) {
+			addPathAndParents(this->watcher, path);
+			this->scanAndWatch(path, &changedFiles);
+		}
+	}
+
+	for (const auto& path: std::exchange(this->pendingDirs, {})) {
+		if (this->snapshots.contains(path)) this->scanAndWatch(path, &changedFiles);
+	}
+
+	if (!changedFiles.isEmpty()) emit this->desktopEntriesChanged(changedFiles);
+}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <qcontainerfwd.h>
 #include <qfilesystemwatcher.h>
+#include <qhash.h>
 #include <qobject.h>
+#include <qset.h>
 #include <qstringlist.h>
 #include <qtimer.h>
 
@@ -17,16 +20,27 @@ public:
 	DesktopEntryMonitor& operator=(DesktopEntryMonitor&&) = delete;
 
 signals:
-	void desktopEntriesChanged();
+	// Paths of desktop files which were added, modified or removed.
+	void desktopEntriesChanged(const QStringList& changedFiles);
 
 private slots:
 	void onDirectoryChanged(const QString& path);
 	void processChanges();
 
 private:
+	struct DirSnapshot {
+		// desktop file name to mtime and size
+		QHash<QString, QPair<qint64, qint64>> files;
+		QStringList subdirs;
+	};
+
 	void startMonitoring();
-	void scanAndWatch(const QString& dirPath);
+	// Updates the snapshot of a directory and its new subdirectories, collecting changed files.
+	void scanAndWatch(const QString& dirPath, QStringList* changedFiles);
+	void removeDir(const QString& dirPath, QStringList* changedFiles);
 
 	QFileSystemWatcher watcher;
 	QTimer debounceTimer;
+	QHash<QString, DirSnapshot> snapshots;
+	QSet<QString> pendingDirs;
 };
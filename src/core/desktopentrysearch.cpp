@@ -0,0 +1,376 @@
+#include "desktopentrysearch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <qcontainerfwd.h>
+#include <qlist.h>
+#include <qobject.h>
+#include <qpair.h>
+#include <qstring.h>
+#include <qstringlist.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "desktopentry.hpp"
+#include "model.hpp"
+
+namespace {
+
+// Match scores, best first. Fuzzy matches score between FUZZY and SECONDARY_SUBSTRING.
+constexpr qint32 SCORE_EXACT = 1000;
+constexpr qint32 SCORE_PREFIX = 800;
+constexpr qint32 SCORE_NAME_WORD = 600;
+constexpr qint32 SCORE_NAME_SUBSTRING = 400;
+constexpr qint32 SCORE_SECONDARY_WORD = 300;
+constexpr qint32 SCORE_SECONDARY_SUBSTRING = 200;
+constexpr qint32 SCORE_FUZZY = 100;
+constexpr qint32 SCORE_FUZZY_BONUS_MAX = 99;
+
+// A frequency of 1 is worth 40 points, 7 is worth 120 and 255 is worth 320.
+constexpr double FREQUENCY_WEIGHT = 40.0;
+
+quint64 trigramKey(const QChar* chars) {
+	auto key = static_cast<quint64>(chars[0].unicode()) << 32; // NOLINT
+	key |= static_cast<quint64>(chars[1].unicode()) << 16;     // NOLINT
+	return key | chars[2].unicode();                           // NOLINT
+}
+
+bool isWordStart(const QString& text, qsizetype index) {
+	return index == 0 || !text.at(index - 1).isLetterOrNumber();
+}
+
+qint32 substringScore(const QString& text, const QString& query, qint32 wordScore, qint32 score) {
+	auto index = text.indexOf(query);
+	if (index == -1) return 0;
+
+	while (index != -1) {
+		if (isWordStart(text, index)) return wordScore;
+		index = text.indexOf(query, index + 1);
+	}
+
+	return score;
+}
+
+// Greedily matches query as a subsequence of text, preferring consecutive characters
+// and characters at the start of words.
+qint32 fuzzyScore(const QString& text, const QString& query) {
+	qsizetype textIndex = 0;
+	qsizetype last = -2;
+	qint32 bonus = 0;
+
+	for (auto c: query) {
+		textIndex = text.indexOf(c, textIndex);
+		if (textIndex == -1) return 0;
+
+		if (textIndex == last + 1) bonus += 4;
+		else if (isWordStart(text, textIndex)) bonus += 6;
+		else bonus -= 1;
+
+		last = textIndex;
+		textIndex++;
+	}
+
+	return SCORE_FUZZY + std::clamp(bonus, 0, SCORE_FUZZY_BONUS_MAX);
+}
+
+void appendWords(const QString& text, qint32 item, QList<QPair<QString, qint32>>& words) {
+	qsizetype start = -1;
+
+	for (qsizetype i = 0; i <= text.length(); i++) {
+		auto letter = i != text.length() && text.at(i).isLetterOrNumber();
+
+		if (letter && start == -1) {
+			start = i;
+		} else if (!letter && start != -1) {
+			words.append(qMakePair(text.sliced(start, i - start), item));
+			start = -1;
+		}
+	}
+}
+
+// Index shared by all searches, rebuilt lazily after the applications list changes.
+struct SharedIndex {
+	DesktopEntrySearchIndex index;
+	bool dirty = true;
+};
+
+SharedIndex* sharedIndex() {
+	static auto* shared = [] {
+		auto* shared = new SharedIndex(); // NOLINT
+		auto* manager = DesktopEntryManager::instance();
+
+		QObject::connect(manager, &DesktopEntryManager::applicationsChanged, manager, [shared]() {
+			shared->dirty = true;
+		});
+
+		return shared;
+	}();
+
+	return shared;
+}
+
+const DesktopEntrySearchIndex& currentIndex() {
+	auto* shared = sharedIndex();
+
+	if (shared->dirty) {
+		shared->index.rebuild(DesktopEntryManager::instance()->applications()->valueList());
+		shared->dirty = false;
+	}
+
+	return shared->index;
+}
+
+} // namespace
+
+QString DesktopEntrySearchIndex::normalize(const QString& text) {
+	auto decomposed = text.normalized(QString::NormalizationForm_KD);
+	auto normalized = QString();
+	normalized.reserve(decomposed.length());
+
+	for (auto c: decomposed) {
+		if (c.isMark()) continue;
+		normalized.append(c.toCaseFolded());
+	}
+
+	return normalized;
+}
+
+void DesktopEntrySearchIndex::rebuild(const QList<DesktopEntry*>& entries) {
+	this->items.clear();
+	this->trigrams.clear();
+	this->words.clear();
+	this->mGeneration++;
+
+	this->items.reserve(entries.length());
+
+	for (auto* entry: entries) {
+		auto secondary = QStringList();
+		secondary.append(entry->bGenericName.value());
+		secondary.append(entry->bKeywords.value());
+		secondary.append(entry->bCategories.value());
+
+		this->items.append({
+		    .entry = entry,
+		    .id = entry->mId,
+		    .name = DesktopEntrySearchIndex::normalize(entry->bName.value()),
+		    .secondary = DesktopEntrySearchIndex::normalize(secondary.join(u'\n')),
+		});
+	}
+
+	std::ranges::sort(this->items, [](const Item& a, const Item& b) {
+		if (a.name != b.name) return a.name < b.name;
+		return a.id < b.id;
+	});
+
+	for (qint32 i = 0; i < this->items.length(); i++) {
+		const auto& item = this->items.at(i);
+
+		for (const auto* text: {&item.name, &item.secondary}) {
+			for (qsizetype j = 0; j + 3 <= text->length(); j++) {
+				auto& list = this->trigrams[trigramKey(text->constData() + j)]; // NOLINT
+				if (list.isEmpty() || list.last() != i) list.append(i);
+			}
+
+			appendWords(*text, i, this->words);
+		}
+	}
+
+	std::ranges::sort(this->words);
+}
+
+void DesktopEntrySearchIndex::markSubstringCandidates(const QString& query, QList<bool>& marks)
+    const {
+	marks.fill(false, this->items.length());
+
+	if (query.length() < 3) {
+		// Too short for trigrams, only words starting with the query are found here.
+		// Other occurrences are still found by fuzzy matching of the name.
+		auto iter = std::ranges::lower_bound(this->words, qMakePair(query, -1));
+
+		for (; iter != this->words.end() && iter->first.startsWith(query); ++iter) {
+			marks[iter->second] = true;
+		}
+
+		return;
+	}
+
+	// Items containing every trigram of the query may contain the query.
+	auto keys = QList<quint64>();
+	for (qsizetype i = 0; i + 3 <= query.length(); i++) {
+		auto key = trigramKey(query.constData() + i); // NOLINT
+		if (!keys.contains(key)) keys.append(key);
+	}
+
+	const QList<qint32>* smallest = nullptr;
+	auto lists = QList<const QList<qint32>*>();
+
+	for (auto key: keys) {
+		auto iter = this->trigrams.constFind(key);
+		if (iter == this->trigrams.constEnd()) return;
+
+		lists.append(&iter.value());
+		if (!smallest || iter->length() < smallest->length()) smallest = &iter.value();
+	}
+
+	for (auto item: *smallest) {
+		auto found = std::ranges::all_of(lists, [item](const QList<qint32>* list) {
+			return std::ranges::binary_search(*list, item);
+		});
+
+		if (found) marks[item] = true;
+	}
+}
+
+void DesktopEntrySearchIndex::search(
+    const QString& query,
+    const QList<qint32>* candidates,
+    QList<Match>& matches
+) const {
+	auto matchItem = [&](qint32 item, const QList<bool>& marks) {
+		if (query.isEmpty()) {
+			matches.append({.item = item, .score = 0});
+			return;
+		}
+
+		const auto& data = this->items.at(item);
+		qint32 score = 0;
+
+		if (marks.at(item)) {
+			if (data.name.startsWith(query)) {
+				score = data.name.length() == query.length() ? SCORE_EXACT : SCORE_PREFIX;
+			} else {
+				score = substringScore(data.name, query, SCORE_NAME_WORD, SCORE_NAME_SUBSTRING);
+			}
+
+			if (score == 0) {
+				score = substringScore(
+				    data.secondary,
+				    query,
+				    SCORE_SECONDARY_WORD,
+				    SCORE_SECONDARY_SUBSTRING
+				);
+			}
+		}
+
+		if (score == 0) score = fuzzyScore(data.name, query);
+		if (score != 0) matches.append({.item = item, .score = score});
+	};
+
+	auto marks = QList<bool>();
+	if (!query.isEmpty()) this->markSubstringCandidates(query, marks);
+
+	if (candidates) {
+		for (auto item: *candidates) matchItem(item, marks);
+	} else {
+		for (qint32 item = 0; item < this->items.length(); item++) matchItem(item, marks);
+	}
+}
+
+void DesktopEntrySearchIndex::rank(QList<Match>& matches, qsizetype limit) {
+	auto compare = [](const Match& a, const Match& b) {
+		if (a.score != b.score) return a.score > b.score;
+		return a.item < b.item;
+	};
+
+	if (limit != -1 && limit < matches.length()) {
+		std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), compare);
+		matches.resize(limit);
+	} else {
+		std::ranges::sort(matches, compare);
+	}
+}
+
+DesktopEntrySearch::DesktopEntrySearch(QObject* parent): QObject(parent) {
+	// Created first so the index is marked dirty before onApplicationsChanged runs.
+	sharedIndex();
+
+	QObject::connect(
+	    DesktopEntryManager::instance(),
+	    &DesktopEntryManager::applicationsChanged,
+	    this,
+	    &DesktopEntrySearch::onApplicationsChanged
+	);
+
+	this->update();
+}
+
+void DesktopEntrySearch::setQuery(const QString& query) {
+	if (query == this->mQuery) return;
+	this->mQuery = query;
+	emit this->queryChanged();
+	this->update();
+}
+
+void DesktopEntrySearch::setFrequencies(const QVariantMap& frequencies) {
+	this->mFrequencies = frequencies;
+	this->bonusesValid = false;
+	emit this->frequenciesChanged();
+	this->update();
+}
+
+void DesktopEntrySearch::setLimit(qint32 limit) {
+	if (limit < -1) limit = -1;
+	if (limit == this->mLimit) return;
+	this->mLimit = limit;
+	emit this->limitChanged();
+	this->update();
+}
+
+void DesktopEntrySearch::onApplicationsChanged() { this->update(); }
+
+void DesktopEntrySearch::updateBonuses(const DesktopEntrySearchIndex& index) {
+	this->bonuses.fill(0, index.size());
+	if (this->mFrequencies.isEmpty()) return;
+
+	for (qint32 i = 0; i < index.size(); i++) {
+		auto frequency = this->mFrequencies.value(index.id(i)).toDouble();
+		if (frequency > 0) this->bonuses[i] = qRound(FREQUENCY_WEIGHT * std::log2(1.0 + frequency));
+	}
+}
+
+void DesktopEntrySearch::update() {
+	const auto& index = currentIndex();
+
+	if (index.generation() != this->indexGeneration) {
+		this->indexGeneration = index.generation();
+		this->bonusesValid = false;
+		this->lastMatchesValid = false;
+	}
+
+	if (!this->bonusesValid) {
+		this->updateBonuses(index);
+		this->bonusesValid = true;
+	}
+
+	auto query = DesktopEntrySearchIndex::normalize(this->mQuery.simplified());
+
+	// A query extending the previous one only has to check the previous matches.
+	const QList<qint32>* candidates = nullptr;
+	auto extendsLast = this->lastQuery.length() >= 3 && query.startsWith(this->lastQuery);
+	if (this->lastMatchesValid && extendsLast) candidates = &this->lastMatches;
+
+	auto matches = QList<DesktopEntrySearchIndex::Match>();
+	index.search(query, candidates, matches);
+
+	auto matchedItems = QList<qint32>();
+	matchedItems.reserve(matches.length());
+
+	for (auto& match: matches) {
+		matchedItems.append(match.item);
+		match.score += this->bonuses.at(match.item);
+	}
+
+	this->lastQuery = query;
+	this->lastMatches = std::move(matchedItems);
+	this->lastMatchesValid = true;
+
+	DesktopEntrySearchIndex::rank(matches, this->mLimit);
+
+	auto results = QList<DesktopEntry*>();
+	results.reserve(matches.length());
+	for (const auto& match: matches) results.append(index.entry(match.item));
+
+	this->mResults.diffUpdate(results);
+}
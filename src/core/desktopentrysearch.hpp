@@ -0,0 +1,149 @@
+#pragma once
+
+#include <qcontainerfwd.h>
+#include <qhash.h>
+#include <qlist.h>
+#include <qobject.h>
+#include <qpair.h>
+#include <qqmlintegration.h>
+#include <qstring.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "desktopentry.hpp"
+#include "doc.hpp"
+#include "model.hpp"
+
+// Normalized search text of a list of desktop entries, with trigram and word prefix indexes.
+// Rebuilt once per desktop entry scan so searches never read DesktopEntry properties.
+class DesktopEntrySearchIndex {
+public:
+	struct Match {
+		qint32 item = 0;
+		qint32 score = 0;
+	};
+
+	// Items are ordered by name, so item indices can be used as an alphabetical tiebreaker.
+	void rebuild(const QList<DesktopEntry*>& entries);
+
+	[[nodiscard]] qsizetype size() const { return this->items.size(); }
+	[[nodiscard]] DesktopEntry* entry(qint32 item) const { return this->items.at(item).entry; }
+	[[nodiscard]] const QString& id(qint32 item) const { return this->items.at(item).id; }
+	// Incremented on every rebuild.
+	[[nodiscard]] quint32 generation() const { return this->mGeneration; }
+
+	// Appends every item matching query to matches, unordered. The query must be normalized.
+	// If candidates is not null, only the given items are considered.
+	//
+	// Items matching a query are a subset of the items matching any prefix of it that is
+	// at least 3 characters long, so those matches can be passed as candidates.
+	void search(const QString& query, const QList<qint32>* candidates, QList<Match>& matches) const;
+
+	// Sorts matches best first, only sorting the first limit matches if limit is not -1.
+	static void rank(QList<Match>& matches, qsizetype limit = -1);
+
+	// Case folds text and strips diacritics.
+	static QString normalize(const QString& text);
+
+private:
+	struct Item {
+		DesktopEntry* entry = nullptr;
+		QString id;
+		QString name;
+		// generic name, keywords and categories, separated by newlines
+		QString secondary;
+	};
+
+	void markSubstringCandidates(const QString& query, QList<bool>& marks) const;
+
+	QList<Item> items;
+	// ascending item indices of every item containing a trigram
+	QHash<quint64, QList<qint32>> trigrams;
+	// every word of every item, sorted
+	QList<QPair<QString, qint32>> words;
+	quint32 mGeneration = 0;
+};
+
+///! Ranked search over desktop entries.
+/// Filters and ranks @@DesktopEntries.applications by a search string, using an index
+/// built once per desktop entry scan instead of reading every entry from javascript
+/// on each keystroke.
+///
+/// Entries are matched against their name, generic name, keywords and categories,
+/// ignoring case and diacritics. Matches at the start of the name rank highest,
+/// followed by matches at the start of a word, substring matches, and fuzzy matches
+/// of the name.
+///
+/// ```qml
+/// DesktopEntrySearch {
+///   id: search
+///   query: searchField.text
+///   frequencies: launchCounts
+///   limit: 50
+/// }
+///
+/// @@QtQuick.ListView {
+///   model: search.results
+///   delegate: // ...
+/// }
+/// ```
+class DesktopEntrySearch: public QObject {
+	Q_OBJECT;
+	/// The search string. If empty, all applications are returned.
+	Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged);
+	/// Usage hints such as launch counts, keyed by desktop entry id.
+	///
+	/// Entries with higher values are ranked above entries with similar matches.
+	/// The boost grows logarithmically, so frequently used entries can outrank a slightly
+	/// better match of another entry, but not a much better one.
+	// clang-format off
+	Q_PROPERTY(QVariantMap frequencies READ frequencies WRITE setFrequencies NOTIFY frequenciesChanged);
+	// clang-format on
+	/// The maximum number of results, or -1 for no limit. Defaults to -1.
+	Q_PROPERTY(qint32 limit READ limit WRITE setLimit NOTIFY limitChanged);
+	/// Matching entries, best match first. Ties are ordered by name.
+	QSDOC_TYPE_OVERRIDE(ObjectModel<DesktopEntry>*);
+	Q_PROPERTY(UntypedObjectModel* results READ results CONSTANT);
+	QML_ELEMENT;
+
+public:
+	explicit DesktopEntrySearch(QObject* parent = nullptr);
+
+	[[nodiscard]] QString query() const { return this->mQuery; }
+	void setQuery(const QString& query);
+
+	[[nodiscard]] QVariantMap frequencies() const { return this->mFrequencies; }
+	void setFrequencies(const QVariantMap& frequencies);
+
+	[[nodiscard]] qint32 limit() const { return this->mLimit; }
+	void setLimit(qint32 limit);
+
+	[[nodiscard]] ObjectModel<DesktopEntry>* results() { return &this->mResults; }
+
+signals:
+	void queryChanged();
+	void frequenciesChanged();
+	void limitChanged();
+
+private slots:
+	void onApplicationsChanged();
+
+private:
+	void update();
+	void updateBonuses(const DesktopEntrySearchIndex& index);
+
+	QString mQuery;
+	QVariantMap mFrequencies;
+	qint32 mLimit = -1;
+	ObjectModel<DesktopEntry> mResults {this};
+
+	quint32 indexGeneration = 0;
+	bool bonusesValid = false;
+	// frequency boost of each index item
+	QList<qint32> bonuses;
+	// normalized query of the last update, and every item it matched
+	QString lastQuery;
+	QList<qint32> lastMatches;
+	bool lastMatchesValid = false;
+};
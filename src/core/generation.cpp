@@ -1,10 +1,13 @@
 #include "generation.hpp"
 #include <utility>
 
+#include <qbytearray.h>
 #include <qcontainerfwd.h>
 #include <qcoreapplication.h>
 #include <qdebug.h>
 #include <qdir.h>
+#include <qelapsedtimer.h>
+#include <qfile.h>
 #include <qfileinfo.h>
 #include <qfilesystemwatcher.h>
 #include <qhash.h>
@@ -12,24 +15,31 @@
 #include <qlogging.h>
 #include <qloggingcategory.h>
 #include <qobject.h>
+#include <qqmlcomponent.h>
 #include <qqmlcontext.h>
 #include <qqmlengine.h>
 #include <qqmlerror.h>
 #include <qqmlincubator.h>
 #include <qquickwindow.h>
+#include <qset.h>
 #include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qurl.h>
 
 #include "iconimageprovider.hpp"
 #include "imageprovider.hpp"
 #include "incubator.hpp"
+#include "lazyloader.hpp"
 #include "logcat.hpp"
 #include "plugin.hpp"
 #include "qsintercept.hpp"
 #include "reload.hpp"
+#include "reloadstats.hpp"
 #include "scan.hpp"
 
 namespace {
 QS_LOGGING_CATEGORY(logScene, "scene");
+QS_LOGGING_CATEGORY(logReload, "quickshell.reload", QtInfoMsg);
 }
 
 static QHash<const QQmlEngine*, EngineGeneration*> g_generations; // NOLINT
@@ -89,8 +99,14 @@ void EngineGeneration::destroy() {
 			g_generations.remove(this->engine);
 
 			// Garbage is not collected during engine destruction.
+			QElapsedTimer gcTimer;
+			gcTimer.start();
 			this->engine->collectGarbage();
 
+			if (auto* stats = ReloadStatsLog::instance()->active()) {
+				stats->gc = gcTimer.nsecsElapsed();
+			}
+
 			delete this->engine;
 			this->engine = nullptr;
 
@@ -140,6 +156,10 @@ void EngineGeneration::onReload(EngineGeneration* old) {
 	QObject::connect(this->engine, &QQmlEngine::quit, this, &EngineGeneration::quit);
 	QObject::connect(this->engine, &QQmlEngine::exit, this, &EngineGeneration::exit);
 
+	auto* stats = ReloadStatsLog::instance()->active();
+	QElapsedTimer timer;
+	timer.start();
+
 	if (auto* reloadable = qobject_cast<Reloadable*>(this->root)) {
 		reloadable->reload(old ? old->root : nullptr);
 	}
@@ -148,8 +168,19 @@ void EngineGeneration::onReload(EngineGeneration* old) {
 	this->reloadComplete = true;
 	emit this->reloadFinished();
 
+	if (stats != nullptr) stats->reload = timer.nsecsElapsed();
+
 	if (old != nullptr) {
-		QObject::connect(old, &QObject::destroyed, this, [this]() { this->postReload(); });
+		timer.restart();
+
+		QObject::connect(old, &QObject::destroyed, this, [this, timer]() {
+			if (auto* stats = ReloadStatsLog::instance()->active()) {
+				stats->destroy = timer.nsecsElapsed();
+			}
+
+			this->postReload();
+		});
+
 		old->destroy();
 	} else {
 		this->postReload();
@@ -160,10 +191,18 @@ void EngineGeneration::postReload() {
 	// This can be called on a generation during its destruction.
 	if (this->engine == nullptr || this->root == nullptr) return;
 
+	QElapsedTimer timer;
+	timer.start();
+
 	QsEnginePlugin::runOnReload();
 
 	emit this->firePostReload();
 	QObject::disconnect(this, &EngineGeneration::firePostReload, nullptr, nullptr);
+
+	if (auto* stats = ReloadStatsLog::instance()->active()) {
+		stats->postReload = timer.nsecsElapsed();
+		ReloadStatsLog::instance()->finish(this->root, this->engine);
+	}
 }
 
 void EngineGeneration::setWatchingFiles(bool watching) {
@@ -228,6 +267,7 @@ void EngineGeneration::onFileChanged(const QString& name) {
 		auto fileInfo = QFileInfo(name);
 		if (fileInfo.isFile() && fileInfo.size() == 0) return;
 
+		this->changedFiles.insert(name);
 		emit this->filesChanged();
 	}
 }
@@ -236,12 +276,168 @@ void EngineGeneration::onDirectoryChanged() {
 	// try to find any files that were just deleted from a replace operation
 	for (auto& file: this->deletedWatchedFiles) {
 		if (QFileInfo(file).exists()) {
+			this->changedFiles.insert(file);
 			emit this->filesChanged();
 			break;
 		}
 	}
 }
 
+bool EngineGeneration::reloadIncremental() {
+	if (this->root == nullptr || this->destroying) return false;
+
+	// Multiple change signals can be sent for a single save.
+	auto changed = std::exchange(this->changedFiles, QSet<QString>());
+	if (changed.isEmpty()) return true;
+
+	auto& stats = ReloadStatsLog::instance()->begin(ReloadStats::Incremental);
+	auto fullReload = [&stats]() {
+		stats.success = false;
+		ReloadStatsLog::instance()->finish(nullptr, nullptr);
+		return false;
+	};
+
+	QElapsedTimer timer;
+	timer.start();
+
+	auto scanner = QmlScanner(this->rootPath);
+	scanner.scanQmlRoot(this->scanner.root());
+	stats.scan = timer.nsecsElapsed();
+	stats.scannedFiles = scanner.scannedFiles.length();
+
+	const auto& oldList = this->scanner.scannedFiles;
+	auto oldFiles = QSet<QString>(oldList.begin(), oldList.end());
+	auto newFiles = QSet<QString>(scanner.scannedFiles.begin(), scanner.scannedFiles.end());
+
+	// Added or removed files and changed pragmas alter import resolution and qmldirs.
+	if (newFiles != oldFiles || scanner.fileIntercepts != this->scanner.fileIntercepts) {
+		qCInfo(logReload) << "Set of scanned files changed, performing a full reload.";
+		return fullReload();
+	}
+
+	for (const auto& file: changed) {
+		if (!file.endsWith(".qml") || !newFiles.contains(file)) {
+			qCInfo(logReload) << "Changed file" << file << "is not a qml type, performing a full reload.";
+			return fullReload();
+		}
+	}
+
+	for (const auto& file: changed) {
+		if (file == scanner.root() || scanner.isSingleton(file)) {
+			qCInfo(logReload) << "Changed file" << file << "cannot be reloaded in place,"
+			                  << "performing a full reload.";
+			return fullReload();
+		}
+
+		// Replacements are compiled while the live items still hold the old definitions, which
+		// the engine keeps cached by url. Types referenced by other files would resolve to those.
+		if (scanner.dependentFiles({file}).size() != 1) {
+			qCInfo(logReload) << "Changed file" << file << "is used by other types,"
+			                  << "performing a full reload.";
+			return fullReload();
+		}
+	}
+
+	QVector<LazyLoader*> loaders;
+	this->findSourceLoaders(this->root, changed, &loaders);
+
+	// Changed files instantiated outside of a LazyLoader source, such as through Loader.source
+	// or Qt.createComponent, would keep their old definition.
+	auto loaderSources = QSet<QString>();
+	for (auto* loader: loaders) loaderSources.insert(this->localPath(loader->sourceUrl()));
+
+	for (const auto& file: changed) {
+		if (!loaderSources.contains(file)) {
+			qCInfo(logReload) << "Changed file" << file << "is not the source of a LazyLoader,"
+			                  << "performing a full reload.";
+			return fullReload();
+		}
+	}
+
+	qCInfo(logReload) << "Reloading" << loaders.length() << "loaders in place for changes to"
+	                  << changed;
+
+	// Nothing is touched until every replacement compiles, so errors leave the live config
+	// intact. They are reported by the full reload, which fails the same way.
+	timer.restart();
+	QVector<QQmlComponent*> components;
+	for (auto* loader: loaders) {
+		auto path = this->localPath(loader->sourceUrl());
+		auto source = scanner.fileIntercepts.value(path).toUtf8();
+
+		if (source.isEmpty()) {
+			auto file = QFile(path);
+			if (file.open(QFile::ReadOnly)) source = file.readAll();
+		}
+
+		// Loading the url would return the definition cached for the live item.
+		auto* component = new QQmlComponent(this->engine);
+		component->setData(source, loader->sourceUrl());
+		components.push_back(component);
+
+		if (!component->isReady()) {
+			qCInfo(logReload) << "Failed to compile" << path << "performing a full reload.";
+			for (auto* c: components) delete c;
+			return fullReload();
+		}
+	}
+
+	stats.compile = timer.nsecsElapsed();
+
+	this->scanner = std::move(scanner);
+
+	timer.restart();
+	for (qsizetype i = 0; i < loaders.length(); i++) {
+		loaders.at(i)->replaceSource(components.at(i));
+	}
+
+	stats.create = timer.nsecsElapsed();
+
+	// Drop the old definitions now that nothing references them.
+	timer.restart();
+	this->engine->collectGarbage();
+	this->engine->trimComponentCache();
+	stats.gc = timer.nsecsElapsed();
+
+	// Editors which save by replacing files remove them from the watcher.
+	if (this->watcher != nullptr) {
+		this->deletedWatchedFiles.clear();
+		this->setWatchingFiles(false);
+		this->setWatchingFiles(true);
+	}
+
+	ReloadStatsLog::instance()->finish(this->root, this->engine);
+	return true;
+}
+
+QString EngineGeneration::localPath(const QUrl& url) const {
+	if (url.scheme() == "qs") {
+		auto path = url.path();
+		if (path.startsWith("@/qs/")) return this->rootPath.filePath(path.sliced(5));
+		return path;
+	}
+
+	return url.toLocalFile();
+}
+
+void EngineGeneration::findSourceLoaders(
+    QObject* object,
+    const QSet<QString>& files,
+    QVector<LazyLoader*>* loaders
+) const {
+	for (auto* child: object->children()) {
+		if (auto* loader = qobject_cast<LazyLoader*>(child)) {
+			if (files.contains(this->localPath(loader->sourceUrl()))) {
+				// the loader's whole subtree is recreated
+				loaders->push_back(loader);
+				continue;
+			}
+		}
+
+		this->findSourceLoaders(child, files, loaders);
+	}
+}
+
 void EngineGeneration::onEngineWarnings(const QList<QQmlError>& warnings) {
 	for (const auto& error: warnings) {
 		const auto& url = error.url();
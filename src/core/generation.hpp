@@ -10,7 +10,9 @@
 #include <qqmlerror.h>
 #include <qqmlincubator.h>
 #include <qquickwindow.h>
+#include <qset.h>
 #include <qtclasshelpermacros.h>
+#include <qurl.h>
 
 #include "incubator.hpp"
 #include "qsintercept.hpp"
@@ -18,6 +20,7 @@
 #include "singleton.hpp"
 
 class RootWrapper;
+class LazyLoader;
 class QuickshellGlobal;
 
 class EngineGenerationExt {
@@ -41,6 +44,13 @@ public:
 	void setWatchingFiles(bool watching);
 	bool setExtraWatchedFiles(const QVector<QString>& files);
 
+	// Applies changes to watched files by recreating the LazyLoader items that instantiate
+	// them, without replacing the engine. Returns false if a full reload is required, which
+	// is the case when the root file, a singleton or the set of scanned files changed, a
+	// changed file is used by another type or instantiated outside of a LazyLoader source,
+	// or a changed file fails to compile. Nothing is modified in that case.
+	bool reloadIncremental();
+
 	void trackWindowIncubationController(QQuickWindow* window);
 
 	// takes ownership
@@ -90,6 +100,14 @@ private slots:
 private:
 	void postReload();
 	void assignIncubationController();
+	[[nodiscard]] QString localPath(const QUrl& url) const;
+	void findSourceLoaders(
+	    QObject* object,
+	    const QSet<QString>& files,
+	    QVector<LazyLoader*>* loaders
+	) const;
+
+	QSet<QString> changedFiles;
 	QVector<QQuickWindow*> trackedWindows;
 	bool incubationControllersLocked = false;
 	QHash<const void*, EngineGenerationExt*> extensions;
@@ -97,4 +115,6 @@ private:
 	bool destroying = false;
 	bool shouldTerminate = false;
 	int exitCode = 0;
+
+	friend class TestIncrementalReload;
 };
@@ -8,6 +8,7 @@
 #include <qqmlengine.h>
 #include <qqmlincubator.h>
 #include <qtmetamacros.h>
+#include <qurl.h>
 
 #include "incubator.hpp"
 #include "reload.hpp"
@@ -155,6 +156,47 @@ void LazyLoader::setSource(QString source) {
 	emit this->sourceChanged();
 }
 
+QUrl LazyLoader::sourceUrl() const {
+	if (!this->cleanupComponent || this->mComponent == nullptr) return QUrl();
+	return this->mComponent->url();
+}
+
+void LazyLoader::replaceSource(QQmlComponent* component) {
+	if (this->incubator != nullptr) {
+		delete this->incubator;
+		this->incubator = nullptr;
+		emit this->loadingChanged();
+	}
+
+	// Kept alive until the new item has taken its state.
+	auto* oldItem = std::exchange(this->mItem, nullptr);
+
+	delete this->mComponent;
+	this->mComponent = component;
+
+	this->incubateIfReady();
+
+	if (oldItem == nullptr) return;
+
+	if (this->incubator != nullptr) {
+		this->incubator->forceCompletion();
+	}
+
+	if (this->mItem != nullptr) {
+		if (auto* reloadable = qobject_cast<Reloadable*>(this->mItem)) {
+			reloadable->reload(oldItem);
+		} else {
+			Reloadable::reloadRecursive(this->mItem, oldItem);
+		}
+	} else {
+		emit this->itemChanged();
+		emit this->activeChanged();
+	}
+
+	// Deleted immediately so the old definition can be dropped from the component cache.
+	delete oldItem;
+}
+
 void LazyLoader::incubateIfReady(bool overrideReloadCheck) {
 	if (!(this->reloadComplete || overrideReloadCheck) || !(this->targetLoading || this->targetActive)
 	    || this->mComponent == nullptr || this->incubator != nullptr)
@@ -5,6 +5,7 @@
 #include <qqmlincubator.h>
 #include <qqmlintegration.h>
 #include <qtmetamacros.h>
+#include <qurl.h>
 
 #include "incubator.hpp"
 #include "reload.hpp"
@@ -147,6 +148,13 @@ public:
 	[[nodiscard]] QString source() const;
 	void setSource(QString source);
 
+	// Incremental reload support. Only loaders using source own a component
+	// that can be recompiled from its file.
+	[[nodiscard]] QUrl sourceUrl() const;
+	// Swaps in a recompiled source component, taking ownership of it. If an item was loaded it
+	// is recreated and reloaded from the old item, which is then destroyed.
+	void replaceSource(QQmlComponent* component);
+
 signals:
 	void activeChanged();
 	void loadingChanged();
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+
+#include <qcontainerfwd.h>
+#include <qhash.h>
+#include <qlist.h>
+#include <qtypes.h>
+
+namespace listdiff {
+
+// Tracks which values of the old list have been placed or removed, and finds the
+// next value still in its original position.
+class OldValueTracker {
+public:
+	explicit OldValueTracker(qsizetype size): next(size + 1), counts(size + 1, 0) {
+		for (qsizetype i = 0; i <= size; i++) this->next[i] = i;
+	}
+
+	void markGone(qsizetype index) {
+		this->next[index] = index + 1;
+
+		for (auto i = index + 1; i < this->counts.size(); i += i & -i) {
+			this->counts[i]++;
+		}
+	}
+
+	// Returns the first index at or after index that is not gone.
+	qsizetype nextRemaining(qsizetype index) {
+		auto root = index;
+		while (this->next[root] != root) root = this->next[root];
+
+		while (this->next[index] != root) {
+			auto next = this->next[index];
+			this->next[index] = root;
+			index = next;
+		}
+
+		return root;
+	}
+
+	// Returns the number of gone values before index.
+	[[nodiscard]] qsizetype goneBefore(qsizetype index) const {
+		qsizetype count = 0;
+		for (auto i = index; i > 0; i -= i & -i) count += this->counts[i];
+		return count;
+	}
+
+private:
+	// union-find of the next remaining index
+	QList<qsizetype> next;
+	// fenwick tree of gone indices
+	QList<qsizetype> counts;
+};
+
+// Same operations as diffKeys, found by scanning the remaining values of both lists.
+// O(n^2), but correct when keys are not unique.
+template <typename Key, typename Handler>
+void diffKeysLinear(const QList<Key>& oldKeys, const QList<Key>& newKeys, Handler& handler) {
+	// the handler's list, as operations are applied to it
+	auto keys = oldKeys;
+
+	auto newContains = [&](qsizetype from, const Key& key) {
+		return std::find(newKeys.begin() + from, newKeys.end(), key) != newKeys.end();
+	};
+
+	qsizetype index = 0;
+	qsizetype newIndex = 0;
+
+	while (true) {
+		if (newIndex == newKeys.size()) {
+			if (index != keys.size()) handler.remove(index, keys.size() - index);
+			break;
+		} else if (index == keys.size()) {
+			handler.insert(index, newIndex, newKeys.size() - newIndex);
+			break;
+		}
+
+		const auto& newKey = newKeys.at(newIndex);
+
+		if (keys.at(index) == newKey) {
+			handler.keep(index, newIndex);
+			index++;
+			newIndex++;
+			continue;
+		}
+
+		auto oldIndex = keys.indexOf(newKey, index);
+
+		if (oldIndex == -1) {
+			auto start = newIndex;
+
+			do {
+				newIndex++;
+			} while (newIndex != newKeys.size() && keys.indexOf(newKeys.at(newIndex), index) == -1);
+
+			auto count = newIndex - start;
+			handler.insert(index, start, count);
+			for (qsizetype k = 0; k != count; k++) keys.insert(index + k, newKeys.at(start + k));
+			index += count;
+		} else if (!newContains(newIndex, keys.at(index))) {
+			auto end = index;
+
+			do {
+				end++;
+			} while (end != keys.size() && !newContains(newIndex, keys.at(end)));
+
+			handler.remove(index, end - index);
+			keys.remove(index, end - index);
+		} else {
+			auto start = oldIndex;
+			auto newStart = newIndex;
+
+			do {
+				oldIndex++;
+				newIndex++;
+			} while (oldIndex != keys.size() && newIndex != newKeys.size()
+			         && keys.at(oldIndex) == newKeys.at(newIndex));
+
+			auto count = oldIndex - start;
+			handler.move(start, count, index);
+			std::rotate(keys.begin() + index, keys.begin() + start, keys.begin() + oldIndex);
+
+			for (qsizetype k = 0; k != count; k++) {
+				handler.keep(index + k, newStart + k);
+			}
+
+			index += count;
+		}
+	}
+}
+
+} // namespace listdiff
+
+// Transforms a list of keys into another list of keys using batched operations,
+// in O(n log n) time plus the cost of applying the operations. If either list contains
+// duplicate keys, listdiff::diffKeysLinear is used instead.
+//
+// Operations are passed to the handler in order, and must be applied to its own list
+// before returning. Indices are indices in the handler's list at the time of the operation.
+// - `remove(index, count)`
+// - `insert(index, newIndex, count)`: inserts count values starting at newIndex of the new list.
+// - `move(from, count, to)`: moves count values starting at from to index to, where to < from.
+// - `keep(index, newIndex)`: the value at index has the same key as the new value at newIndex.
+//
+// The list is processed front to back. When the next value of the list and the next
+// new value differ, either the old values not present in the new list are removed,
+// the new values not present in the old list are inserted, or the run of old values
+// matching the next new values is moved into place.
+template <typename Key, typename Handler>
+void diffKeys(const QList<Key>& oldKeys, const QList<Key>& newKeys, Handler& handler) {
+	auto oldIndices = QHash<Key, qsizetype>();
+	oldIndices.reserve(oldKeys.size());
+	for (qsizetype i = 0; i < oldKeys.size(); i++) oldIndices.insert(oldKeys.at(i), i);
+
+	auto newIndices = QHash<Key, qsizetype>();
+	newIndices.reserve(newKeys.size());
+	for (qsizetype i = 0; i < newKeys.size(); i++) newIndices.insert(newKeys.at(i), i);
+
+	// Duplicates collapse into a single hash entry, and their indices cannot be tracked.
+	if (oldIndices.size() != oldKeys.size() || newIndices.size() != newKeys.size()) {
+		listdiff::diffKeysLinear(oldKeys, newKeys, handler);
+		return;
+	}
+
+	// Values that have not been placed or removed keep their original relative order,
+	// so their current index is derived from the number of gone values before them.
+	auto tracker = listdiff::OldValueTracker(oldKeys.size());
+	auto remaining = oldKeys.size();
+
+	qsizetype index = 0;
+	qsizetype newIndex = 0;
+	qsizetype oldIndex = 0;
+
+	while (true) {
+		oldIndex = tracker.nextRemaining(oldIndex);
+
+		if (newIndex == newKeys.size()) {
+			if (remaining != 0) handler.remove(index, remaining);
+			break;
+		} else if (remaining == 0) {
+			handler.insert(index, newIndex, newKeys.size() - newIndex);
+			break;
+		}
+
+		const auto& newKey = newKeys.at(newIndex);
+		const auto& oldKey = oldKeys.at(oldIndex);
+
+		if (newKey == oldKey) {
+			handler.keep(index, newIndex);
+			tracker.markGone(oldIndex);
+			remaining--;
+			index++;
+			newIndex++;
+			continue;
+		}
+
+		auto found = oldIndices.constFind(newKey);
+
+		if (found == oldIndices.constEnd()) {
+			auto start = newIndex;
+
+			do {
+				newIndex++;
+			} while (newIndex != newKeys.size() && !oldIndices.contains(newKeys.at(newIndex)));
+
+			handler.insert(index, start, newIndex - start);
+			index += newIndex - start;
+		} else if (!newIndices.contains(oldKey)) {
+			qsizetype count = 0;
+			auto i = oldIndex;
+
+			do {
+				tracker.markGone(i);
+				count++;
+				i = tracker.nextRemaining(i + 1);
+			} while (i != oldKeys.size() && !newIndices.contains(oldKeys.at(i)));
+
+			handler.remove(index, count);
+			remaining -= count;
+		} else {
+			auto i = found.value();
+			auto from = index + i - tracker.goneBefore(i);
+			auto start = newIndex;
+
+			do {
+				tracker.markGone(i);
+				i = tracker.nextRemaining(i + 1);
+				newIndex++;
+			} while (i != oldKeys.size() && newIndex != newKeys.size()
+			         && oldKeys.at(i) == newKeys.at(newIndex));
+
+			auto count = newIndex - start;
+			handler.move(from, count, index);
+
+			for (qsizetype k = 0; k != count; k++) {
+				handler.keep(index + k, start + k);
+			}
+
+			index += count;
+			remaining -= count;
+		}
+	}
+}
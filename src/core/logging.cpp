@@ -1,7 +1,10 @@
 #include "logging.hpp"
+#include <algorithm>
 #include <array>
 #include <cerrno>
 #include <cstdio>
+#include <cstring>
+#include <utility>
 
 #include <fcntl.h>
 #include <qbytearrayview.h>
@@ -9,8 +12,11 @@
 #include <qdatetime.h>
 #include <qendian.h>
 #include <qfilesystemwatcher.h>
+#include <qelapsedtimer.h>
 #include <qhash.h>
 #include <qhashfunctions.h>
+#include <qjsondocument.h>
+#include <qjsonobject.h>
 #include <qlist.h>
 #include <qlogging.h>
 #include <qloggingcategory.h>
@@ -18,7 +24,10 @@
 #include <qobject.h>
 #include <qobjectdefs.h>
 #include <qpair.h>
+#include <qregularexpression.h>
 #include <qstring.h>
+#include <qstringbuilder.h>
+#include <qstringencoder.h>
 #include <qstringview.h>
 #include <qsysinfo.h>
 #include <qtenvironmentvariables.h>
@@ -28,6 +37,11 @@
 #include <qtypes.h>
 #include <sys/mman.h>
 #include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifdef QS_LOG_ZSTD
+#include <zstd.h>
+#endif
 
 #include "instanceinfo.hpp"
 #include "logcat.hpp"
@@ -150,8 +164,6 @@ void LogManager::messageHandler(
     const QMessageLogContext& context,
     const QString& msg
 ) {
-	auto message = LogMessage(type, QLatin1StringView(context.category), msg.toUtf8());
-
 	auto* self = LogManager::instance();
 
 	auto display = true;
@@ -162,6 +174,28 @@ void LogManager::messageHandler(
 		display = self->sparseFilters.value(key).shouldDisplay(type);
 	}
 
+	if (auto* queue = self->asyncQueue.loadAcquire()) {
+		if (type != QtFatalMsg) {
+			if (queue->push(type, QLatin1StringView(context.category), msg, display)
+			    && queue->claimWakeup())
+			{
+				QMetaObject::invokeMethod(
+				    queue->consumer,
+				    &ThreadLogging::drainQueue,
+				    Qt::QueuedConnection
+				);
+			}
+
+			return;
+		}
+
+		// Fatal messages are written synchronously as the process is about to abort.
+		// Give the logging thread a chance to write anything queued before them first.
+		if (QThread::currentThread() != queue->consumer->thread()) queue->waitForDrain(100);
+	}
+
+	auto message = LogMessage(type, QLatin1StringView(context.category), msg.toUtf8());
+
 	if (display) {
 		LogMessage::formatMessage(
 		    self->stdoutStream,
@@ -289,6 +323,11 @@ CategoryFilter LogManager::getFilter(QLatin1StringView category) {
 	return this->allFilters.value(category);
 }
 
+quint64 LogManager::droppedMessages() const {
+	auto* queue = this->asyncQueue.loadAcquire();
+	return queue ? queue->dropped() : 0;
+}
+
 void LoggingThreadProxy::initInThread() {
 	this->logging = new ThreadLogging(this);
 	this->logging->init();
@@ -323,6 +362,7 @@ void ThreadLogging::init() {
 
 	if (dlogMfd != -1) {
 		crash::CrashInfo::INSTANCE.logFd = dlogMfd;
+		this->detailedWriter.setCompressed(!qEnvironmentVariableIsSet("QS_UNCOMPRESSED_LOGS"));
 
 		this->detailedFile = new QFile();
 		// buffered by WriteBuffer
@@ -446,6 +486,21 @@ void ThreadLogging::initFs() {
 		delete oldFile;
 	}
 
+	if (this->detailedFile) {
+		auto indexPath = LogIndex::pathFor(detailedPath);
+		auto* indexFile = new QFile(indexPath);
+
+		// buffered by WriteBuffer
+		if (indexFile->open(QFile::WriteOnly | QFile::Truncate | QFile::Unbuffered)) {
+			this->indexFile = indexFile;
+			this->detailedWriter.setIndexDevice(indexFile);
+		} else {
+			qCWarning(logLogging) << "Could not create detailed log index at" << indexPath
+			                      << "- reading logs will be slower.";
+			delete indexFile;
+		}
+	}
+
 	qCDebug(logLogging) << "Switched logging to disk logs.";
 
 	auto* logManager = LogManager::instance();
@@ -460,16 +515,31 @@ void ThreadLogging::initFs() {
 	);
 
 	qCDebug(logLogging) << "Switched threaded logger to queued eventloop connection.";
+
+	if (qEnvironmentVariableIsSet("QS_ASYNC_LOGS")) {
+		this->queue = new LogQueue(this);
+		this->lineBuffers.resize(LogQueue::BATCH_SIZE);
+		logManager->asyncQueue.storeRelease(this->queue);
+
+		qCInfo(logLogging) << "Switched to asynchronous logging.";
+	}
 }
 
 void ThreadLogging::onMessage(const LogMessage& msg, bool showInSparse) {
+	this->writeMessage(msg, showInSparse);
+	this->fileStream.flush();
+}
+
+void ThreadLogging::writeMessage(const LogMessage& msg, bool showInSparse, bool borrowedBody) {
 	if (showInSparse) {
 		if (this->fileStream.device() == nullptr) return;
 		LogMessage::formatMessage(this->fileStream, msg, false, true);
-		this->fileStream << Qt::endl;
+		this->fileStream << '\n';
 	}
 
-	if (!this->detailedWriter.write(msg) || (this->detailedFile && !this->detailedFile->flush())) {
+	if (!this->detailedWriter.write(msg, borrowedBody)
+	    || (this->detailedFile && !this->detailedFile->flush()))
+	{
 		this->detailedWriter.setDevice(nullptr);
 
 		if (this->detailedFile) {
@@ -480,6 +550,182 @@ void ThreadLogging::onMessage(const LogMessage& msg, bool showInSparse) {
 	}
 }
 
+namespace {
+
+// writev which handles partial writes. Modifies the passed iovecs.
+void writeAllV(int fd, iovec* iov, int count) {
+	while (count > 0) {
+		auto written = writev(fd, iov, count);
+
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return;
+		}
+
+		while (count > 0 && static_cast<size_t>(written) >= iov->iov_len) {
+			written -= static_cast<ssize_t>(iov->iov_len);
+			iov++; // NOLINT
+			count--;
+		}
+
+		if (count > 0) {
+			iov->iov_base = static_cast<char*>(iov->iov_base) + written; // NOLINT
+			iov->iov_len -= static_cast<size_t>(written);
+		}
+	}
+}
+
+} // namespace
+
+void ThreadLogging::formatLine(const LogMessage& msg, QByteArray* line) {
+	auto* manager = LogManager::instance();
+
+	// resize keeps the allocation, unlike clear
+	this->lineString.resize(0);
+	this->lineStream.setString(&this->lineString, QIODevice::WriteOnly);
+	LogMessage::formatMessage(
+	    this->lineStream,
+	    msg,
+	    manager->colorLogs,
+	    manager->timestampLogs,
+	    manager->prefix
+	);
+
+	this->lineStream << '\n';
+	this->lineStream.flush();
+
+	auto encoder = QStringEncoder(QStringEncoder::Utf8);
+	line->resize(encoder.requiredSpace(this->lineString.length()));
+	auto* end = encoder.appendToBuffer(line->data(), this->lineString);
+	line->resize(end - line->constData());
+}
+
+void ThreadLogging::drainQueue() {
+	// Cleared before reading so messages pushed during the drain trigger another one.
+	this->queue->clearWakeup();
+
+	std::array<iovec, LogQueue::BATCH_SIZE> iov {};
+
+	while (true) {
+		qsizetype count = 0;
+		auto lines = 0;
+
+		for (; count != LogQueue::BATCH_SIZE; count++) {
+			auto* slot = this->queue->front();
+			if (!slot) break;
+
+			// The body references the slot's buffer, so the slot is only released once the
+			// message has been formatted and written.
+			auto message = LogMessage(
+			    slot->type,
+			    slot->category,
+			    QByteArray::fromRawData(slot->body.constData(), slot->body.length()),
+			    QDateTime::fromMSecsSinceEpoch(slot->time)
+			);
+
+			if (slot->display) {
+				auto& line = this->lineBuffers[lines];
+				this->formatLine(message, &line);
+				iov[lines] = iovec {.iov_base = line.data(), .iov_len = static_cast<size_t>(line.length())};
+				lines++;
+			}
+
+			this->writeMessage(message, slot->display, true);
+			this->queue->pop();
+		}
+
+		if (count == 0) break;
+		writeAllV(STDOUT_FILENO, iov.data(), lines);
+	}
+
+	auto dropped = this->queue->dropped();
+	if (dropped != this->reportedDropped) {
+		QByteArray body = QByteArray::number(dropped - this->reportedDropped)
+		                % " log messages were dropped as the log queue was full.";
+
+		auto message = LogMessage(QtWarningMsg, QLatin1StringView("quickshell.logging"), body);
+		this->reportedDropped = dropped;
+
+		auto& line = this->lineBuffers[0];
+		this->formatLine(message, &line);
+		iov[0] = iovec {.iov_base = line.data(), .iov_len = static_cast<size_t>(line.length())};
+		writeAllV(STDOUT_FILENO, iov.data(), 1);
+
+		this->writeMessage(message, true);
+	}
+
+	this->fileStream.flush();
+}
+
+LogQueue::LogQueue(ThreadLogging* consumer)
+    : consumer(consumer)
+    , slots(new Slot[CAPACITY]) {
+	for (quint64 i = 0; i != CAPACITY; i++) {
+		this->slots[i].sequence.storeRelaxed(i);
+		this->slots[i].body.reserve(SLOT_RESERVE);
+	}
+}
+
+bool LogQueue::push(QtMsgType type, QLatin1StringView category, QStringView body, bool display) {
+	auto pos = this->enqueuePos.loadRelaxed();
+	Slot* slot = nullptr;
+
+	// Slots are claimed by advancing enqueuePos. A slot is free for writing when its
+	// sequence equals the position being claimed, and readable once it is pos + 1.
+	while (true) {
+		slot = &this->slots[pos & (CAPACITY - 1)];
+		auto diff = static_cast<qint64>(slot->sequence.loadAcquire() - pos);
+
+		if (diff == 0) {
+			if (this->enqueuePos.testAndSetRelaxed(pos, pos + 1, pos)) break;
+		} else if (diff < 0) {
+			this->mDropped.fetchAndAddRelaxed(1);
+			return false;
+		} else {
+			pos = this->enqueuePos.loadRelaxed();
+		}
+	}
+
+	slot->type = type;
+	slot->category = category;
+	slot->time = QDateTime::currentMSecsSinceEpoch();
+	slot->display = display;
+
+	auto encoder = QStringEncoder(QStringEncoder::Utf8);
+	slot->body.resize(encoder.requiredSpace(body.length()));
+	auto* end = encoder.appendToBuffer(slot->body.data(), body);
+	slot->body.resize(end - slot->body.constData());
+
+	slot->sequence.storeRelease(pos + 1);
+	return true;
+}
+
+bool LogQueue::claimWakeup() { return this->wakeupPending.testAndSetAcquire(false, true); }
+void LogQueue::clearWakeup() { this->wakeupPending.storeRelease(false); }
+
+LogQueue::Slot* LogQueue::front() {
+	auto pos = this->dequeuePos.loadRelaxed();
+	auto* slot = &this->slots[pos & (CAPACITY - 1)];
+	if (slot->sequence.loadAcquire() != pos + 1) return nullptr;
+	return slot;
+}
+
+void LogQueue::pop() {
+	auto pos = this->dequeuePos.loadRelaxed();
+	this->slots[pos & (CAPACITY - 1)].sequence.storeRelease(pos + CAPACITY);
+	this->dequeuePos.storeRelease(pos + 1);
+}
+
+void LogQueue::waitForDrain(int timeout) {
+	auto target = this->enqueuePos.loadAcquire();
+	QElapsedTimer timer;
+	timer.start();
+
+	while (this->dequeuePos.loadAcquire() < target && !timer.hasExpired(timeout)) {
+		QThread::yieldCurrentThread();
+	}
+}
+
 CompressedLogType compressedTypeOf(QtMsgType type) {
 	switch (type) {
 	case QtDebugMsg: return CompressedLogType::Debug;
@@ -503,15 +749,102 @@ QtMsgType typeOfCompressed(CompressedLogType type) {
 	return QtInfoMsg; // unreachable under normal conditions
 }
 
+WriteBuffer::~WriteBuffer() {
+#ifdef QS_LOG_ZSTD
+	ZSTD_freeCCtx(this->compressor);
+#endif
+}
+
 void WriteBuffer::setDevice(QIODevice* device) { this->device = device; }
 bool WriteBuffer::hasDevice() const { return this->device; }
+qsizetype WriteBuffer::length() const { return this->buffer.length(); }
+
+bool WriteBuffer::setCompressed(bool compressed) {
+#ifdef QS_LOG_ZSTD
+	if (!compressed) {
+		ZSTD_freeCCtx(this->compressor);
+		this->compressor = nullptr;
+		this->frameOpen = false;
+		return true;
+	}
+
+	if (this->compressor) return true;
+	this->compressor = ZSTD_createCCtx();
+	if (!this->compressor) return false;
+
+	// Small windows keep decompression memory low when following many logs.
+	ZSTD_CCtx_setParameter(this->compressor, ZSTD_c_compressionLevel, 3);
+	ZSTD_CCtx_setParameter(this->compressor, ZSTD_c_windowLog, 17);
+	return true;
+#else
+	return !compressed;
+#endif
+}
 
 bool WriteBuffer::flush() {
+	if (this->compressor) return this->compress(false);
+
 	auto written = this->device->write(this->buffer);
 	auto success = written == this->buffer.length();
+	if (written > 0) this->mWritten += written;
+	this->buffer.clear();
+	return success;
+}
+
+bool WriteBuffer::endFrame() {
+	if (!this->compressor || !this->frameOpen) return true;
+	return this->compress(true);
+}
+
+bool WriteBuffer::writeDirect(QByteArrayView bytes) {
+	auto written = this->device->write(bytes.data(), bytes.length());
+	if (written > 0) this->mWritten += written;
+	return written == bytes.length();
+}
+
+#ifdef QS_LOG_ZSTD
+bool WriteBuffer::compress(bool endFrame) {
+	auto input = ZSTD_inBuffer {
+	    .src = this->buffer.constData(),
+	    .size = static_cast<size_t>(this->buffer.length()),
+	    .pos = 0,
+	};
+
+	auto mode = endFrame ? ZSTD_e_end : ZSTD_e_flush;
+	this->compressed.resize(static_cast<qsizetype>(ZSTD_CStreamOutSize()));
+	auto success = true;
+
+	// flush and end directives are complete once zstd reports nothing remaining
+	while (true) {
+		auto output = ZSTD_outBuffer {
+		    .dst = this->compressed.data(),
+		    .size = static_cast<size_t>(this->compressed.length()),
+		    .pos = 0,
+		};
+
+		auto remaining = ZSTD_compressStream2(this->compressor, &output, &input, mode);
+		if (ZSTD_isError(remaining)) {
+			success = false;
+			break;
+		}
+
+		if (output.pos != 0) {
+			if (!this->writeDirect(QByteArrayView(this->compressed.constData(), output.pos))) {
+				success = false;
+				break;
+			}
+		}
+
+		if (remaining == 0) break;
+	}
+
+	this->frameOpen = !endFrame;
 	this->buffer.clear();
 	return success;
 }
+#else
+bool WriteBuffer::compress(bool /*endFrame*/) { return false; }
+#endif
 
 void WriteBuffer::writeBytes(const char* data, qsizetype length) {
 	this->buffer.append(data, length);
@@ -534,18 +867,187 @@ void WriteBuffer::writeU64(quint64 data) {
 	this->writeBytes(reinterpret_cast<char*>(&data), 8);
 }
 
-void DeviceReader::setDevice(QIODevice* device) { this->device = device; }
-bool DeviceReader::hasDevice() const { return this->device; }
+DeviceReader::~DeviceReader() {
+#ifdef QS_LOG_ZSTD
+	ZSTD_freeDCtx(this->decompressor);
+#endif
+}
+
+void DeviceReader::setDevice(QIODevice* device) {
+	this->device = device;
+	this->data = nullptr;
+	this->size = 0;
+	this->offset = 0;
+	this->rawPending.clear();
+	this->resetDecoded();
+}
+
+void DeviceReader::setData(const char* data, qsizetype size) {
+	this->device = nullptr;
+	this->data = data;
+	this->size = size;
+}
+
+bool DeviceReader::setCompressed() {
+#ifdef QS_LOG_ZSTD
+	if (!this->decompressor) this->decompressor = ZSTD_createDCtx();
+	this->resetDecoded();
+	return this->decompressor;
+#else
+	return false;
+#endif
+}
+
+bool DeviceReader::hasDevice() const { return this->device || this->data; }
+
+qint64 DeviceReader::pos() const {
+	if (this->device) return this->device->pos() - this->rawPending.length();
+	return this->offset;
+}
+
+qint64 DeviceReader::streamPos() const {
+	return this->decompressor ? this->decodedConsumed : this->pos();
+}
+
+bool DeviceReader::seek(qint64 pos) {
+	if (this->decompressor) this->resetDecoded();
+
+	if (this->device) {
+		this->rawPending.clear();
+		return this->device->seek(pos);
+	}
+
+	if (pos < 0 || pos > this->size) return false;
+	this->offset = pos;
+	return true;
+}
 
 bool DeviceReader::readBytes(char* data, qsizetype length) {
-	return this->device->read(data, length) == length;
+	if (this->decompressor) {
+		if (!this->fillDecoded(length)) return false;
+		memcpy(data, this->decoded.constData() + this->decodedOffset, length); // NOLINT
+		this->decodedOffset += length;
+		this->decodedConsumed += length;
+		return true;
+	}
+
+	if (this->device) return this->device->read(data, length) == length;
+	if (this->size - this->offset < length) return false;
+
+	memcpy(data, this->data + this->offset, length); // NOLINT
+	this->offset += length;
+	return true;
 }
 
 qsizetype DeviceReader::peekBytes(char* data, qsizetype length) {
-	return this->device->peek(data, length);
+	if (this->decompressor) {
+		this->fillDecoded(length);
+		length = qMin(length, this->decoded.length() - this->decodedOffset);
+		memcpy(data, this->decoded.constData() + this->decodedOffset, length); // NOLINT
+		return length;
+	}
+
+	if (this->device) return this->device->peek(data, length);
+
+	length = qMin(length, this->size - this->offset);
+	memcpy(data, this->data + this->offset, length); // NOLINT
+	return length;
+}
+
+bool DeviceReader::skip(qsizetype length) {
+	if (this->decompressor) {
+		if (!this->fillDecoded(length)) return false;
+		this->decodedOffset += length;
+		this->decodedConsumed += length;
+		return true;
+	}
+
+	if (this->device) return this->device->skip(length) == length;
+	if (this->size - this->offset < length) return false;
+
+	this->offset += length;
+	return true;
+}
+
+QByteArrayView DeviceReader::rawView(qsizetype want) {
+	if (!this->device) {
+		return QByteArrayView(this->data + this->offset, this->size - this->offset); // NOLINT
+	}
+
+	if (this->rawPending.length() < want) {
+		auto chunk = qMax(want - this->rawPending.length(), static_cast<qsizetype>(16384));
+		this->rawPending.append(this->device->read(chunk));
+	}
+
+	return this->rawPending;
 }
 
-bool DeviceReader::skip(qsizetype length) { return this->device->skip(length) == length; }
+void DeviceReader::rawConsume(qsizetype length) {
+	if (this->device) this->rawPending.remove(0, length);
+	else this->offset += length;
+}
+
+void DeviceReader::resetDecoded() {
+	this->inBlock = false;
+	this->decoded.clear();
+	this->decodedOffset = 0;
+	this->decodedConsumed = 0;
+}
+
+#ifdef QS_LOG_ZSTD
+bool DeviceReader::fillDecoded(qsizetype length) {
+	while (this->decoded.length() - this->decodedOffset < length) {
+		// drop consumed data before it grows past a frame's worth
+		if (this->decodedOffset > 64 * 1024) {
+			this->decoded.remove(0, this->decodedOffset);
+			this->decodedOffset = 0;
+		}
+
+		if (!this->inBlock) {
+			// A block header is only consumed once fully written, so reading can resume here.
+			auto header = this->rawView(LogBlockHeader::SIZE);
+			if (header.length() < LogBlockHeader::SIZE) return false;
+			if (static_cast<quint8>(header[0]) != LogBlockHeader::MARKER) return false;
+
+			this->rawConsume(LogBlockHeader::SIZE);
+			ZSTD_DCtx_reset(this->decompressor, ZSTD_reset_session_only);
+			this->inBlock = true;
+		}
+
+		auto raw = this->rawView(1);
+		if (raw.isEmpty()) return false;
+
+		auto input = ZSTD_inBuffer {
+		    .src = raw.data(),
+		    .size = static_cast<size_t>(raw.length()),
+		    .pos = 0,
+		};
+
+		auto start = this->decoded.length();
+		auto outSize = static_cast<qsizetype>(ZSTD_DStreamOutSize());
+		this->decoded.resize(start + outSize);
+
+		auto output = ZSTD_outBuffer {
+		    .dst = this->decoded.data() + start, // NOLINT
+		    .size = static_cast<size_t>(outSize),
+		    .pos = 0,
+		};
+
+		auto remaining = ZSTD_decompressStream(this->decompressor, &output, &input);
+		this->decoded.resize(start + static_cast<qsizetype>(output.pos));
+		if (ZSTD_isError(remaining)) return false;
+
+		this->rawConsume(static_cast<qsizetype>(input.pos));
+
+		if (remaining == 0) this->inBlock = false;
+		else if (input.pos == 0 && output.pos == 0) return false; // needs more input
+	}
+
+	return true;
+}
+#else
+bool DeviceReader::fillDecoded(qsizetype /*length*/) { return false; }
+#endif
 
 bool DeviceReader::readU8(quint8* data) {
 	return this->readBytes(reinterpret_cast<char*>(data), 1);
@@ -566,29 +1068,151 @@ bool DeviceReader::readU64(quint64* data) {
 void EncodedLogWriter::setDevice(QIODevice* target) { this->buffer.setDevice(target); }
 void EncodedLogReader::setDevice(QIODevice* source) { this->reader.setDevice(source); }
 
-constexpr quint8 LOG_VERSION = 2;
+void EncodedLogReader::setData(const char* data, qsizetype size) {
+	this->reader.setData(data, size);
+}
+
+qint64 EncodedLogReader::pos() const { return this->reader.pos(); }
+qint64 EncodedLogReader::streamPos() const { return this->reader.streamPos(); }
+qint64 EncodedLogReader::recordStart() const { return this->mRecordStart; }
+bool EncodedLogReader::isCompressed() const { return this->reader.isCompressed(); }
+bool EncodedLogReader::setCompressed() { return this->reader.setCompressed(); }
+bool EncodedLogReader::seek(qint64 pos) { return this->reader.seek(pos); }
+
+constexpr quint8 LOG_VERSION = 3;
+// Same encoding as LOG_VERSION, split into independently compressed blocks.
+constexpr quint8 COMPRESSED_LOG_VERSION = 4;
+
+void EncodedLogWriter::setIndexDevice(QIODevice* target) {
+	this->indexBuffer.setDevice(target);
+	if (!target) return;
+
+	this->indexBuffer.writeU8(LOG_VERSION);
+
+	for (const auto& point: this->syncPoints) {
+		this->indexBuffer.writeU64(point.offset);
+		this->indexBuffer.writeU64(point.time);
+	}
+
+	this->syncPoints.clear();
+
+	if (!this->indexBuffer.flush()) {
+		qCWarning(logLogging) << "Failed to write detailed log index. Reading logs will be slower.";
+		this->indexBuffer.setDevice(nullptr);
+	}
+}
+
+void EncodedLogWriter::setCompressed([[maybe_unused]] bool compressed) {
+#ifdef QS_LOG_ZSTD
+	this->compressed = compressed;
+#endif
+}
 
 bool EncodedLogWriter::writeHeader() {
-	this->buffer.writeU8(LOG_VERSION);
-	return this->buffer.flush();
+	this->buffer.resetWritten();
+	this->bytesSinceSync = 0;
+	this->syncPoints.clear();
+
+	// the header is never compressed
+	if (!this->buffer.setCompressed(false)) return false;
+	this->buffer.writeU8(this->compressed ? COMPRESSED_LOG_VERSION : LOG_VERSION);
+	if (!this->flush()) return false;
+
+	// compressed data must start with a block header
+	this->syncRequired = this->compressed;
+	return this->buffer.setCompressed(this->compressed);
+}
+
+bool EncodedLogWriter::flush() {
+	this->bytesSinceSync += this->buffer.length();
+	if (!this->buffer.flush()) return false;
+
+	// The index entry is written after the sync point is flushed so readers
+	// never see an index entry pointing at unwritten data.
+	if (this->syncPending) {
+		this->syncPending = false;
+		this->writeIndexEntry(this->syncPoints.last());
+	}
+
+	return true;
+}
+
+bool EncodedLogWriter::writeSyncPoint(const QDateTime& time) {
+	auto seconds = time.toSecsSinceEpoch();
+
+	// note: buffer is always empty here, as writes are flushed per message
+	if (this->compressed && !this->buffer.endFrame()) return false;
+
+	this->syncPoints.append(LogSyncPoint {
+	    .offset = static_cast<quint64>(this->buffer.written()),
+	    .time = static_cast<quint64>(seconds),
+	});
+
+	if (this->compressed) {
+		std::array<char, LogBlockHeader::SIZE> header {};
+		header[0] = static_cast<char>(LogBlockHeader::MARKER);
+		qToLittleEndian<quint64>(seconds, &header[1]);
+		if (!this->buffer.writeDirect(QByteArrayView(header.data(), header.size()))) return false;
+	}
+
+	this->syncPending = true;
+	this->syncRequired = false;
+	this->bytesSinceSync = 0;
+
+	this->writeOp(EncodedLogOpcode::SyncPoint);
+	this->buffer.writeU64(seconds);
+	this->writeVarInt(this->categoryList.length());
+
+	for (const auto& [name, flags]: this->categoryList) {
+		this->writeString(name);
+		this->buffer.writeU8(flags);
+	}
+
+	this->recentMessages.clear();
+	this->lastMessageTime = QDateTime::fromSecsSinceEpoch(seconds);
+	return true;
+}
+
+void EncodedLogWriter::writeIndexEntry(const LogSyncPoint& point) {
+	// Points are kept until an index device is set so memfd logs can be indexed once moved to disk.
+	if (!this->indexBuffer.hasDevice()) return;
+	this->syncPoints.clear();
+
+	this->indexBuffer.writeU64(point.offset);
+	this->indexBuffer.writeU64(point.time);
+
+	// Not logged, as this may be called from the direct message handler connection.
+	if (!this->indexBuffer.flush()) this->indexBuffer.setDevice(nullptr);
 }
 
 bool EncodedLogReader::readHeader(bool* success, quint8* version, quint8* readerVersion) {
 	if (!this->reader.readU8(version)) return false;
-	*success = *version == LOG_VERSION;
 	*readerVersion = LOG_VERSION;
+
+	if (*version == COMPRESSED_LOG_VERSION) {
+		*success = this->reader.setCompressed();
+	} else {
+		*success = *version == LOG_VERSION;
+	}
+
 	return true;
 }
 
-bool EncodedLogWriter::write(const LogMessage& message) {
+bool EncodedLogWriter::write(const LogMessage& message, bool borrowedBody) {
 	if (!this->buffer.hasDevice()) return false;
 
+	if (this->syncRequired || this->bytesSinceSync >= EncodedLogWriter::SYNC_INTERVAL) {
+		if (!this->writeSyncPoint(message.time)) return false;
+	}
+
 	LogMessage* prevMessage = nullptr;
 	auto index = this->recentMessages.indexOf(message, &prevMessage);
 
 	// If its a dupe, save memory by reusing the buffer of the first message and letting
 	// the new one be deallocated.
-	auto body = prevMessage ? prevMessage->body : message.body;
+	auto body = message.body;
+	if (prevMessage) body = prevMessage->body;
+	else if (borrowedBody) body = QByteArray(message.body.constData(), message.body.length());
 	this->recentMessages.emplace(message.type, message.category, body, message.time);
 
 	if (index != -1) {
@@ -644,11 +1268,12 @@ bool EncodedLogWriter::write(const LogMessage& message) {
 finish:
 	// copy with second precision
 	this->lastMessageTime = QDateTime::fromSecsSinceEpoch(message.time.toSecsSinceEpoch());
-	return this->buffer.flush();
+	return this->flush();
 }
 
-bool EncodedLogReader::read(LogMessage* slot) {
+bool EncodedLogReader::read(LogMessage* slot, LogQuery* query) {
 start:
+	this->mRecordStart = this->reader.streamPos();
 	quint32 next = 0;
 	if (!this->readVarInt(&next)) return false;
 
@@ -656,6 +1281,9 @@ start:
 		if (next == EncodedLogOpcode::RegisterCategory) {
 			if (!this->registerCategory()) return false;
 			goto start;
+		} else if (next == EncodedLogOpcode::SyncPoint) {
+			if (!this->readSyncPoint()) return false;
+			goto start;
 		} else if (next == EncodedLogOpcode::RecentMessageShort
 		           || next == EncodedLogOpcode::RecentMessageLong)
 		{
@@ -676,6 +1304,15 @@ start:
 			*slot = this->recentMessages.at(index);
 			this->lastMessageTime = this->lastMessageTime.addSecs(static_cast<qint64>(secondDelta));
 			slot->time = this->lastMessageTime;
+
+			// Repeats of a record rejected below are rejected again, as they share its category and
+			// level. Their placeholder bodies are never seen.
+			if (query && !query->isAfterRange(slot->time)
+			    && !query->acceptsRecord(*this, slot->readCategoryId, slot->category, slot->type))
+			{
+				this->recentMessages.emplace(*slot);
+				goto start;
+			}
 		}
 	} else {
 		auto categoryId = next - EncodedLogOpcode::BeginCategories;
@@ -709,11 +1346,31 @@ start:
 		}
 
 		this->lastMessageTime = this->lastMessageTime.addSecs(static_cast<qint64>(secondDelta));
+		auto categoryName = QLatin1StringView(category.first);
+
+		// Records past the end of the range are returned so the caller can stop reading.
+		if (query && !query->isAfterRange(this->lastMessageTime)
+		    && !query->acceptsRecord(*this, categoryId, categoryName, msgType))
+		{
+			quint32 length = 0;
+			if (!this->readVarInt(&length)) return false;
+			if (!this->reader.skip(length)) return false;
+
+			auto& skipped = this->recentMessages.emplace(
+			    msgType,
+			    categoryName,
+			    QByteArray(),
+			    this->lastMessageTime
+			);
+
+			skipped.readCategoryId = categoryId;
+			goto start;
+		}
 
 		QByteArray body;
 		if (!this->readString(&body)) return false;
 
-		*slot = LogMessage(msgType, QLatin1StringView(category.first), body, this->lastMessageTime);
+		*slot = LogMessage(msgType, categoryName, body, this->lastMessageTime);
 		slot->readCategoryId = categoryId;
 	}
 
@@ -794,6 +1451,7 @@ quint16 EncodedLogWriter::getOrCreateCategory(QLatin1StringView category) {
 		flags |= filter.critical << 3;
 
 		this->buffer.writeU8(flags);
+		this->categoryList.append(qMakePair(category, flags));
 		return id;
 	}
 }
@@ -814,8 +1472,109 @@ bool EncodedLogReader::registerCategory() {
 	return true;
 }
 
+bool EncodedLogReader::readSyncPoint() {
+	quint64 time = 0;
+	quint32 categoryCount = 0;
+	if (!this->reader.readU64(&time)) return false;
+	if (!this->readVarInt(&categoryCount)) return false;
+
+	for (quint32 i = 0; i != categoryCount; ++i) {
+		// Categories already known when reading sequentially are kept, as
+		// previously read messages reference their names.
+		if (i < this->categories.length()) {
+			quint32 length = 0;
+			if (!this->readVarInt(&length)) return false;
+			if (!this->reader.skip(length + 1)) return false;
+		} else {
+			if (!this->registerCategory()) return false;
+		}
+	}
+
+	this->recentMessages.clear();
+	this->lastMessageTime = QDateTime::fromSecsSinceEpoch(static_cast<qint64>(time));
+	return true;
+}
+
+LogIndex::~LogIndex() {
+	if (this->data) this->file.unmap(this->data);
+}
+
+QString LogIndex::pathFor(const QString& logPath) { return logPath % ".idx"; }
+
+bool LogIndex::open(const QString& logPath, qint64 logSize) {
+	this->file.setFileName(LogIndex::pathFor(logPath));
+	if (!this->file.open(QFile::ReadOnly)) return false;
+
+	auto size = this->file.size();
+	if (size < 1) return false;
+
+	this->data = this->file.map(0, size);
+	if (!this->data) return false;
+
+	if (this->data[0] != LOG_VERSION) {
+		qCWarning(logLogging) << "Ignoring log index" << this->file.fileName()
+		                      << "with mismatched version" << static_cast<int>(this->data[0]);
+		this->file.unmap(this->data);
+		this->data = nullptr;
+		return false;
+	}
+
+	this->count = (size - 1) / 16;
+	while (this->count > 0 && this->at(this->count - 1).offset >= static_cast<quint64>(logSize)) {
+		this->count--;
+	}
+
+	return true;
+}
+
+LogSyncPoint LogIndex::at(qsizetype i) const {
+	const auto* entry = this->data + 1 + i * 16; // NOLINT
+
+	return LogSyncPoint {
+	    .offset = qFromLittleEndian<quint64>(entry),
+	    .time = qFromLittleEndian<quint64>(entry + 8), // NOLINT
+	};
+}
+
+qsizetype LogIndex::findTime(const QDateTime& time) const {
+	auto seconds = static_cast<quint64>(time.toSecsSinceEpoch());
+
+	// first sync point at or after the given time
+	qsizetype low = 0;
+	qsizetype high = this->count;
+	while (low < high) {
+		auto mid = low + (high - low) / 2;
+		if (this->at(mid).time < seconds) low = mid + 1;
+		else high = mid;
+	}
+
+	return low - 1;
+}
+
+LogReader::~LogReader() {
+	if (this->mappedData) this->file->unmap(this->mappedData);
+}
+
+bool LogReader::mapFile() {
+	auto size = this->file->size();
+	if (this->mappedData && size == this->mappedSize) return true;
+
+	auto* data = this->file->map(0, size);
+	if (!data) return false;
+
+	if (this->mappedData) this->file->unmap(this->mappedData);
+	this->mappedData = data;
+	this->mappedSize = size;
+	this->reader.setData(reinterpret_cast<const char*>(data), size);
+	return true;
+}
+
 bool LogReader::initialize() {
-	this->reader.setDevice(this->file);
+	// Mapped reads avoid QIODevice overhead and are required for seeking via sync points.
+	if (!this->mapFile()) {
+		qCDebug(logLogging) << "Could not map log file, falling back to sequential reads.";
+		this->reader.setDevice(this->file);
+	}
 
 	bool readable = false;
 	quint8 logVersion = 0;
@@ -825,6 +1584,12 @@ bool LogReader::initialize() {
 		return false;
 	}
 
+	if (!readable && logVersion == COMPRESSED_LOG_VERSION) {
+		qCritical() << "This log is compressed, but this build of quickshell does not support "
+		               "log compression.";
+		return false;
+	}
+
 	if (!readable) {
 		qCritical() << "This log was encoded with version" << logVersion
 		            << "of the quickshell log encoder, which cannot be decoded by the current "
@@ -833,36 +1598,156 @@ bool LogReader::initialize() {
 		return false;
 	}
 
+	if (this->mappedData && (this->remainingTail != 0 || this->query.since().isValid())
+	    && this->index.open(this->file->fileName(), this->mappedSize))
+	{
+		auto dataStart = this->reader.pos();
+		auto start = this->findStart(dataStart);
+
+		if (start != dataStart) {
+			qCDebug(logLogging) << "Starting log read at sync point" << start;
+			if (!this->reader.seek(start)) return false;
+		}
+	}
+
 	return true;
 }
 
+// Finds the latest sync point reading can start from while still satisfying the tail and
+// time range. Walks backwards from the end of the log for tails, and binary searches for since.
+qint64 LogReader::findStart(qint64 dataStart) {
+	auto segmentStart = [&](qsizetype i) -> qint64 {
+		return i == 0 ? dataStart : static_cast<qint64>(this->index.at(i - 1).offset);
+	};
+
+	auto segmentTime = [&](qsizetype i) -> QDateTime {
+		if (i == 0) return QDateTime();
+		return QDateTime::fromSecsSinceEpoch(static_cast<qint64>(this->index.at(i - 1).time));
+	};
+
+	// segment i starts at sync point i - 1, with segment 0 starting after the header
+	qsizetype firstSegment = 0;
+	const auto& since = this->query.since();
+	const auto& until = this->query.until();
+	if (since.isValid()) firstSegment = this->index.findTime(since) + 1;
+
+	if (this->remainingTail == 0) return segmentStart(firstSegment);
+
+	const auto* data = reinterpret_cast<const char*>(this->mappedData);
+	auto segmentEnd = this->mappedSize;
+	qint64 count = 0;
+
+	for (auto i = this->index.size(); i > firstSegment; i--) {
+		auto start = segmentStart(i);
+		auto time = segmentTime(i);
+
+		// segments starting after the end of the range can't contain displayed messages
+		if (!until.isValid() || time <= until) {
+			EncodedLogReader segmentReader;
+			segmentReader.setData(data, segmentEnd);
+			if (!segmentReader.seek(start)) return dataStart;
+			if (this->reader.isCompressed() && !segmentReader.setCompressed()) return dataStart;
+
+			LogMessage message;
+			while (segmentReader.read(&message, &this->query)) {
+				if (this->query.accepts(segmentReader, message)) count++;
+			}
+		}
+
+		if (count >= this->remainingTail) return start;
+		segmentEnd = start;
+	}
+
+	return segmentStart(firstSegment);
+}
+
+bool LogQuery::acceptsRecord(
+    EncodedLogReader& reader,
+    quint16 categoryId,
+    QLatin1StringView category,
+    QtMsgType type
+) {
+	auto filter = this->filters.find(categoryId);
+
+	if (filter == this->filters.end()) {
+		auto newFilter = reader.categoryFilterById(categoryId);
+
+		for (const auto& rule: this->rules) {
+			newFilter.applyRule(category, rule);
+		}
+
+		filter = this->filters.insert(categoryId, newFilter);
+	}
+
+	return filter->shouldDisplay(type);
+}
+
+bool LogQuery::isAfterRange(const QDateTime& time) const {
+	return this->mUntil.isValid() && time > this->mUntil;
+}
+
+bool LogQuery::accepts(EncodedLogReader& reader, const LogMessage& message) {
+	if (this->mSince.isValid() && message.time < this->mSince) return false;
+	if (this->isAfterRange(message.time)) return false;
+	if (!this->acceptsRecord(reader, message.readCategoryId, message.category, message.type)) {
+		return false;
+	}
+
+	if (!this->pattern.pattern().isEmpty()) {
+		return this->pattern.match(QString::fromUtf8(message.body)).hasMatch();
+	}
+
+	return true;
+}
+
+void LogReader::writeMessage(QTextStream& stream, const LogMessage& message, bool color) {
+	if (!this->json) {
+		LogMessage::formatMessage(stream, message, color, this->timestamps);
+		stream << '\n';
+		return;
+	}
+
+	const char* level = "debug";
+	switch (message.type) {
+	case QtDebugMsg: break;
+	case QtInfoMsg: level = "info"; break;
+	case QtWarningMsg: level = "warn"; break;
+	case QtCriticalMsg: level = "error"; break;
+	case QtFatalMsg: level = "fatal"; break;
+	}
+
+	auto object = QJsonObject();
+	object["time"] = message.time.toString(Qt::ISODateWithMs);
+	object["level"] = QLatin1StringView(level);
+	object["category"] = QString(message.category);
+	object["message"] = QString::fromUtf8(message.body);
+
+	stream << QJsonDocument(object).toJson(QJsonDocument::Compact) << '\n';
+}
+
 bool LogReader::continueReading() {
+	if (this->finished) return true;
+
+	if (this->mappedData && !this->mapFile()) {
+		qCritical() << "Failed to map log file.";
+		return false;
+	}
+
 	auto color = LogManager::instance()->colorLogs;
 	auto tailRing = RingBuffer<LogMessage>(this->remainingTail);
 
 	LogMessage message;
 	auto stream = QTextStream(stdout);
-	auto readCursor = this->file->pos();
-	while (this->reader.read(&message)) {
-		readCursor = this->file->pos();
-
-		CategoryFilter filter;
-		if (this->filters.contains(message.readCategoryId)) {
-			filter = this->filters.value(message.readCategoryId);
-		} else {
-			filter = this->reader.categoryFilterById(message.readCategoryId);
-
-			for (const auto& rule: this->rules) {
-				filter.applyRule(message.category, rule);
-			}
-
-			this->filters.insert(message.readCategoryId, filter);
+	while (this->reader.read(&message, &this->query)) {
+		// times are monotonic, so nothing after this can be displayed
+		if (this->query.isAfterRange(message.time)) {
+			this->finished = true;
+			break;
 		}
 
-		if (filter.shouldDisplay(message.type)) {
+		if (this->query.accepts(this->reader, message)) {
 			if (this->remainingTail == 0) {
-				LogMessage::formatMessage(stream, message, color, this->timestamps);
-				stream << '\n';
+				this->writeMessage(stream, message, color);
 			} else {
 				tailRing.emplace(message);
 			}
@@ -871,17 +1756,27 @@ bool LogReader::continueReading() {
 
 	if (this->remainingTail != 0) {
 		for (auto i = tailRing.size() - 1; i != -1; i--) {
-			auto& message = tailRing.at(i);
-			LogMessage::formatMessage(stream, message, color, this->timestamps);
-			stream << '\n';
+			this->writeMessage(stream, tailRing.at(i), color);
 		}
 	}
 
 	stream << Qt::flush;
 
-	if (this->file->pos() != readCursor) {
+	// a failed read that consumed data means the last record is incomplete or corrupt
+	auto readCursor = this->reader.recordStart();
+	if (!this->finished && this->reader.streamPos() != readCursor) {
 		qCritical() << "An error occurred parsing the end of this log file.";
-		qCritical() << "Remaining data:" << this->file->readAll();
+
+		// decompressed data is not kept around, and raw compressed data isn't useful to print
+		if (!this->reader.isCompressed()) {
+			if (this->mappedData) {
+				auto remaining = QByteArrayView(this->mappedData, this->mappedSize).sliced(readCursor);
+				qCritical() << "Remaining data:" << remaining.toByteArray();
+			} else {
+				qCritical() << "Remaining data:" << this->file->readAll();
+			}
+		}
+
 		return false;
 	}
 
@@ -943,7 +1838,11 @@ bool readEncodedLogs(
     bool timestamps,
     int tail,
     bool follow,
-    const QString& rulespec
+    const QString& rulespec,
+    const QDateTime& since,
+    const QDateTime& until,
+    const QString& pattern,
+    bool json
 ) {
 	QList<QLoggingRule> rules;
 
@@ -953,12 +1852,19 @@ bool readEncodedLogs(
 		rules = parser.rules();
 	}
 
-	auto reader = LogReader(file, timestamps, tail, rules);
+	auto regex = QRegularExpression(pattern);
+	if (!regex.isValid()) {
+		qCritical().noquote() << "Invalid pattern" << pattern << "-" << regex.errorString();
+		return false;
+	}
+
+	auto query = LogQuery(std::move(rules), since, until, regex);
+	auto reader = LogReader(file, timestamps, json, tail, std::move(query));
 
 	if (!reader.initialize()) return false;
 	if (!reader.continueReading()) return false;
 
-	if (follow) {
+	if (follow && !reader.isFinished()) {
 		auto follower = LogFollower(&reader, path);
 		return follower.follow();
 	}
@@ -2,6 +2,7 @@
 
 #include <utility>
 
+#include <qatomic.h>
 #include <qbytearrayview.h>
 #include <qcontainerfwd.h>
 #include <qdatetime.h>
@@ -53,6 +54,7 @@ struct LogMessage {
 size_t qHash(const LogMessage& message);
 
 class ThreadLogging;
+class LogQueue;
 
 class LoggingThreadProxy: public QObject {
 	Q_OBJECT;
@@ -115,6 +117,9 @@ public:
 
 	[[nodiscard]] CategoryFilter getFilter(QLatin1StringView category);
 
+	// Number of messages dropped because the asynchronous log queue was full.
+	[[nodiscard]] quint64 droppedMessages() const;
+
 signals:
 	void logMessage(LogMessage msg, bool showInSparse);
 
@@ -136,8 +141,11 @@ private:
 
 	QTextStream stdoutStream;
 	LoggingThreadProxy threadProxy;
+	// Set once filesystem logging starts if QS_ASYNC_LOGS is set.
+	QAtomicPointer<LogQueue> asyncQueue;
 
 	friend void initLogCategoryLevel(const char* name, QtMsgType defaultLevel);
+	friend class ThreadLogging;
 };
 
 bool readEncodedLogs(
@@ -146,7 +154,11 @@ bool readEncodedLogs(
     bool timestamps,
     int tail,
     bool follow,
-    const QString& rulespec
+    const QString& rulespec,
+    const QDateTime& since = QDateTime(),
+    const QDateTime& until = QDateTime(),
+    const QString& pattern = QString(),
+    bool json = false
 );
 
 } // namespace qs::log
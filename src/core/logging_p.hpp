@@ -1,12 +1,18 @@
 #pragma once
+#include <memory>
 #include <utility>
 
+#include <qatomic.h>
 #include <qbytearrayview.h>
 #include <qcontainerfwd.h>
+#include <qdatetime.h>
 #include <qfile.h>
 #include <qfilesystemwatcher.h>
 #include <qlogging.h>
 #include <qobject.h>
+#include <qregularexpression.h>
+#include <qtextstream.h>
+#include <qtclasshelpermacros.h>
 #include <qthread.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
@@ -15,12 +21,17 @@
 #include "logging_qtprivate.hpp"
 #include "ringbuf.hpp"
 
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
 namespace qs::log {
 
 enum EncodedLogOpcode : quint8 {
 	RegisterCategory = 0,
 	RecentMessageShort,
 	RecentMessageLong,
+	// Resets decoder state so reading can begin at this point. See LogIndex.
+	SyncPoint,
 	BeginCategories,
 };
 
@@ -34,11 +45,34 @@ enum CompressedLogType : quint8 {
 CompressedLogType compressedTypeOf(QtMsgType type);
 QtMsgType typeOfCompressed(CompressedLogType type);
 
+// Compressed logs are a sequence of blocks, each a block header followed by a single zstd frame
+// starting with a sync point. Blocks can be decompressed independently of each other.
+struct LogBlockHeader {
+	static constexpr quint8 MARKER = 0xb1;
+	static constexpr qsizetype SIZE = 9; // u8 marker, u64 epoch secs
+};
+
 class WriteBuffer {
 public:
+	explicit WriteBuffer() = default;
+	~WriteBuffer();
+	Q_DISABLE_COPY_MOVE(WriteBuffer);
+
 	void setDevice(QIODevice* device);
 	[[nodiscard]] bool hasDevice() const;
+	[[nodiscard]] qsizetype length() const;
+	// Total bytes written to the device, after compression.
+	[[nodiscard]] qint64 written() const { return this->mWritten; }
+	void resetWritten() { this->mWritten = 0; }
+	// Compresses flushed data into a zstd frame. Returns false if built without zstd.
+	[[nodiscard]] bool setCompressed(bool compressed);
+	[[nodiscard]] bool isCompressed() const { return this->compressor; }
+	// Flushed data is always decodable, even if the current frame has not ended.
 	[[nodiscard]] bool flush();
+	// Ends the current zstd frame, if one has been started.
+	[[nodiscard]] bool endFrame();
+	// Writes directly to the device, bypassing compression. Buffered data is not flushed.
+	[[nodiscard]] bool writeDirect(QByteArrayView bytes);
 	void writeBytes(const char* data, qsizetype length);
 	void writeU8(quint8 data);
 	void writeU16(quint16 data);
@@ -46,14 +80,37 @@ public:
 	void writeU64(quint64 data);
 
 private:
+	[[nodiscard]] bool compress(bool endFrame);
+
 	QIODevice* device = nullptr;
 	QByteArray buffer;
+	qint64 mWritten = 0;
+	ZSTD_CCtx_s* compressor = nullptr;
+	QByteArray compressed;
+	bool frameOpen = false;
 };
 
+// Reads from either a device or a memory mapped region, optionally decompressing log blocks.
 class DeviceReader {
 public:
+	explicit DeviceReader() = default;
+	~DeviceReader();
+	Q_DISABLE_COPY_MOVE(DeviceReader);
+
 	void setDevice(QIODevice* device);
+	// Replaces the readable region without changing the read position.
+	void setData(const char* data, qsizetype size);
+	// Treats all data after the current position as compressed log blocks.
+	// Returns false if built without zstd.
+	[[nodiscard]] bool setCompressed();
+	[[nodiscard]] bool isCompressed() const { return this->decompressor; }
 	[[nodiscard]] bool hasDevice() const;
+	// Position in the underlying data. Inside a compressed block this is past the
+	// last decompressed input, so it is only meaningful for seeking between blocks.
+	[[nodiscard]] qint64 pos() const;
+	// Position in the decoded stream. Equal to pos() for uncompressed data.
+	[[nodiscard]] qint64 streamPos() const;
+	[[nodiscard]] bool seek(qint64 pos);
 	[[nodiscard]] bool readBytes(char* data, qsizetype length);
 	// peek UP TO length
 	[[nodiscard]] qsizetype peekBytes(char* data, qsizetype length);
@@ -64,49 +121,215 @@ public:
 	[[nodiscard]] bool readU64(quint64* data);
 
 private:
+	// Returns at least want bytes of undecoded input if available, reading from the device if needed.
+	QByteArrayView rawView(qsizetype want);
+	void rawConsume(qsizetype length);
+	// Decompresses until length decoded bytes are available, or input runs out.
+	bool fillDecoded(qsizetype length);
+	void resetDecoded();
+
 	QIODevice* device = nullptr;
+	const char* data = nullptr;
+	qsizetype size = 0;
+	qsizetype offset = 0;
+
+	ZSTD_DCtx_s* decompressor = nullptr;
+	bool inBlock = false;
+	QByteArray rawPending;
+	QByteArray decoded;
+	qsizetype decodedOffset = 0;
+	qint64 decodedConsumed = 0;
+};
+
+struct LogSyncPoint {
+	quint64 offset = 0;
+	quint64 time = 0;
+};
+
+// Sidecar index of sync points in a detailed log, stored next to it as <log>.idx.
+// The index is a version byte followed by little endian (u64 offset, u64 epoch secs) pairs,
+// and is only used to skip ahead. Logs without an index are read sequentially.
+class LogIndex {
+public:
+	explicit LogIndex() = default;
+	~LogIndex();
+	Q_DISABLE_COPY_MOVE(LogIndex);
+
+	// Sync points past logSize are ignored, as the log may not have been flushed yet.
+	bool open(const QString& logPath, qint64 logSize);
+
+	[[nodiscard]] qsizetype size() const { return this->count; }
+	[[nodiscard]] LogSyncPoint at(qsizetype i) const;
+	// Returns the index of the last sync point before the given time, or -1.
+	// Messages in the same second as a sync point may precede it, so equal times are excluded.
+	[[nodiscard]] qsizetype findTime(const QDateTime& time) const;
+
+	static QString pathFor(const QString& logPath);
+
+private:
+	QFile file;
+	uchar* data = nullptr;
+	qsizetype count = 0;
 };
 
 class EncodedLogWriter {
 public:
 	void setDevice(QIODevice* target);
+	// Writes all sync points recorded so far, then keeps the index updated.
+	void setIndexDevice(QIODevice* target);
+	// Must be called before writeHeader. Has no effect if built without zstd.
+	void setCompressed(bool compressed);
 	[[nodiscard]] bool writeHeader();
-	[[nodiscard]] bool write(const LogMessage& message);
+	// If borrowedBody is set the message body may not outlive the call, and is copied
+	// if it needs to be kept for deduplication.
+	[[nodiscard]] bool write(const LogMessage& message, bool borrowedBody = false);
+
+	// Approximate number of uncompressed bytes between sync points.
+	static constexpr qint64 SYNC_INTERVAL = 64 * 1024;
 
 private:
 	void writeOp(EncodedLogOpcode opcode);
 	void writeVarInt(quint32 n);
 	void writeString(QByteArrayView bytes);
+	[[nodiscard]] bool writeSyncPoint(const QDateTime& time);
+	void writeIndexEntry(const LogSyncPoint& point);
 	quint16 getOrCreateCategory(QLatin1StringView category);
+	[[nodiscard]] bool flush();
 
 	WriteBuffer buffer;
+	WriteBuffer indexBuffer;
 
 	QHash<QLatin1StringView, quint16> categories;
+	QList<QPair<QLatin1StringView, quint8>> categoryList;
 	quint16 nextCategory = EncodedLogOpcode::BeginCategories;
 
+	bool compressed = false;
+	bool syncRequired = false;
+	qint64 bytesSinceSync = 0;
+	QList<LogSyncPoint> syncPoints;
+	bool syncPending = false;
+
 	QDateTime lastMessageTime = QDateTime::fromSecsSinceEpoch(0);
 	HashBuffer<LogMessage> recentMessages {256};
 };
 
+class LogQuery;
+
 class EncodedLogReader {
 public:
 	void setDevice(QIODevice* source);
+	void setData(const char* data, qsizetype size);
+	[[nodiscard]] qint64 pos() const;
+	[[nodiscard]] qint64 streamPos() const;
+	// Stream position of the start of the last record read or attempted.
+	[[nodiscard]] qint64 recordStart() const;
+	[[nodiscard]] bool isCompressed() const;
+	// Must be called after reading the header of a compressed log.
+	[[nodiscard]] bool setCompressed();
+	// Only valid for the end of the header or the offset of a sync point.
+	[[nodiscard]] bool seek(qint64 pos);
 	[[nodiscard]] bool readHeader(bool* success, quint8* logVersion, quint8* readerVersion);
 	// WARNING: log messages written to the given slot are invalidated when the log reader is destroyed.
-	[[nodiscard]] bool read(LogMessage* slot);
+	// If a query is given, records rejected by its category and level predicates are skipped
+	// without decoding their bodies. Other predicates must still be checked by the caller.
+	[[nodiscard]] bool read(LogMessage* slot, LogQuery* query = nullptr);
 	[[nodiscard]] CategoryFilter categoryFilterById(quint16 id);
 
 private:
 	[[nodiscard]] bool readVarInt(quint32* slot);
 	[[nodiscard]] bool readString(QByteArray* slot);
 	[[nodiscard]] bool registerCategory();
+	[[nodiscard]] bool readSyncPoint();
 
 	DeviceReader reader;
+	qint64 mRecordStart = 0;
 	QVector<QPair<QByteArray, CategoryFilter>> categories;
 	QDateTime lastMessageTime = QDateTime::fromSecsSinceEpoch(0);
 	RingBuffer<LogMessage> recentMessages {256};
 };
 
+class LogQuery {
+public:
+	explicit LogQuery(
+	    QList<qt_logging_registry::QLoggingRule> rules,
+	    QDateTime since = QDateTime(),
+	    QDateTime until = QDateTime(),
+	    QRegularExpression pattern = QRegularExpression()
+	)
+	    : rules(std::move(rules))
+	    , mSince(std::move(since))
+	    , mUntil(std::move(until))
+	    , pattern(std::move(pattern)) {}
+
+	// Only depends on the category and level, so filters are cached per category id.
+	[[nodiscard]] bool acceptsRecord(
+	    EncodedLogReader& reader,
+	    quint16 categoryId,
+	    QLatin1StringView category,
+	    QtMsgType type
+	);
+
+	[[nodiscard]] bool accepts(EncodedLogReader& reader, const LogMessage& message);
+	[[nodiscard]] bool isAfterRange(const QDateTime& time) const;
+
+	[[nodiscard]] const QDateTime& since() const { return this->mSince; }
+	[[nodiscard]] const QDateTime& until() const { return this->mUntil; }
+
+private:
+	QList<qt_logging_registry::QLoggingRule> rules;
+	QDateTime mSince;
+	QDateTime mUntil;
+	QRegularExpression pattern;
+	QHash<quint16, CategoryFilter> filters;
+};
+
+// Fixed capacity multi producer, single consumer queue of preallocated log message slots.
+// Producers never block or allocate once a slot's body buffer has grown to fit its messages.
+class LogQueue {
+public:
+	explicit LogQueue(ThreadLogging* consumer);
+	Q_DISABLE_COPY_MOVE(LogQueue);
+	~LogQueue() = default;
+
+	struct Slot {
+		QAtomicInteger<quint64> sequence;
+		QtMsgType type = QtDebugMsg;
+		QLatin1StringView category;
+		qint64 time = 0;
+		bool display = false;
+		QByteArray body;
+	};
+
+	// Returns false and counts a dropped message if the queue is full. Safe from any thread.
+	bool push(QtMsgType type, QLatin1StringView category, QStringView body, bool display);
+
+	// Returns true if the caller is responsible for waking the consumer.
+	bool claimWakeup();
+	void clearWakeup();
+
+	// Consumer only. Returns nullptr if the queue is empty.
+	[[nodiscard]] Slot* front();
+	void pop();
+
+	// Waits up to timeout ms for the consumer to drain messages queued before the call.
+	void waitForDrain(int timeout);
+
+	[[nodiscard]] quint64 dropped() const { return this->mDropped.loadRelaxed(); }
+
+	ThreadLogging* consumer;
+
+	static constexpr quint64 CAPACITY = 1024; // must be a power of 2
+	static constexpr qsizetype SLOT_RESERVE = 256;
+	static constexpr qsizetype BATCH_SIZE = 128;
+
+private:
+	std::unique_ptr<Slot[]> slots; // NOLINT
+	QAtomicInteger<quint64> enqueuePos = 0;
+	QAtomicInteger<quint64> dequeuePos = 0;
+	QAtomicInteger<bool> wakeupPending = false;
+	QAtomicInteger<quint64> mDropped = 0;
+};
+
 class ThreadLogging: public QObject {
 	Q_OBJECT;
 
@@ -117,43 +340,68 @@ public:
 	void initFs();
 	void setupFileLogging();
 
+	// Writes all messages currently in the async queue, batching stdout writes.
+	void drainQueue();
+
 private slots:
 	void onMessage(const LogMessage& msg, bool showInSparse);
 
 private:
+	// Writes to log files without flushing the sparse log.
+	void writeMessage(const LogMessage& msg, bool showInSparse, bool borrowedBody = false);
+	void formatLine(const LogMessage& msg, QByteArray* line);
+
+	LogQueue* queue = nullptr;
+	quint64 reportedDropped = 0;
+	QString lineString;
+	QTextStream lineStream;
+	QList<QByteArray> lineBuffers;
+
 	QFile* file = nullptr;
 	QTextStream fileStream;
 	QFile* detailedFile = nullptr;
+	QFile* indexFile = nullptr;
 	EncodedLogWriter detailedWriter;
+
+	friend class TestLogQueue;
 };
 
 class LogFollower;
 
 class LogReader {
 public:
-	explicit LogReader(
-	    QFile* file,
-	    bool timestamps,
-	    int tail,
-	    QList<qt_logging_registry::QLoggingRule> rules
-	)
+	explicit LogReader(QFile* file, bool timestamps, bool json, int tail, LogQuery query)
 	    : file(file)
 	    , timestamps(timestamps)
+	    , json(json)
 	    , remainingTail(tail)
-	    , rules(std::move(rules)) {}
+	    , query(std::move(query)) {}
+
+	~LogReader();
+	Q_DISABLE_COPY_MOVE(LogReader);
 
 	bool initialize();
 	bool continueReading();
+	[[nodiscard]] bool isFinished() const { return this->finished; }
 
 private:
+	bool mapFile();
+	qint64 findStart(qint64 dataStart);
+	void writeMessage(QTextStream& stream, const LogMessage& message, bool color);
+
 	QFile* file;
+	uchar* mappedData = nullptr;
+	qint64 mappedSize = 0;
 	EncodedLogReader reader;
+	LogIndex index;
 	bool timestamps;
+	bool json;
 	int remainingTail;
-	QHash<quint16, CategoryFilter> filters;
-	QList<qt_logging_registry::QLoggingRule> rules;
+	LogQuery query;
+	bool finished = false;
 
 	friend class LogFollower;
+	friend class TestLogIndex;
 };
 
 class LogFollower: public QObject {
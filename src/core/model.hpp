@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 
 #include <QtCore/qtmetamacros.h>
@@ -13,6 +14,7 @@
 #include <qvariant.h>
 
 #include "doc.hpp"
+#include "listdiff.hpp"
 
 ///! View into a list of objets
 /// Typed view into a list of objects.
@@ -128,21 +130,14 @@ public:
 		emit this->objectRemovedPost(object, index);
 	}
 
-	// Assumes only one instance of a specific value
+	// Produces batched remove, move and insert operations. Moved objects do not
+	// emit object inserted or removed signals.
 	void diffUpdate(const QList<T*>& newValues) {
-		for (qsizetype i = 0; i < this->mValuesList.length();) {
-			if (newValues.contains(this->mValuesList.at(i))) i++;
-			else this->removeAt(i);
-		}
-
-		qsizetype oi = 0;
-		for (auto* object: newValues) {
-			if (this->mValuesList.length() == oi || this->mValuesList.at(oi) != object) {
-				this->insertObject(object, oi);
-			}
+		auto handler = DiffHandler(this, newValues);
+		auto oldValues = this->mValuesList;
+		diffKeys(oldValues, newValues, handler);
 
-			oi++;
-		}
+		if (handler.changed) emit this->valuesChanged();
 	}
 
 	static ObjectModel<T>* emptyInstance() {
@@ -170,5 +165,75 @@ public:
 	}
 
 private:
+	class DiffHandler {
+	public:
+		DiffHandler(ObjectModel* model, const QList<T*>& newValues)
+		    : model(model)
+		    , newValues(newValues) {}
+
+		void remove(qsizetype index, qsizetype count) {
+			auto& list = this->model->mValuesList;
+			auto removed = list.sliced(index, count);
+
+			for (qsizetype i = 0; i != count; i++) {
+				emit this->model->objectRemovedPre(removed.at(i), index + i);
+			}
+
+			auto first = static_cast<qint32>(index);
+			this->model->beginRemoveRows(QModelIndex(), first, first + static_cast<qint32>(count) - 1);
+			list.remove(index, count);
+			this->model->endRemoveRows();
+
+			for (qsizetype i = 0; i != count; i++) {
+				emit this->model->objectRemovedPost(removed.at(i), index + i);
+			}
+
+			this->changed = true;
+		}
+
+		void insert(qsizetype index, qsizetype newIndex, qsizetype count) {
+			auto& list = this->model->mValuesList;
+			auto inserted = this->newValues.sliced(newIndex, count);
+
+			for (qsizetype i = 0; i != count; i++) {
+				emit this->model->objectInsertedPre(inserted.at(i), index + i);
+			}
+
+			auto first = static_cast<qint32>(index);
+			this->model->beginInsertRows(QModelIndex(), first, first + static_cast<qint32>(count) - 1);
+			list.insert(index, count, nullptr);
+			std::ranges::copy(inserted, list.begin() + index);
+			this->model->endInsertRows();
+
+			for (qsizetype i = 0; i != count; i++) {
+				emit this->model->objectInsertedPost(inserted.at(i), index + i);
+			}
+
+			this->changed = true;
+		}
+
+		void move(qsizetype from, qsizetype count, qsizetype to) {
+			auto& list = this->model->mValuesList;
+			auto first = static_cast<qint32>(from);
+			auto last = first + static_cast<qint32>(count) - 1;
+
+			auto dest = static_cast<qint32>(to);
+
+			this->model->beginMoveRows(QModelIndex(), first, last, QModelIndex(), dest);
+			std::rotate(list.begin() + to, list.begin() + from, list.begin() + from + count);
+			this->model->endMoveRows();
+
+			this->changed = true;
+		}
+
+		void keep([[maybe_unused]] qsizetype index, [[maybe_unused]] qsizetype newIndex) {}
+
+		bool changed = false;
+
+	private:
+		ObjectModel* model;
+		const QList<T*>& newValues;
+	};
+
 	QList<T*> mValuesList;
 };
@@ -24,6 +24,7 @@
 #include <unistd.h>
 
 #include "../io/processcore.hpp"
+#include "../io/spawn.hpp"
 #include "generation.hpp"
 #include "iconimageprovider.hpp"
 #include "paths.hpp"
@@ -48,7 +49,11 @@ QuickshellSettings* QuickshellSettings::instance() {
 	return instance;
 }
 
-void QuickshellSettings::reset() { QuickshellSettings::instance()->mWatchFiles = true; }
+void QuickshellSettings::reset() {
+	auto* settings = QuickshellSettings::instance();
+	settings->mWatchFiles = true;
+	settings->mIncrementalReload = false;
+}
 
 QString QuickshellSettings::workingDirectory() const { // NOLINT
 	return QDir::current().absolutePath();
@@ -67,6 +72,14 @@ void QuickshellSettings::setWatchFiles(bool watchFiles) {
 	emit this->watchFilesChanged();
 }
 
+bool QuickshellSettings::incrementalReload() const { return this->mIncrementalReload; }
+
+void QuickshellSettings::setIncrementalReload(bool incrementalReload) {
+	if (incrementalReload == this->mIncrementalReload) return;
+	this->mIncrementalReload = incrementalReload;
+	emit this->incrementalReloadChanged();
+}
+
 QuickshellTracked::QuickshellTracked() {
 	auto* app = QCoreApplication::instance();
 	auto* guiApp = qobject_cast<QGuiApplication*>(app);
@@ -133,6 +146,7 @@ QuickshellGlobal::QuickshellGlobal(QObject* parent): QObject(parent) {
 	// clang-format off
 	QObject::connect(QuickshellSettings::instance(), &QuickshellSettings::workingDirectoryChanged, this, &QuickshellGlobal::workingDirectoryChanged);
 	QObject::connect(QuickshellSettings::instance(), &QuickshellSettings::watchFilesChanged, this, &QuickshellGlobal::watchFilesChanged);
+	QObject::connect(QuickshellSettings::instance(), &QuickshellSettings::incrementalReloadChanged, this, &QuickshellGlobal::incrementalReloadChanged);
 	QObject::connect(QuickshellSettings::instance(), &QuickshellSettings::lastWindowClosed, this, &QuickshellGlobal::lastWindowClosed);
 
 	QObject::connect(QuickshellTracked::instance(), &QuickshellTracked::screensChanged, this, &QuickshellGlobal::screensChanged);
@@ -196,6 +210,14 @@ void QuickshellGlobal::setWatchFiles(bool watchFiles) { // NOLINT
 	QuickshellSettings::instance()->setWatchFiles(watchFiles);
 }
 
+bool QuickshellGlobal::incrementalReload() const { // NOLINT
+	return QuickshellSettings::instance()->incrementalReload();
+}
+
+void QuickshellGlobal::setIncrementalReload(bool incrementalReload) { // NOLINT
+	QuickshellSettings::instance()->setIncrementalReload(incrementalReload);
+}
+
 QString QuickshellGlobal::clipboardText() {
 	return static_cast<QGuiApplication*>(QGuiApplication::instance())->clipboard()->text(); // NOLINT
 }
@@ -280,6 +302,21 @@ void QuickshellGlobal::execDetached(const qs::io::process::ProcessContext& conte
 	const auto& cmd = context.command.first();
 	auto args = context.command.sliced(1);
 
+	if (context.fastSpawn) {
+		auto started = qs::io::process::SpawnedProcess::startDetached({
+		    .program = cmd,
+		    .arguments = args,
+		    .environment = qs::io::process::createProcessEnvironment(
+		        context.clearEnvironment,
+		        context.environment
+		    ),
+		    .workingDirectory = context.workingDirectory,
+		    .inheritOutput = !context.unbindStdout,
+		});
+
+		if (started) return;
+	}
+
 	QProcess process;
 	qs::io::process::setupProcessEnvironment(&process, context.clearEnvironment, context.environment);
 
@@ -28,6 +28,14 @@ class QuickshellSettings: public QObject {
 	/// If true then the configuration will be reloaded whenever any files change.
 	/// Defaults to true.
 	Q_PROPERTY(bool watchFiles READ watchFiles WRITE setWatchFiles NOTIFY watchFilesChanged);
+	/// If true then changes to files which are only loaded by @@LazyLoader.source are applied by
+	/// recreating those loaders' items in place, instead of reloading the whole configuration.
+	/// Reloadable state such as windows is carried over from the old items.
+	///
+	/// Changes to the root file, singletons, types used by other files, or the set of files
+	/// in the configuration still cause a full reload, as do changes that fail to compile.
+	/// Defaults to false.
+	Q_PROPERTY(bool incrementalReload READ incrementalReload WRITE setIncrementalReload NOTIFY incrementalReloadChanged);
 	// clang-format on
 	QML_ELEMENT;
 	QML_UNCREATABLE("singleton");
@@ -41,6 +49,9 @@ public:
 	[[nodiscard]] bool watchFiles() const;
 	void setWatchFiles(bool watchFiles);
 
+	[[nodiscard]] bool incrementalReload() const;
+	void setIncrementalReload(bool incrementalReload);
+
 	[[nodiscard]] bool quitOnLastClosed() const;
 	void setQuitOnLastClosed(bool exitOnLastClosed);
 
@@ -55,9 +66,11 @@ signals:
 
 	void workingDirectoryChanged();
 	void watchFilesChanged();
+	void incrementalReloadChanged();
 
 private:
 	bool mWatchFiles = true;
+	bool mIncrementalReload = false;
 };
 
 class QuickshellTracked: public QObject {
@@ -118,6 +131,14 @@ class QuickshellGlobal: public QObject {
 	/// If true then the configuration will be reloaded whenever any files change.
 	/// Defaults to true.
 	Q_PROPERTY(bool watchFiles READ watchFiles WRITE setWatchFiles NOTIFY watchFilesChanged);
+	/// If true then changes to files which are only loaded by @@LazyLoader.source are applied by
+	/// recreating those loaders' items in place, instead of reloading the whole configuration.
+	/// Reloadable state such as windows is carried over from the old items.
+	///
+	/// Changes to the root file, singletons, types used by other files, or the set of files
+	/// in the configuration still cause a full reload, as do changes that fail to compile.
+	/// Defaults to false.
+	Q_PROPERTY(bool incrementalReload READ incrementalReload WRITE setIncrementalReload NOTIFY incrementalReloadChanged);
 	/// The system clipboard.
 	///
 	/// > [!WARNING] Under wayland the clipboard will be empty unless a quickshell window is focused.
@@ -172,6 +193,7 @@ public:
 	/// - `environment`: Changes to make to the process environment. See @@Quickshell.Io.Process.environment.
 	/// - `clearEnvironment`: Removes all variables from the environment if true.
 	/// - `workingDirectory`: The working directory the command should run in.
+	/// - `fastSpawn`: Starts the process with `posix_spawn`. See @@Quickshell.Io.Process.fastSpawn.
 	///
 	/// > [!WARNING] This does not run command in a shell. All arguments to the command
 	/// > must be in separate values in the list, e.g. `["echo", "hello"]`
@@ -231,6 +253,9 @@ public:
 	[[nodiscard]] bool watchFiles() const;
 	void setWatchFiles(bool watchFiles);
 
+	[[nodiscard]] bool incrementalReload() const;
+	void setIncrementalReload(bool incrementalReload);
+
 	[[nodiscard]] static QString clipboardText();
 	static void setClipboardText(const QString& text);
 
@@ -253,6 +278,7 @@ signals:
 	void screensChanged();
 	void workingDirectoryChanged();
 	void watchFilesChanged();
+	void incrementalReloadChanged();
 	void clipboardTextChanged();
 
 private slots:
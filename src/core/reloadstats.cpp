@@ -0,0 +1,116 @@
+#include "reloadstats.hpp"
+
+#include <private/qv4engine_p.h>
+#include <private/qv4mm_p.h>
+#include <qdatetime.h>
+#include <qjsonarray.h>
+#include <qjsonobject.h>
+#include <qlogging.h>
+#include <qloggingcategory.h>
+#include <qobject.h>
+#include <qqmlengine.h>
+#include <qtypes.h>
+
+#include "logcat.hpp"
+
+namespace {
+QS_LOGGING_CATEGORY(logReloadStats, "quickshell.reload.stats", QtWarningMsg);
+
+double toMs(qint64 ns) { return static_cast<double>(ns) / 1000000.0; }
+} // namespace
+
+const char* ReloadStats::kindName(Kind kind) {
+	switch (kind) {
+	case Launch: return "launch";
+	case Reload: return "reload";
+	case HardReload: return "hard";
+	case Incremental: return "incremental";
+	}
+
+	return "unknown";
+}
+
+QJsonObject ReloadStats::toJson() const {
+	QJsonObject phases;
+	auto addPhase = [&](const char* name, qint64 ns) {
+		if (ns != -1) phases.insert(name, toMs(ns));
+	};
+
+	addPhase("scan", this->scan);
+	addPhase("compile", this->compile);
+	addPhase("create", this->create);
+	addPhase("reload", this->reload);
+	addPhase("postReload", this->postReload);
+	addPhase("destroy", this->destroy);
+	addPhase("gc", this->gc);
+
+	return QJsonObject {
+	    {"time", this->time.toString(Qt::ISODateWithMs)},
+	    {"kind", ReloadStats::kindName(this->kind)},
+	    {"success", this->success},
+	    {"complete", this->complete},
+	    {"total", this->total == -1 ? QJsonValue() : QJsonValue(toMs(this->total))},
+	    {"phases", phases},
+	    {"scannedFiles", this->scannedFiles},
+	    {"objects", this->objects},
+	    {"jsHeap",
+	     QJsonObject {
+	         {"used", this->jsHeapUsed},
+	         {"allocated", this->jsHeapAllocated},
+	         {"largeItems", this->jsLargeItems},
+	     }},
+	};
+}
+
+ReloadStatsLog* ReloadStatsLog::instance() {
+	static auto* instance = new ReloadStatsLog(); // NOLINT
+	return instance;
+}
+
+ReloadStats& ReloadStatsLog::begin(ReloadStats::Kind kind) {
+	auto& stats = this->history.emplace();
+	stats.time = QDateTime::currentDateTime();
+	stats.kind = kind;
+	stats.timer.start();
+	this->recording = true;
+	return stats;
+}
+
+ReloadStats* ReloadStatsLog::active() {
+	return this->recording ? &this->history.at(0) : nullptr;
+}
+
+void ReloadStatsLog::finish(QObject* root, QQmlEngine* engine) {
+	auto* stats = this->active();
+	if (stats == nullptr) return;
+	this->recording = false;
+
+	stats->complete = true;
+	stats->total = stats->timer.nsecsElapsed();
+
+	if (root != nullptr) {
+		stats->objects = root->findChildren<QObject*>().size() + 1;
+	}
+
+	if (engine != nullptr) {
+		const auto* mm = engine->handle()->memoryManager;
+		stats->jsHeapUsed = static_cast<qint64>(mm->getUsedMem());
+		stats->jsHeapAllocated = static_cast<qint64>(mm->getAllocatedMem());
+		stats->jsLargeItems = static_cast<qint64>(mm->getLargeItemsMem());
+	}
+
+	qCInfo(logReloadStats).nospace() << ReloadStats::kindName(stats->kind) << " finished in "
+	                                 << toMs(stats->total) << "ms with " << stats->objects
+	                                 << " objects and " << stats->jsHeapUsed
+	                                 << " bytes of js heap in use";
+}
+
+QJsonArray ReloadStatsLog::toJson() const {
+	QJsonArray array;
+
+	for (auto i = this->history.size() - 1; i >= 0; i--) {
+		array.append(this->history.at(i).toJson());
+	}
+
+	return array;
+}
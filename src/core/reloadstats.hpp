@@ -0,0 +1,79 @@
+#pragma once
+
+#include <qdatetime.h>
+#include <qelapsedtimer.h>
+#include <qjsonarray.h>
+#include <qjsonobject.h>
+#include <qtypes.h>
+
+#include "ringbuf.hpp"
+
+class QObject;
+class QQmlEngine;
+
+// Timings and memory statistics of a single reload.
+// Phase durations are in nanoseconds, or -1 if the phase did not run.
+struct ReloadStats {
+	enum Kind : quint8 {
+		Launch,
+		Reload,
+		HardReload,
+		Incremental,
+	};
+
+	QDateTime time;
+	Kind kind = Reload;
+	bool success = true;
+	// false if another reload started before this one finished
+	bool complete = false;
+
+	qint64 scan = -1;
+	qint64 compile = -1;
+	qint64 create = -1;
+	qint64 reload = -1;
+	qint64 postReload = -1;
+	// time between destroying the previous generation and its deletion
+	qint64 destroy = -1;
+	// garbage collection of the previous generation's engine, part of destroy
+	qint64 gc = -1;
+	qint64 total = -1;
+
+	qint64 scannedFiles = 0;
+	qint64 objects = 0;
+	qint64 jsHeapUsed = 0;
+	qint64 jsHeapAllocated = 0;
+	qint64 jsLargeItems = 0;
+
+	QElapsedTimer timer;
+
+	[[nodiscard]] QJsonObject toJson() const;
+	static const char* kindName(Kind kind);
+};
+
+// History of the last HISTORY_SIZE reloads, kept across generations.
+class ReloadStatsLog {
+public:
+	static ReloadStatsLog* instance();
+
+	// Starts recording a reload, replacing the oldest record if the history is full.
+	// The returned record is valid until the next call.
+	ReloadStats& begin(ReloadStats::Kind kind);
+
+	// Returns the reload being recorded, or nullptr if there is none.
+	[[nodiscard]] ReloadStats* active();
+
+	// Records object and js heap statistics of the new generation and stops recording.
+	// root and engine may be null if the reload failed.
+	void finish(QObject* root, QQmlEngine* engine);
+
+	// Records, oldest first.
+	[[nodiscard]] QJsonArray toJson() const;
+
+	static constexpr qsizetype HISTORY_SIZE = 32;
+
+private:
+	ReloadStatsLog(): history(HISTORY_SIZE) {}
+
+	RingBuffer<ReloadStats> history;
+	bool recording = false;
+};
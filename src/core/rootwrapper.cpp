@@ -3,6 +3,7 @@
 #include <utility>
 
 #include <qdir.h>
+#include <qelapsedtimer.h>
 #include <qfileinfo.h>
 #include <qfilesystemwatcher.h>
 #include <qlogging.h>
@@ -18,6 +19,7 @@
 #include "generation.hpp"
 #include "instanceinfo.hpp"
 #include "qmlglobal.hpp"
+#include "reloadstats.hpp"
 #include "scan.hpp"
 #include "toolsupport.hpp"
 
@@ -55,11 +57,22 @@ RootWrapper::~RootWrapper() {
 }
 
 void RootWrapper::reloadGraph(bool hard) {
+	auto kind = this->generation == nullptr ? ReloadStats::Launch
+	           : hard                       ? ReloadStats::HardReload
+	                                        : ReloadStats::Reload;
+
+	auto& stats = ReloadStatsLog::instance()->begin(kind);
+	QElapsedTimer timer;
+	timer.start();
+
 	auto rootFile = QFileInfo(this->rootPath);
 	auto rootPath = rootFile.dir();
 	auto scanner = QmlScanner(rootPath);
 	scanner.scanQmlRoot(this->rootPath);
 
+	stats.scan = timer.nsecsElapsed();
+	stats.scannedFiles = scanner.scannedFiles.length();
+
 	qs::core::QmlToolingSupport::updateTooling(rootPath, scanner);
 	this->configDirWatcher.addPath(rootPath.path());
 
@@ -77,9 +90,14 @@ void RootWrapper::reloadGraph(bool hard) {
 	QUrl url;
 	url.setScheme("qs");
 	url.setPath("@/qs/" % rootFile.fileName());
+	timer.restart();
 	auto component = QQmlComponent(generation->engine, url);
+	stats.compile = timer.nsecsElapsed();
 
 	if (!component.isReady()) {
+		stats.success = false;
+		ReloadStatsLog::instance()->finish(nullptr, nullptr);
+
 		qCritical() << "Failed to load configuration";
 		QString errorString = "Failed to load configuration";
 
@@ -120,6 +138,7 @@ void RootWrapper::reloadGraph(bool hard) {
 		return;
 	}
 
+	timer.restart();
 	auto* newRoot = component.beginCreate(generation->engine->rootContext());
 
 	if (auto* item = qobject_cast<QQuickItem*>(newRoot)) {
@@ -134,6 +153,7 @@ void RootWrapper::reloadGraph(bool hard) {
 	generation->root = newRoot;
 
 	component.completeCreate();
+	stats.create = timer.nsecsElapsed();
 
 	if (this->generation) {
 		QObject::disconnect(this->generation, nullptr, this, nullptr);
@@ -182,7 +202,22 @@ void RootWrapper::onWatchFilesChanged() {
 	}
 }
 
-void RootWrapper::onWatchedFilesChanged() { this->reloadGraph(false); }
+void RootWrapper::onWatchedFilesChanged() {
+	if (this->generation != nullptr && QuickshellSettings::instance()->incrementalReload()) {
+		if (this->generation->reloadIncremental()) {
+			qInfo() << "Configuration reloaded incrementally";
+			this->updateTooling();
+
+			if (this->generation->qsgInstance != nullptr) {
+				emit this->generation->qsgInstance->reloadCompleted();
+			}
+
+			return;
+		}
+	}
+
+	this->reloadGraph(false);
+}
 
 void RootWrapper::updateTooling() {
 	if (!this->generation) return;
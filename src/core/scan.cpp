@@ -1,8 +1,12 @@
 #include "scan.hpp"
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
 #include <qcontainerfwd.h>
 #include <qdir.h>
+#include <qelapsedtimer.h>
+#include <qfile.h>
 #include <qfileinfo.h>
 #include <qjsonarray.h>
 #include <qjsondocument.h>
@@ -11,32 +15,120 @@
 #include <qlogging.h>
 #include <qloggingcategory.h>
 #include <qpair.h>
+#include <qsemaphore.h>
+#include <qset.h>
 #include <qstring.h>
 #include <qstringliteral.h>
+#include <qstringview.h>
 #include <qtextstream.h>
+#include <qthreadpool.h>
+#include <qtypes.h>
+#include <sys/stat.h>
 
 #include "logcat.hpp"
+#include "scancache.hpp"
 
 QS_LOGGING_CATEGORY(logQmlScanner, "quickshell.qmlscanner", QtWarningMsg);
 
-void QmlScanner::scanDir(const QDir& dir) {
-	if (this->scannedDirs.contains(dir)) return;
-	this->scannedDirs.push_back(dir);
+namespace {
+
+bool statPath(const QString& path, qint64* mtime, qint64* size) {
+	struct stat info {};
+	if (stat(path.toLocal8Bit().constData(), &info) != 0) return false;
+
+	*mtime = info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+	*size = info.st_size;
+	return true;
+}
+
+// Collects capitalized identifiers across the lines of a qml file, skipping strings and comments.
+class TypeRefCollector {
+public:
+	void scanLine(QStringView line) {
+		qsizetype i = 0;
+		auto peek = [&](QChar c) { return i + 1 < line.length() && line.at(i + 1) == c; };
+
+		while (i < line.length()) {
+			auto c = line.at(i);
+
+			if (this->blockComment) {
+				if (c == '*' && peek('/')) {
+					this->blockComment = false;
+					i++;
+				}
+
+				i++;
+			} else if (!this->quote.isNull()) {
+				if (c == '\\') i++;
+				else if (c == this->quote) this->quote = QChar();
+				i++;
+			} else if (c == '/' && peek('/')) {
+				break;
+			} else if (c == '/' && peek('*')) {
+				this->blockComment = true;
+				i += 2;
+			} else if (c == '"' || c == '\'' || c == '`') {
+				this->quote = c;
+				i++;
+			} else if (c.isLetter() || c == '_') {
+				auto start = i;
+				while (i < line.length() && (line.at(i).isLetterOrNumber() || line.at(i) == '_')) i++;
+				if (c.isUpper()) this->refs.insert(line.sliced(start, i - start).toString());
+			} else {
+				i++;
+			}
+		}
+
+		// only template strings can span lines
+		if (this->quote != '`') this->quote = QChar();
+	}
 
+	[[nodiscard]] QVector<QString> takeRefs() {
+		auto refs = QVector<QString>(this->refs.begin(), this->refs.end());
+		std::ranges::sort(refs);
+		return refs;
+	}
+
+private:
+	QSet<QString> refs;
+	QChar quote;
+	bool blockComment = false;
+};
+
+QThreadPool* scanPool() {
+	static auto* pool = new QThreadPool(); // NOLINT
+	return pool;
+}
+
+} // namespace
+
+void QmlScanner::scanDir(const QDir& dir) {
 	const auto& path = dir.path();
 
+	if (this->scannedDirPaths.contains(path)) return;
+	this->scannedDirPaths.insert(path);
+	this->scannedDirs.push_back(dir);
+
 	qCDebug(logQmlScanner) << "Scanning directory" << path;
 
-	struct Entry {
-		QString name;
-		bool singleton = false;
-		bool internal = false;
-	};
+	auto* cache = QmlScanCache::instance();
+	qint64 mtime = 0;
+	qint64 size = 0;
 
+	QStringList names;
+	if (!statPath(path, &mtime, &size)) {
+		names = dir.entryList(QDir::Files | QDir::NoDotAndDotDot);
+	} else if (const auto* cached = cache->lookupDir(path, mtime)) {
+		names = *cached;
+	} else {
+		names = dir.entryList(QDir::Files | QDir::NoDotAndDotDot);
+		cache->insertDir(path, mtime, names);
+	}
+
+	auto scanned = ScannedDir {.path = path};
 	bool seenQmldir = false;
-	auto entries = QVector<Entry>();
 
-	for (auto& name: dir.entryList(QDir::Files | QDir::NoDotAndDotDot)) {
+	for (auto& name: names) {
 		if (name == "qmldir") {
 			qCDebug(
 			    logQmlScanner
@@ -44,67 +136,141 @@ void QmlScanner::scanDir(const QDir& dir) {
 			  << path;
 			seenQmldir = true;
 		} else if (name.at(0).isUpper() && name.endsWith(".qml")) {
-			auto& entry = entries.emplaceBack();
+			auto filePath = dir.filePath(name);
 
-			if (this->scanQmlFile(dir.filePath(name), entry.singleton, entry.internal)) {
-				entry.name = name;
-			} else {
-				entries.pop_back();
+			// the root can never be a singleton so it dosent matter if we skip it
+			if (!this->scannedFilePaths.contains(filePath)) {
+				this->queueFile(filePath);
+				scanned.entries.push_back(name);
 			}
 		} else if (name.at(0).isUpper() && name.endsWith(".qml.json")) {
 			if (this->scanQmlJson(dir.filePath(name))) {
-				entries.push_back({
-				    .name = name.first(name.length() - 5),
-				    .singleton = true,
-				});
+				scanned.entries.push_back(name);
 			}
 		}
 	}
 
-	if (!seenQmldir) {
-		qCDebug(logQmlScanner) << "Synthesizing qmldir for directory" << path;
-
-		QString qmldir;
-		auto stream = QTextStream(&qmldir);
-
-		// cant derive a module name if not in shell path
-		if (path.startsWith(this->rootPath.path())) {
-			auto end = path.sliced(this->rootPath.path().length());
-
-			// verify we have a valid module name.
-			for (auto& c: end) {
-				if (c == '/') c = '.';
-				else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
-				         || c == '_')
-				{
-				} else {
-					qCWarning(logQmlScanner) << "Module path contains invalid characters for a module name: "
-					                         << path.sliced(this->rootPath.path().length());
-					goto skipadd;
-				}
+	scanned.synthesizeQmldir = !seenQmldir;
+	this->dirs.push_back(scanned);
+}
+
+void QmlScanner::queueFile(const QString& path) {
+	this->scannedFiles.push_back(path);
+	this->scannedFilePaths.insert(path);
+	this->pendingFiles.push_back(path);
+}
+
+void QmlScanner::synthesizeQmldir(const ScannedDir& dir) {
+	const auto& path = dir.path;
+
+	qCDebug(logQmlScanner) << "Synthesizing qmldir for directory" << path;
+
+	QString qmldir;
+	auto stream = QTextStream(&qmldir);
+
+	// cant derive a module name if not in shell path
+	if (path.startsWith(this->rootPath.path())) {
+		auto end = path.sliced(this->rootPath.path().length());
+
+		// verify we have a valid module name.
+		for (auto& c: end) {
+			if (c == '/') c = '.';
+			else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+			         || c == '_')
+			{
+			} else {
+				qCWarning(logQmlScanner) << "Module path contains invalid characters for a module name: "
+				                         << path.sliced(this->rootPath.path().length());
+				goto skipadd;
 			}
+		}
+
+		stream << "module qs" << end << '\n';
+	skipadd:;
+	} else {
+		qCWarning(logQmlScanner) << "Module path" << path << "is outside of the config folder.";
+	}
+
+	for (const auto& entry: dir.entries) {
+		auto name = entry;
+		auto singleton = true;
+		auto internal = false;
 
-			stream << "module qs" << end << '\n';
-		skipadd:;
+		if (entry.endsWith(".qml.json")) {
+			name = entry.first(entry.length() - 5);
 		} else {
-			qCWarning(logQmlScanner) << "Module path" << path << "is outside of the config folder.";
-		}
+			auto record = this->fileRecords.constFind(QDir(path).filePath(entry));
+			if (record == this->fileRecords.constEnd()) continue;
 
-		for (const auto& entry: entries) {
-			if (entry.internal) stream << "internal ";
-			if (entry.singleton) stream << "singleton ";
-			stream << entry.name.sliced(0, entry.name.length() - 4) << " 1.0 " << entry.name << '\n';
+			singleton = record->singleton;
+			internal = record->internal;
 		}
 
-		qCDebug(logQmlScanner) << "Synthesized qmldir for" << path << qPrintable("\n" + qmldir);
-		this->fileIntercepts.insert(QDir(path).filePath("qmldir"), qmldir);
+		if (internal) stream << "internal ";
+		if (singleton) stream << "singleton ";
+		stream << name.sliced(0, name.length() - 4) << " 1.0 " << name << '\n';
 	}
+
+	qCDebug(logQmlScanner) << "Synthesized qmldir for" << path << qPrintable("\n" + qmldir);
+	this->fileIntercepts.insert(QDir(path).filePath("qmldir"), qmldir);
 }
 
-bool QmlScanner::scanQmlFile(const QString& path, bool& singleton, bool& internal) {
-	if (this->scannedFiles.contains(path)) return false;
-	this->scannedFiles.push_back(path);
+QVector<QmlScanner::FileScan> QmlScanner::readFiles(const QVector<QString>& paths) {
+	auto* cache = QmlScanCache::instance();
+	auto results = QVector<FileScan>(paths.length());
+	QVector<qsizetype> changed;
+
+	for (qsizetype i = 0; i != paths.length(); i++) {
+		auto& result = results[i];
 
+		const auto& path = paths.at(i);
+		auto& record = result.record;
+
+		if (!statPath(path, &record.mtime, &record.size)) {
+			qCWarning(logQmlScanner) << "Failed to open file" << path;
+			continue;
+		}
+
+		if (const auto* cached = cache->lookupFile(path, record.mtime, record.size)) {
+			record = *cached;
+			result.valid = true;
+		} else {
+			changed.push_back(i);
+		}
+	}
+
+	// Each scan only touches its own result slot. Taken once so tasks never detach the list.
+	auto* resultData = results.data();
+	auto rootPath = this->rootPath.path();
+	auto scanFile = [&](qsizetype i) {
+		auto& result = resultData[i]; // NOLINT
+		result.valid = QmlScanner::scanQmlFile(rootPath, paths.at(i), &result.record);
+	};
+
+	if (changed.length() < QmlScanner::PARALLEL_THRESHOLD) {
+		for (auto i: changed) scanFile(i);
+	} else {
+		qCDebug(logQmlScanner) << "Reading" << changed.length() << "files in parallel";
+
+		QSemaphore finished;
+		for (auto i: changed) {
+			scanPool()->start([&, i]() {
+				scanFile(i);
+				finished.release();
+			});
+		}
+
+		finished.acquire(static_cast<int>(changed.length()));
+	}
+
+	for (auto i: changed) {
+		if (results.at(i).valid) cache->insertFile(paths.at(i), results.at(i).record);
+	}
+
+	return results;
+}
+
+bool QmlScanner::scanQmlFile(const QString& rootPath, const QString& path, QmlFileRecord* record) {
 	qCDebug(logQmlScanner) << "Scanning qml file" << path;
 
 	auto file = QFile(path);
@@ -114,11 +280,17 @@ bool QmlScanner::scanQmlFile(const QString& path, bool& singleton, bool& interna
 	}
 
 	auto stream = QTextStream(&file);
-	auto imports = QVector<QString>();
+	auto& singleton = record->singleton;
+	auto& internal = record->internal;
+	auto& imports = record->imports;
+	TypeRefCollector typeRefs;
+	auto inBody = false;
 
 	while (!stream.atEnd()) {
 		auto line = stream.readLine().trimmed();
-		if (!singleton && line == "pragma Singleton") {
+		if (inBody) {
+			typeRefs.scanLine(line);
+		} else if (!singleton && line == "pragma Singleton") {
 			singleton = true;
 		} else if (!internal && line == "//@ pragma Internal") {
 			internal = true;
@@ -144,7 +316,7 @@ bool QmlScanner::scanQmlFile(const QString& path, bool& singleton, bool& interna
 					importCursor += 1;
 				}
 
-				imports.append(this->rootPath.filePath(path));
+				imports.append(QDir(rootPath).filePath(path));
 			} else if (auto startQuot = line.indexOf('"');
 			           startQuot != -1 && line.length() >= startQuot + 3)
 			{
@@ -154,23 +326,33 @@ bool QmlScanner::scanQmlFile(const QString& path, bool& singleton, bool& interna
 				auto name = line.sliced(startQuot + 1, endQuot - startQuot - 1);
 				imports.push_back(name);
 			}
-		} else if (line.contains('{')) break;
+		} else if (line.contains('{')) {
+			// Types referenced in the body are tracked so reloads can tell which files depend on
+			// a changed file.
+			inBody = true;
+			typeRefs.scanLine(line);
+		}
 
 	next:;
 	}
 
 	file.close();
+	record->typeRefs = typeRefs.takeRefs();
 
 	if (logQmlScanner().isDebugEnabled() && !imports.isEmpty()) {
 		qCDebug(logQmlScanner) << "Found imports" << imports;
 	}
 
-	auto currentdir = QDir(QFileInfo(path).absolutePath());
+	return true;
+}
 
-	// the root can never be a singleton so it dosent matter if we skip it
+void QmlScanner::processFile(const QString& path, const QmlFileRecord& record) {
+	auto currentdir = QDir(QFileInfo(path).absolutePath());
 	this->scanDir(currentdir);
 
-	for (auto& import: imports) {
+	auto& importDirs = this->importDirs[path];
+
+	for (const auto& import: record.imports) {
 		QString ipath;
 		if (import.startsWith("root:")) {
 			auto path = import.sliced(5);
@@ -193,17 +375,83 @@ bool QmlScanner::scanQmlFile(const QString& path, bool& singleton, bool& interna
 			continue;
 		}
 
-		if (import.endsWith(".js")) this->scannedFiles.push_back(cpath);
-		else this->scanDir(cpath);
+		if (import.endsWith(".js")) {
+			this->scannedFiles.push_back(cpath);
+			this->scannedFilePaths.insert(cpath);
+		} else {
+			this->scanDir(cpath);
+			importDirs.push_back(cpath);
+		}
 	}
+}
 
-	return true;
+bool QmlScanner::isSingleton(const QString& path) const {
+	auto record = this->fileRecords.constFind(path);
+	return record != this->fileRecords.constEnd() && record->singleton;
+}
+
+QSet<QString> QmlScanner::dependentFiles(const QSet<QString>& files) const {
+	auto result = files;
+	auto pending = QVector<QString>(files.begin(), files.end());
+	auto rootDir = this->rootPath.path();
+
+	while (!pending.isEmpty()) {
+		auto info = QFileInfo(pending.takeLast());
+		if (info.suffix() != "qml") continue;
+
+		auto typeName = info.completeBaseName();
+		auto dir = info.absolutePath();
+
+		for (auto [path, record]: this->fileRecords.asKeyValueRange()) {
+			if (result.contains(path) || !record.typeRefs.contains(typeName)) continue;
+
+			// The root module is always loaded, other directories are only visible to files
+			// in them or importing them.
+			if (dir != rootDir && QFileInfo(path).absolutePath() != dir
+			    && !this->importDirs.value(path).contains(dir))
+			{
+				continue;
+			}
+
+			result.insert(path);
+			pending.push_back(path);
+		}
+	}
+
+	return result;
 }
 
 void QmlScanner::scanQmlRoot(const QString& path) {
-	bool singleton = false;
-	bool internal = false;
-	this->scanQmlFile(path, singleton, internal);
+	QElapsedTimer timer;
+	timer.start();
+
+	this->rootFile = path;
+	this->queueFile(path);
+
+	// Files are read in passes, as the files to read next depend on the imports of the last pass.
+	while (!this->pendingFiles.isEmpty()) {
+		auto paths = std::exchange(this->pendingFiles, QVector<QString>());
+		auto results = this->readFiles(paths);
+
+		for (qsizetype i = 0; i != paths.length(); i++) {
+			if (!results.at(i).valid) continue;
+
+			this->fileRecords.insert(paths.at(i), results.at(i).record);
+			this->processFile(paths.at(i), results.at(i).record);
+		}
+	}
+
+	for (const auto& dir: this->dirs) {
+		if (dir.synthesizeQmldir) this->synthesizeQmldir(dir);
+	}
+
+	auto* cache = QmlScanCache::instance();
+	qCDebug(logQmlScanner).nospace() << "Scanned " << this->scannedFiles.length() << " files in "
+	                                 << timer.elapsed() << "ms, with " << cache->hits() << '/'
+	                                 << cache->hits() + cache->misses()
+	                                 << " files and directories loaded from cache.";
+
+	cache->finishScan();
 }
 
 bool QmlScanner::scanQmlJson(const QString& path) {
@@ -234,6 +482,7 @@ bool QmlScanner::scanQmlJson(const QString& path) {
 
 	this->fileIntercepts.insert(path.first(path.length() - 5), body);
 	this->scannedFiles.push_back(path);
+	this->scannedFilePaths.insert(path);
 	return true;
 }
 
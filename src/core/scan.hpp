@@ -4,9 +4,11 @@
 #include <qdir.h>
 #include <qhash.h>
 #include <qloggingcategory.h>
+#include <qset.h>
 #include <qvector.h>
 
 #include "logcat.hpp"
+#include "scancache.hpp"
 
 QS_DECLARE_LOGGING_CATEGORY(logQmlScanner);
 
@@ -16,17 +18,55 @@ public:
 	QmlScanner() = default;
 	QmlScanner(const QDir& rootPath): rootPath(rootPath) {}
 
-	void scanDir(const QDir& dir);
 	void scanQmlRoot(const QString& path);
 
+	[[nodiscard]] const QString& root() const { return this->rootFile; }
+	[[nodiscard]] bool isSingleton(const QString& path) const;
+
+	// Returns the given files and every scanned file that may instantiate a type defined
+	// by one of them, directly or through other files. Overestimates, as type references
+	// are matched by name.
+	[[nodiscard]] QSet<QString> dependentFiles(const QSet<QString>& files) const;
+
 	QVector<QDir> scannedDirs;
 	QVector<QString> scannedFiles;
 	QHash<QString, QString> fileIntercepts;
 
+	// Minimum number of changed files in one pass of the scan before they are read in parallel.
+	static constexpr qsizetype PARALLEL_THRESHOLD = 8;
+
 private:
+	struct ScannedDir {
+		QString path;
+		bool synthesizeQmldir = false;
+		// qml and qml.json file names, in listing order
+		QVector<QString> entries;
+	};
+
+	struct FileScan {
+		QmlFileRecord record;
+		bool valid = false;
+	};
+
 	QDir rootPath;
+	QString rootFile;
+	QSet<QString> scannedDirPaths;
+	QSet<QString> scannedFilePaths;
+	QVector<QString> pendingFiles;
+	QVector<ScannedDir> dirs;
+	QHash<QString, QmlFileRecord> fileRecords;
+	// resolved directory imports of each file
+	QHash<QString, QVector<QString>> importDirs;
 
-	bool scanQmlFile(const QString& path, bool& singleton, bool& internal);
+	void scanDir(const QDir& dir);
+	void queueFile(const QString& path);
+	// Reads files changed since the last scan, in parallel if there are enough of them.
+	QVector<FileScan> readFiles(const QVector<QString>& paths);
+	void processFile(const QString& path, const QmlFileRecord& record);
+	void synthesizeQmldir(const ScannedDir& dir);
 	bool scanQmlJson(const QString& path);
+
+	// Safe to call from any thread.
+	static bool scanQmlFile(const QString& rootPath, const QString& path, QmlFileRecord* record);
 	[[nodiscard]] static QPair<QString, QString> jsonToQml(const QJsonValue& value, int indent = 0);
 };
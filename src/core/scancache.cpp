@@ -0,0 +1,183 @@
+#include "scancache.hpp"
+#include <utility>
+
+#include <qdatastream.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qlogging.h>
+#include <qloggingcategory.h>
+#include <qsavefile.h>
+#include <qstring.h>
+#include <qtypes.h>
+
+#include "build.hpp"
+#include "paths.hpp"
+#include "scan.hpp"
+
+namespace {
+constexpr quint32 CACHE_MAGIC = 0x51535153; // QSQS
+constexpr quint8 CACHE_VERSION = 1;
+
+template <typename T>
+bool pruneUnused(QHash<QString, T>& hash) {
+	auto pruned = false;
+
+	for (auto it = hash.begin(); it != hash.end();) {
+		if (it->used) {
+			it->used = false;
+			++it;
+		} else {
+			it = hash.erase(it);
+			pruned = true;
+		}
+	}
+
+	return pruned;
+}
+
+} // namespace
+
+QmlScanCache* QmlScanCache::instance() {
+	static auto* instance = new QmlScanCache(); // NOLINT
+	return instance;
+}
+
+QmlScanCache::QmlScanCache(): path(QsPaths::instance()->shellCacheDir().filePath("qmlscan.cache")) {
+	this->load();
+}
+
+const QmlFileRecord* QmlScanCache::lookupFile(const QString& path, qint64 mtime, qint64 size) {
+	auto it = this->files.find(path);
+
+	if (it == this->files.end() || it->record.mtime != mtime || it->record.size != size) {
+		this->mMisses++;
+		return nullptr;
+	}
+
+	it->used = true;
+	this->mHits++;
+	return &it->record;
+}
+
+void QmlScanCache::insertFile(const QString& path, QmlFileRecord record) {
+	this->files.insert(path, FileEntry {.record = std::move(record), .used = true});
+	this->dirty = true;
+}
+
+const QStringList* QmlScanCache::lookupDir(const QString& path, qint64 mtime) {
+	auto it = this->dirs.find(path);
+
+	if (it == this->dirs.end() || it->mtime != mtime) {
+		this->mMisses++;
+		return nullptr;
+	}
+
+	it->used = true;
+	this->mHits++;
+	return &it->files;
+}
+
+void QmlScanCache::insertDir(const QString& path, qint64 mtime, QStringList files) {
+	this->dirs.insert(path, DirEntry {.mtime = mtime, .files = std::move(files), .used = true});
+	this->dirty = true;
+}
+
+void QmlScanCache::finishScan() {
+	// not short circuited, as all used flags must be reset
+	if (pruneUnused(this->files)) this->dirty = true;
+	if (pruneUnused(this->dirs)) this->dirty = true;
+
+	this->mHits = 0;
+	this->mMisses = 0;
+
+	if (this->dirty) {
+		this->save();
+		this->dirty = false;
+	}
+}
+
+void QmlScanCache::load() {
+	auto file = QFile(this->path);
+	if (!file.open(QFile::ReadOnly)) return;
+
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_6_6);
+
+	quint32 magic = 0;
+	quint8 version = 0;
+	QString qtVersion;
+	QString revision;
+	stream >> magic >> version >> qtVersion >> revision;
+
+	if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+		qCInfo(logQmlScanner) << "Discarding incompatible qml scan cache at" << this->path;
+		return;
+	}
+
+	// The records depend on the scanner version.
+	if (qtVersion != QLatin1StringView(qVersion()) || revision != QLatin1StringView(GIT_REVISION)) {
+		qCDebug(logQmlScanner) << "Discarding qml scan cache from a different build at" << this->path;
+		return;
+	}
+
+	qint64 count = 0;
+
+	stream >> count;
+	for (qint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+		QString path;
+		FileEntry entry;
+		auto& record = entry.record;
+		stream >> path >> record.mtime >> record.size >> record.singleton >> record.internal
+		    >> record.imports >> record.typeRefs;
+		this->files.insert(path, entry);
+	}
+
+	stream >> count;
+	for (qint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+		QString path;
+		DirEntry entry;
+		stream >> path >> entry.mtime >> entry.files;
+		this->dirs.insert(path, entry);
+	}
+
+	if (stream.status() != QDataStream::Ok) {
+		qCWarning(logQmlScanner) << "Qml scan cache at" << this->path << "is corrupt.";
+		this->files.clear();
+		this->dirs.clear();
+		return;
+	}
+
+	qCDebug(logQmlScanner) << "Loaded" << this->files.size() << "file records and"
+	                       << this->dirs.size() << "directory records from" << this->path;
+}
+
+void QmlScanCache::save() {
+	auto file = QSaveFile(this->path);
+	if (!file.open(QFile::WriteOnly)) {
+		qCWarning(logQmlScanner) << "Could not open qml scan cache at" << this->path
+		                         << "for writing:" << file.errorString();
+		return;
+	}
+
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_6_6);
+	stream << CACHE_MAGIC << CACHE_VERSION << QString::fromLatin1(qVersion())
+	       << QStringLiteral(GIT_REVISION);
+
+	stream << static_cast<qint64>(this->files.size());
+	for (auto [path, entry]: this->files.asKeyValueRange()) {
+		const auto& record = entry.record;
+		stream << path << record.mtime << record.size << record.singleton << record.internal
+		       << record.imports << record.typeRefs;
+	}
+
+	stream << static_cast<qint64>(this->dirs.size());
+	for (auto [path, entry]: this->dirs.asKeyValueRange()) {
+		stream << path << entry.mtime << entry.files;
+	}
+
+	if (!file.commit()) {
+		qCWarning(logQmlScanner) << "Could not write qml scan cache at" << this->path << ":"
+		                         << file.errorString();
+	}
+}
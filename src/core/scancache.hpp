@@ -0,0 +1,71 @@
+#pragma once
+
+#include <qcontainerfwd.h>
+#include <qhash.h>
+#include <qlist.h>
+#include <qstring.h>
+#include <qtypes.h>
+
+// Scan results for a qml file, valid while its mtime and size are unchanged.
+struct QmlFileRecord {
+	qint64 mtime = 0;
+	qint64 size = 0;
+	bool singleton = false;
+	bool internal = false;
+	// Imports as written, with root module (qs.*) imports resolved to paths.
+	QVector<QString> imports;
+	// Capitalized identifiers used in the file, outside of strings and comments.
+	// A superset of the types the file may instantiate.
+	QVector<QString> typeRefs;
+};
+
+// Persistent scan manifest of QmlScanner, stored in the shell cache dir.
+//
+// File and directory records let reloads skip reading files and listing directories
+// that have not changed since the last scan. The manifest is discarded when written by
+// a different build of quickshell or Qt.
+class QmlScanCache {
+public:
+	static QmlScanCache* instance();
+
+	// Returns nullptr if there is no record for path with the given mtime and size.
+	// The returned record is invalidated by the next insert.
+	const QmlFileRecord* lookupFile(const QString& path, qint64 mtime, qint64 size);
+	void insertFile(const QString& path, QmlFileRecord record);
+
+	// Returns the files listed in a directory if its mtime is unchanged, otherwise nullptr.
+	const QStringList* lookupDir(const QString& path, qint64 mtime);
+	void insertDir(const QString& path, qint64 mtime, QStringList files);
+
+	// Drops entries unused since the last call and writes the cache if it changed.
+	void finishScan();
+
+	[[nodiscard]] qsizetype hits() const { return this->mHits; }
+	[[nodiscard]] qsizetype misses() const { return this->mMisses; }
+
+private:
+	QmlScanCache();
+
+	void load();
+	void save();
+
+	struct FileEntry {
+		QmlFileRecord record;
+		bool used = false;
+	};
+
+	struct DirEntry {
+		qint64 mtime = 0;
+		QStringList files;
+		bool used = false;
+	};
+
+	QString path;
+	QHash<QString, FileEntry> files;
+	QHash<QString, DirEntry> dirs;
+	bool dirty = false;
+	qsizetype mHits = 0;
+	qsizetype mMisses = 0;
+
+	friend class TestQmlScanner;
+};
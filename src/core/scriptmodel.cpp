@@ -1,158 +1,220 @@
 #include "scriptmodel.hpp"
 #include <algorithm>
-#include <iterator>
+#include <utility>
 
 #include <qabstractitemmodel.h>
 #include <qcontainerfwd.h>
+#include <qhashfunctions.h>
 #include <qlist.h>
+#include <qmetatype.h>
 #include <qnamespace.h>
+#include <qobject.h>
 #include <qtmetamacros.h>
-#include <qtversionchecks.h>
 #include <qtypes.h>
 #include <qvariant.h>
 
-void ScriptModel::updateValuesUnique(const QVariantList& newValues) {
-	this->hasActiveIterators = true;
-	this->mValues.reserve(newValues.size());
+#include "listdiff.hpp"
+
+namespace {
+
+// Must stay consistent with QVariant::operator==, which compares numbers by value,
+// and strings to numbers by converting the string.
+size_t hashVariant(const QVariant& value) {
+	switch (value.typeId()) {
+	case QMetaType::UnknownType:
+	case QMetaType::Nullptr: return 0;
+	case QMetaType::Bool:
+	case QMetaType::Char:
+	case QMetaType::SChar:
+	case QMetaType::UChar:
+	case QMetaType::Short:
+	case QMetaType::UShort:
+	case QMetaType::Int:
+	case QMetaType::UInt:
+	case QMetaType::Long:
+	case QMetaType::ULong:
+	case QMetaType::LongLong:
+	case QMetaType::ULongLong:
+	case QMetaType::Float:
+	case QMetaType::Double: return qHash(value.toDouble());
+	case QMetaType::QString: {
+		const auto& string = *static_cast<const QString*>(value.constData());
+		auto isNumber = false;
+		auto number = string.toDouble(&isNumber);
+		return isNumber ? qHash(number) : qHash(string);
+	}
+	case QMetaType::QChar: return qHash(value.toChar());
+	case QMetaType::QVariantMap: {
+		size_t hash = 0;
+		const auto& map = *static_cast<const QVariantMap*>(value.constData());
+		for (auto [key, v]: map.asKeyValueRange()) hash = qHashMulti(hash, key, hashVariant(v));
+		return hash;
+	}
+	case QMetaType::QVariantList: {
+		size_t hash = 0;
+		const auto& list = *static_cast<const QVariantList*>(value.constData());
+		for (const auto& v: list) hash = qHashMulti(hash, hashVariant(v));
+		return hash;
+	}
+	default:
+		if (value.metaType().flags() & QMetaType::PointerToQObject) {
+			return qHash(value.value<QObject*>());
+		}
+
+		// Equal values of other types always have the same type.
+		return qHash(value.typeId());
+	}
+}
 
-	auto iter = this->mValues.begin();
-	auto newIter = newValues.begin();
+bool lookupProperty(const QVariant& value, const QString& name, QVariant& result) {
+	if (value.metaType().flags() & QMetaType::PointerToQObject) {
+		auto* object = value.value<QObject*>();
+		if (!object) return false;
+
+		result = object->property(name.toUtf8());
+		return result.isValid();
+	} else if (value.typeId() == QMetaType::QVariantMap) {
+		const auto& map = *static_cast<const QVariantMap*>(value.constData());
+		auto iter = map.constFind(name);
+		if (iter == map.constEnd()) return false;
+
+		result = iter.value();
+		return true;
+	} else if (value.canConvert<QVariantMap>()) {
+		auto map = value.value<QVariantMap>();
+		auto iter = map.constFind(name);
+		if (iter == map.constEnd()) return false;
+
+		result = iter.value();
+		return true;
+	}
 
-	// TODO: cache this
-	auto getCmpKey = [this](const QVariant& v) {
-		if (v.canConvert<QVariantMap>()) {
-			auto vMap = v.value<QVariantMap>();
-			if (vMap.contains(this->cmpKey)) {
-				return vMap.value(this->cmpKey);
-			}
+	return false;
+}
+
+} // namespace
+
+class ScriptModelDiffHandler {
+public:
+	ScriptModelDiffHandler(ScriptModel* model, const QVariantList& newValues)
+	    : model(model)
+	    , newValues(newValues)
+	    , compareValues(!model->cmpKey.isEmpty()) {}
+
+	void remove(qsizetype index, qsizetype count) {
+		this->flushChanged();
+
+		auto first = static_cast<qint32>(index);
+		this->model->beginRemoveRows(QModelIndex(), first, first + static_cast<qint32>(count) - 1);
+		this->model->mValues.remove(index, count);
+		this->model->endRemoveRows();
+	}
+
+	void insert(qsizetype index, qsizetype newIndex, qsizetype count) {
+		this->flushChanged();
+
+		auto& values = this->model->mValues;
+		auto first = static_cast<qint32>(index);
+		auto newIter = this->newValues.begin() + newIndex;
+
+		this->model->beginInsertRows(QModelIndex(), first, first + static_cast<qint32>(count) - 1);
+		values.insert(index, count, QVariant());
+		std::copy(newIter, newIter + count, values.begin() + index);
+		this->model->endInsertRows();
+	}
+
+	void move(qsizetype from, qsizetype count, qsizetype to) {
+		this->flushChanged();
+
+		auto& values = this->model->mValues;
+		auto first = static_cast<qint32>(from);
+		auto last = first + static_cast<qint32>(count) - 1;
+		auto dest = static_cast<qint32>(to);
+
+		this->model->beginMoveRows(QModelIndex(), first, last, QModelIndex(), dest);
+		std::rotate(values.begin() + to, values.begin() + from, values.begin() + from + count);
+		this->model->endMoveRows();
+	}
+
+	// Values with equal keys may still differ if objectProp is set.
+	void keep(qsizetype index, qsizetype newIndex) {
+		if (!this->compareValues) return;
+
+		const auto& newValue = this->newValues.at(newIndex);
+		if (this->model->mValues.at(index) == newValue) return;
+
+		this->model->mValues.replace(index, newValue);
+
+		if (this->changedFirst != -1 && index == this->changedLast + 1) {
+			this->changedLast = index;
+		} else {
+			this->flushChanged();
+			this->changedFirst = index;
+			this->changedLast = index;
 		}
+	}
+
+	void flushChanged() {
+		if (this->changedFirst == -1) return;
+
+		emit this->model->dataChanged(
+		    this->model->index(static_cast<qint32>(this->changedFirst), 0, QModelIndex()),
+		    this->model->index(static_cast<qint32>(this->changedLast), 0, QModelIndex()),
+		    {Qt::UserRole}
+		);
+
+		this->changedFirst = -1;
+	}
 
-		return v;
-	};
-
-	auto variantCmp = [&, this](const QVariant& a, const QVariant& b) {
-		if (!this->cmpKey.isEmpty()) return getCmpKey(a) == getCmpKey(b);
-		else return a == b;
-	};
-
-	auto eqPredicate = [&](const QVariant& b) {
-		return [&](const QVariant& a) { return variantCmp(a, b); };
-	};
-
-	while (true) {
-		if (newIter == newValues.end()) {
-			if (iter == this->mValues.end()) break;
-
-			auto startIndex = static_cast<qint32>(newValues.length());
-			auto endIndex = static_cast<qint32>(this->mValues.length() - 1);
-
-			this->beginRemoveRows(QModelIndex(), startIndex, endIndex);
-			this->mValues.erase(iter, this->mValues.end());
-			this->endRemoveRows();
-
-			break;
-		} else if (iter == this->mValues.end()) {
-			// Prior branch ensures length is at least 1.
-			auto startIndex = static_cast<qint32>(this->mValues.length());
-			auto endIndex = static_cast<qint32>(newValues.length() - 1);
-
-			this->beginInsertRows(QModelIndex(), startIndex, endIndex);
-			this->mValues.append(newValues.sliced(startIndex));
-			this->endInsertRows();
-
-			break;
-		} else if (!variantCmp(*newIter, *iter)) {
-			auto oldIter = std::find_if(iter, this->mValues.end(), eqPredicate(*newIter));
-
-			if (oldIter != this->mValues.end()) {
-				if (std::find_if(newIter, newValues.end(), eqPredicate(*iter)) == newValues.end()) {
-					// Remove any entries we would otherwise move around that aren't in the new list.
-					auto startIter = iter;
-
-					do {
-						++iter;
-					} while (iter != this->mValues.end()
-					         && std::find_if(newIter, newValues.end(), eqPredicate(*iter))
-					                == newValues.end());
-
-					auto index = static_cast<qint32>(std::distance(this->mValues.begin(), iter));
-					auto startIndex = static_cast<qint32>(std::distance(this->mValues.begin(), startIter));
-
-					this->beginRemoveRows(QModelIndex(), startIndex, index - 1);
-					iter = this->mValues.erase(startIter, iter);
-					this->endRemoveRows();
-				} else {
-					// Advance iters to capture a whole move sequence as a single operation if possible.
-					auto oldStartIter = oldIter;
-					do {
-						++oldIter;
-						++newIter;
-					} while (oldIter != this->mValues.end() && newIter != newValues.end()
-					         && variantCmp(*oldIter, *newIter));
-
-					auto index = static_cast<qint32>(std::distance(this->mValues.begin(), iter));
-					auto oldStartIndex =
-					    static_cast<qint32>(std::distance(this->mValues.begin(), oldStartIter));
-					auto oldIndex = static_cast<qint32>(std::distance(this->mValues.begin(), oldIter));
-					auto len = oldIndex - oldStartIndex;
-
-					this->beginMoveRows(QModelIndex(), oldStartIndex, oldIndex - 1, QModelIndex(), index);
-
-					// While it is possible to optimize this further, it is currently not worth the time.
-					for (auto i = 0; i != len; i++) {
-						this->mValues.move(oldStartIndex + i, index + i);
-					}
-
-					iter = this->mValues.begin() + (index + len);
-					this->endMoveRows();
-				}
-			} else {
-				auto startNewIter = newIter;
-
-				do {
-					newIter++;
-				} while (newIter != newValues.end()
-				         && std::find_if(iter, this->mValues.end(), eqPredicate(*newIter))
-				                == this->mValues.end());
-
-				auto index = static_cast<qint32>(std::distance(this->mValues.begin(), iter));
-				auto newIndex = static_cast<qint32>(std::distance(newValues.begin(), newIter));
-				auto startNewIndex = static_cast<qint32>(std::distance(newValues.begin(), startNewIter));
-				auto len = newIndex - startNewIndex;
-
-				this->beginInsertRows(QModelIndex(), index, index + len - 1);
-#if QT_VERSION <= QT_VERSION_CHECK(6, 8, 0)
-				this->mValues.resize(this->mValues.length() + len);
-#else
-				this->mValues.resizeForOverwrite(this->mValues.length() + len);
-#endif
-				iter = this->mValues.begin() + index; // invalidated
-				std::move_backward(iter, this->mValues.end() - len, this->mValues.end());
-				iter = std::copy(startNewIter, newIter, iter);
-				this->endInsertRows();
+private:
+	ScriptModel* model;
+	const QVariantList& newValues;
+	bool compareValues;
+	qsizetype changedFirst = -1;
+	qsizetype changedLast = -1;
+};
+
+ScriptModelKey ScriptModel::keyOf(const QVariant& value) const {
+	auto key = value;
+
+	if (!this->cmpKey.isEmpty()) {
+		auto property = QVariant();
+
+		if (lookupProperty(value, this->cmpKey, property)) {
+			key = property;
+		} else if (this->cmpKeyPath.length() > 1) {
+			auto found = true;
+			property = value;
+
+			for (const auto& name: this->cmpKeyPath) {
+				auto next = QVariant();
+				found = lookupProperty(property, name, next);
+				if (!found) break;
+				property = std::move(next);
 			}
-		} else if (*newIter != *iter) {
-			auto first = static_cast<qint32>(std::distance(this->mValues.begin(), iter));
-			auto index = first;
-
-			do {
-				this->mValues.replace(index, *newIter);
-				++iter;
-				++newIter;
-				++index;
-			} while (iter != this->mValues.end() && newIter != newValues.end() && *newIter != *iter);
-
-			this->dataChanged(
-			    this->index(first, 0, QModelIndex()),
-			    this->index(index - 1, 0, QModelIndex()),
-			    {Qt::UserRole}
-			);
-		} else {
-			++iter;
-			++newIter;
+
+			if (found) key = property;
 		}
 	}
 
+	auto hash = hashVariant(key);
+	return ScriptModelKey {.value = std::move(key), .hash = hash};
+}
+
+void ScriptModel::updateValuesUnique(const QVariantList& newValues) {
+	this->hasActiveIterators = true;
+	this->mValues.reserve(newValues.size());
+
+	// Keys of the current values are kept from the last update.
+	auto newKeys = QList<ScriptModelKey>();
+	newKeys.reserve(newValues.size());
+	for (const auto& value: newValues) newKeys.append(this->keyOf(value));
+
+	auto handler = ScriptModelDiffHandler(this, newValues);
+	diffKeys(this->keys, newKeys, handler);
+	handler.flushChanged();
+
+	this->keys = std::move(newKeys);
 	this->hasActiveIterators = false;
 }
 
@@ -165,7 +227,13 @@ void ScriptModel::setValues(const QVariantList& newValues) {
 void ScriptModel::setObjectProp(const QString& objectProp) {
 	if (objectProp == this->cmpKey) return;
 	this->cmpKey = objectProp;
-	this->updateValuesUnique(this->mValues);
+	this->cmpKeyPath = objectProp.split(u'.');
+
+	// The values do not change, only how future values are compared to them.
+	this->keys.clear();
+	this->keys.reserve(this->mValues.size());
+	for (const auto& value: this->mValues) this->keys.append(this->keyOf(value));
+
 	emit this->objectPropChanged();
 }
 
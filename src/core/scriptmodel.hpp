@@ -4,7 +4,21 @@
 #include <qcontainerfwd.h>
 #include <qproperty.h>
 #include <qqmlintegration.h>
+#include <qstringlist.h>
 #include <qtmetamacros.h>
+#include <qvariant.h>
+
+// A comparison key of a ScriptModel value, with its hash computed once.
+struct ScriptModelKey {
+	QVariant value;
+	size_t hash = 0;
+
+	[[nodiscard]] bool operator==(const ScriptModelKey& other) const {
+		return this->hash == other.hash && this->value == other.value;
+	}
+};
+
+inline size_t qHash(const ScriptModelKey& key, size_t seed = 0) { return key.hash ^ seed; }
 
 ///! QML model reflecting a javascript expression
 /// ScriptModel is a QML [Data Model] that generates model operations based on changes
@@ -72,6 +86,9 @@ class ScriptModel: public QAbstractListModel {
 	/// For example, if `objectProp` is `"myprop"` then `{ myprop: "a", other: "y" }` and
 	/// `{ myprop: "a", other: "z" }` will be considered equal.
 	///
+	/// Nested properties can be used as keys by separating property names with `.`, such as
+	/// `"meta.id"`. Properties of QObjects can be used as keys as well.
+	///
 	/// Defaults to `""`, meaning no key.
 	Q_PROPERTY(QString objectProp READ objectProp WRITE setObjectProp NOTIFY objectPropChanged);
 	QML_ELEMENT;
@@ -99,8 +116,14 @@ signals:
 
 private:
 	QVariantList mValues;
+	// comparison keys of mValues
+	QList<ScriptModelKey> keys;
 	QString cmpKey;
+	QStringList cmpKeyPath;
 	bool hasActiveIterators = false;
 
+	[[nodiscard]] ScriptModelKey keyOf(const QVariant& value) const;
 	void updateValuesUnique(const QVariantList& newValues);
+
+	friend class ScriptModelDiffHandler;
 };
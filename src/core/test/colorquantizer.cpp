@@ -0,0 +1,169 @@
+#include "colorquantizer.hpp"
+#include <algorithm>
+#include <array>
+
+#include <qcolor.h>
+#include <qimage.h>
+#include <qlist.h>
+#include <qrandom.h>
+#include <qsignalspy.h>
+#include <qstring.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+#include <qurl.h>
+
+#include "../colorquantizer.hpp"
+
+namespace {
+
+QList<QColor> quantize(const QString& path, qreal depth, ColorQuantizerAlgorithm::Enum algorithm) {
+	auto source = QUrl::fromLocalFile(path);
+	auto* operation = new ColorQuantizerOperation(&source, depth, 0, algorithm);
+
+	auto spy = QSignalSpy(operation, &ColorQuantizerOperation::done);
+	operation->run();
+
+	// the operation deletes itself after emitting done
+	if (!spy.wait()) return QList<QColor>();
+	auto colors = spy.takeFirst().at(0).value<QList<QColor>>();
+
+	std::ranges::sort(colors, [](const QColor& a, const QColor& b) { return a.rgb() < b.rgb(); });
+	return colors;
+}
+
+// Blocks of 8 distinct colors with equal pixel counts, each in its own histogram bin.
+QImage createBlockImage() {
+	auto image = QImage(64, 64, QImage::Format_RGB32);
+
+	for (auto y = 0; y != image.height(); ++y) {
+		for (auto x = 0; x != image.width(); ++x) {
+			auto block = (x / 8 + y / 8) % 8;
+			image.setPixel(
+			    x,
+			    y,
+			    qRgb((block & 1) ? 224 : 32, (block & 2) ? 224 : 32, (block & 4) ? 224 : 32)
+			);
+		}
+	}
+
+	return image;
+}
+
+// A smooth gradient with a small amount of noise, so exact median planes rarely land
+// on histogram bin boundaries.
+QImage createGradientImage(int size) {
+	auto image = QImage(size, size, QImage::Format_RGB32);
+	auto random = QRandomGenerator(1234);
+
+	for (auto y = 0; y != image.height(); ++y) {
+		for (auto x = 0; x != image.width(); ++x) {
+			auto noise = static_cast<int>(random.bounded(8));
+			image.setPixel(
+			    x,
+			    y,
+			    qRgb(
+			        x * 255 / (size - 1),
+			        y * 255 / (size - 1),
+			        qBound(0, 128 + noise + (x - y) * 64 / size, 255)
+			    )
+			);
+		}
+	}
+
+	return image;
+}
+
+} // namespace
+
+void TestColorQuantizer::initTestCase() {
+	QVERIFY(this->dir.isValid());
+	QVERIFY(createBlockImage().save(this->dir.filePath("blocks.png")));
+	QVERIFY(createGradientImage(256).save(this->dir.filePath("gradient.png")));
+	QVERIFY(createGradientImage(1024).save(this->dir.filePath("large.png")));
+}
+
+void TestColorQuantizer::distinctColors_data() {
+	QTest::addColumn<qreal>("depth");
+
+	QTest::addRow("depth 1") << 1.0;
+	QTest::addRow("depth 2") << 2.0;
+	QTest::addRow("depth 3") << 3.0;
+}
+
+void TestColorQuantizer::distinctColors() {
+	QFETCH(qreal, depth);
+
+	auto path = this->dir.filePath("blocks.png");
+	auto exact = quantize(path, depth, ColorQuantizerAlgorithm::Exact);
+	auto histogram = quantize(path, depth, ColorQuantizerAlgorithm::Histogram);
+
+	QCOMPARE(exact.length(), 1 << static_cast<int>(depth));
+	QCOMPARE(histogram, exact);
+}
+
+void TestColorQuantizer::gradientTolerance_data() {
+	QTest::addColumn<qreal>("depth");
+
+	QTest::addRow("depth 2") << 2.0;
+	QTest::addRow("depth 3") << 3.0;
+	QTest::addRow("depth 4") << 4.0;
+}
+
+void TestColorQuantizer::gradientTolerance() {
+	QFETCH(qreal, depth);
+
+	// Split planes may be off by up to half a histogram bin (4 units) from the exact median,
+	// which moves the averages of both halves. Allow a few splits worth of drift.
+	constexpr auto TOLERANCE = 12;
+
+	auto path = this->dir.filePath("gradient.png");
+	auto exact = quantize(path, depth, ColorQuantizerAlgorithm::Exact);
+	auto histogram = quantize(path, depth, ColorQuantizerAlgorithm::Histogram);
+
+	QCOMPARE(exact.length(), 1 << static_cast<int>(depth));
+	QCOMPARE(histogram.length(), exact.length());
+
+	for (const auto& color: histogram) {
+		auto distance = [&](const QColor& other) {
+			auto channels = std::array {
+			    qAbs(color.red() - other.red()),
+			    qAbs(color.green() - other.green()),
+			    qAbs(color.blue() - other.blue()),
+			};
+
+			return *std::ranges::max_element(channels);
+		};
+
+		auto nearest = *std::ranges::min_element(exact, {}, distance);
+
+		if (distance(nearest) > TOLERANCE) {
+			QFAIL(qPrintable(
+			    QString("%1 is not within %2 of any exact color (nearest %3)")
+			        .arg(color.name())
+			        .arg(TOLERANCE)
+			        .arg(nearest.name())
+			));
+		}
+	}
+}
+
+void TestColorQuantizer::benchmark_data() {
+	QTest::addColumn<ColorQuantizerAlgorithm::Enum>("algorithm");
+
+	QTest::addRow("exact") << ColorQuantizerAlgorithm::Exact;
+	QTest::addRow("histogram") << ColorQuantizerAlgorithm::Histogram;
+}
+
+void TestColorQuantizer::benchmark() {
+	QFETCH(ColorQuantizerAlgorithm::Enum, algorithm);
+
+	auto path = this->dir.filePath("large.png");
+
+	QBENCHMARK {
+		auto colors = quantize(path, 3, algorithm);
+		QCOMPARE(colors.length(), 8);
+	}
+}
+
+QTEST_MAIN(TestColorQuantizer);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <qobject.h>
+#include <qtemporarydir.h>
+#include <qtmetamacros.h>
+
+class TestColorQuantizer: public QObject {
+	Q_OBJECT;
+
+private slots:
+	void initTestCase();
+	void distinctColors_data();
+	void distinctColors();
+	void gradientTolerance_data();
+	void gradientTolerance();
+	void benchmark_data();
+	void benchmark();
+
+private:
+	QTemporaryDir dir;
+};
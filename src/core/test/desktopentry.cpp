@@ -0,0 +1,214 @@
+#include "desktopentry.hpp"
+
+#include <qlist.h>
+#include <qstring.h>
+#include <qstringlist.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+
+#include "../desktopentry.hpp"
+#include "../desktopentrysearch.hpp"
+
+namespace {
+
+QStringList searchIds(const DesktopEntrySearchIndex& index, const QString& query) {
+	auto matches = QList<DesktopEntrySearchIndex::Match>();
+	index.search(DesktopEntrySearchIndex::normalize(query), nullptr, matches);
+	DesktopEntrySearchIndex::rank(matches);
+
+	auto ids = QStringList();
+	for (const auto& match: matches) ids.append(index.id(match.item));
+	return ids;
+}
+
+} // namespace
+
+DesktopEntry*
+TestDesktopEntry::createEntry(const QString& id, const QString& name, const QString& keys) {
+	auto text = "[Desktop Entry]\nType=Application\nName=" + name + '\n' + keys;
+
+	auto* entry = new DesktopEntry(id, this);
+	entry->updateState(DesktopEntry::parseText(id, text));
+	return entry;
+}
+
+// Entries with overlapping names and keywords, as found on a typical system.
+QList<DesktopEntry*> TestDesktopEntry::createEntries(qsizetype count) {
+	static const auto words = QStringList {
+	    "Files",   "Web",    "Browser", "Mail",   "Editor", "Terminal", "Music",  "Video",
+	    "Player",  "Office", "Writer",  "Viewer", "Image",  "Calendar", "System", "Monitor",
+	    "Network", "Chat",   "Notes",   "Photo",  "Game",   "Studio",   "Sound",  "Settings",
+	};
+
+	auto entries = QList<DesktopEntry*>();
+
+	for (qsizetype i = 0; i < count; i++) {
+		auto name = words.at(i % words.length()) + ' ' + words.at((i * 7 + 3) % words.length()) + ' '
+		          + QString::number(i);
+
+		auto keys = QString("GenericName=%1\nKeywords=%2;%3;\nCategories=Utility;\n"
+		                    "StartupWMClass=App%4\nExec=/usr/bin/app-%4 %U\n")
+		                .arg(words.at((i * 5 + 1) % words.length()))
+		                .arg(words.at((i * 3 + 2) % words.length()))
+		                .arg(words.at((i * 11 + 5) % words.length()))
+		                .arg(i);
+
+		entries.append(this->createEntry(QString("org.example.app%1").arg(i), name, keys));
+	}
+
+	return entries;
+}
+
+void TestDesktopEntry::ranking_data() { // NOLINT
+	QTest::addColumn<QString>("query");
+	QTest::addColumn<QStringList>("ids");
+
+	QTest::addRow("empty") << "" << QStringList {"elan", "files", "firefox", "foot", "gimp"};
+	QTest::addRow("exact") << "foot" << QStringList {"foot"};
+	QTest::addRow("prefix") << "fi" << QStringList {"files", "firefox"};
+	QTest::addRow("word") << "manipulation" << QStringList {"gimp"};
+	QTest::addRow("keyword") << "www" << QStringList {"firefox"};
+	QTest::addRow("diacritics") << "ELAN" << QStringList {"elan"};
+	QTest::addRow("fuzzy") << "ffx" << QStringList {"firefox"};
+	QTest::addRow("none") << "zzz" << QStringList();
+}
+
+void TestDesktopEntry::ranking() {
+	QFETCH(QString, query);
+	QFETCH(QStringList, ids);
+
+	auto entries = QList<DesktopEntry*> {
+	    this->createEntry("firefox", "Firefox", "Keywords=WWW;"),
+	    this->createEntry("files", "Files"),
+	    this->createEntry("foot", "Foot", "Comment=Terminal"),
+	    this->createEntry("elan", "Élan"),
+	    this->createEntry("gimp", "GNU Image Manipulation Program"),
+	};
+
+	DesktopEntrySearchIndex index;
+	index.rebuild(entries);
+
+	QCOMPARE(searchIds(index, query), ids);
+	qDeleteAll(entries);
+}
+
+void TestDesktopEntry::incremental() {
+	auto entries = this->createEntries(500);
+
+	DesktopEntrySearchIndex index;
+	index.rebuild(entries);
+
+	auto query = QString();
+	auto previous = QList<qint32>();
+
+	for (auto c: QString("web player 1")) {
+		query.append(c);
+
+		auto full = QList<DesktopEntrySearchIndex::Match>();
+		auto incremental = QList<DesktopEntrySearchIndex::Match>();
+		index.search(query, nullptr, full);
+		index.search(query, query.length() > 3 ? &previous : nullptr, incremental);
+
+		DesktopEntrySearchIndex::rank(full);
+		DesktopEntrySearchIndex::rank(incremental);
+
+		QCOMPARE(incremental.length(), full.length());
+		for (qsizetype i = 0; i < full.length(); i++) {
+			QCOMPARE(incremental.at(i).item, full.at(i).item);
+			QCOMPARE(incremental.at(i).score, full.at(i).score);
+		}
+
+		previous.clear();
+		for (const auto& match: full) previous.append(match.item);
+	}
+
+	qDeleteAll(entries);
+}
+
+void TestDesktopEntry::benchmarkSearch_data() { // NOLINT
+	QTest::addColumn<QString>("query");
+
+	QTest::addRow("short") << "w";
+	QTest::addRow("word") << "player";
+	QTest::addRow("fuzzy") << "wbp";
+	QTest::addRow("long") << "music player 1999";
+}
+
+void TestDesktopEntry::benchmarkSearch() {
+	QFETCH(QString, query);
+
+	auto entries = this->createEntries(2000);
+
+	DesktopEntrySearchIndex index;
+	index.rebuild(entries);
+
+	auto matches = QList<DesktopEntrySearchIndex::Match>();
+
+	QBENCHMARK {
+		matches.clear();
+		index.search(query, nullptr, matches);
+		DesktopEntrySearchIndex::rank(matches, 50);
+	}
+
+	QVERIFY(!matches.isEmpty());
+	qDeleteAll(entries);
+}
+
+void TestDesktopEntry::lookup_data() { // NOLINT
+	QTest::addColumn<QString>("name");
+	QTest::addColumn<QString>("id");
+
+	QTest::addRow("startup class") << "Navigator" << "firefox";
+	QTest::addRow("lowercase startup class") << "navigator" << "firefox";
+	QTest::addRow("exec") << "Alacritty" << "org.alacritty.Terminal";
+	QTest::addRow("env exec") << "code" << "visual-studio-code";
+	QTest::addRow("id suffix") << "nautilus" << "org.gnome.Nautilus";
+	QTest::addRow("displayed first") << "editor" << "editor";
+	QTest::addRow("missing") << "missing" << "";
+}
+
+void TestDesktopEntry::lookup() {
+	QFETCH(QString, name);
+	QFETCH(QString, id);
+
+	auto entries = QList<DesktopEntry*> {
+	    this->createEntry("firefox", "Firefox", "StartupWMClass=Navigator\nExec=firefox %u"),
+	    this->createEntry("org.alacritty.Terminal", "Alacritty", "Exec=/usr/bin/alacritty"),
+	    this->createEntry("visual-studio-code", "Code", "Exec=env ELECTRON_OZONE=1 code %F"),
+	    this->createEntry("org.gnome.Nautilus", "Files", "Exec=nautilus --new-window"),
+	    this->createEntry("hidden-editor", "Editor", "NoDisplay=true\nExec=editor --hidden"),
+	    this->createEntry("editor", "Editor", "Exec=editor"),
+	};
+
+	DesktopEntryHeuristicIndex index;
+	index.rebuild(entries);
+
+	auto* entry = index.lookup(name, name.toLower());
+	QCOMPARE(entry ? entry->mId : QString(), id);
+
+	qDeleteAll(entries);
+}
+
+void TestDesktopEntry::benchmarkLookup() {
+	auto entries = this->createEntries(2000);
+	auto names = QStringList();
+
+	// toplevel app ids are usually lowercased startup classes or executable names
+	for (auto i = 0; i < 2000; i++) {
+		names.append(i % 2 == 0 ? QString("app%1").arg(i) : QString("APP-%1").arg(i));
+	}
+
+	DesktopEntryHeuristicIndex index;
+	index.rebuild(entries);
+
+	QBENCHMARK {
+		for (const auto& name: names) {
+			QVERIFY(index.lookup(name, name.toLower()));
+		}
+	}
+
+	qDeleteAll(entries);
+}
+
+QTEST_MAIN(TestDesktopEntry);
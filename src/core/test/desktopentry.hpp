@@ -0,0 +1,26 @@
+#pragma once
+
+#include <qlist.h>
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+#include "../desktopentry.hpp"
+
+class TestDesktopEntry: public QObject {
+	Q_OBJECT;
+
+private slots:
+	void ranking_data();
+	void ranking();
+	void incremental();
+	void benchmarkSearch_data();
+	void benchmarkSearch();
+
+	void lookup_data();
+	void lookup();
+	void benchmarkLookup();
+
+private:
+	DesktopEntry* createEntry(const QString& id, const QString& name, const QString& keys = {});
+	QList<DesktopEntry*> createEntries(qsizetype count);
+};
@@ -0,0 +1,176 @@
+#include "incrementalreload.hpp"
+#include <utility>
+
+#include <qbytearray.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qlist.h>
+#include <qlogging.h>
+#include <qobject.h>
+#include <qpair.h>
+#include <qpointer.h>
+#include <qqml.h>
+#include <qqmlcomponent.h>
+#include <qset.h>
+#include <qstring.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qurl.h>
+
+#include "../generation.hpp"
+#include "../lazyloader.hpp"
+#include "../paths.hpp"
+#include "../reload.hpp"
+#include "../scan.hpp"
+
+namespace {
+
+bool writeFile(const QString& path, const QByteArray& content) {
+	auto file = QFile(path);
+	if (!file.open(QFile::WriteOnly | QFile::Truncate)) return false;
+	return file.write(content) == content.length();
+}
+
+ReloadProbe* probe(LazyLoader* loader) { return qobject_cast<ReloadProbe*>(loader->item()); }
+
+} // namespace
+
+void ReloadProbe::onReload(QObject* oldInstance) {
+	if (auto* old = qobject_cast<ReloadProbe*>(oldInstance)) {
+		this->state = old->state;
+	}
+}
+
+void TestIncrementalReload::initTestCase() {
+	QVERIFY(this->dir.isValid());
+	QsPaths::init("reload-test", "reload-test", "", "", this->dir.filePath("cache"));
+
+	qmlRegisterType<LazyLoader>("QsTest", 1, 0, "LazyLoader");
+	qmlRegisterType<ReloadProbe>("QsTest", 1, 0, "ReloadProbe");
+}
+
+QString TestIncrementalReload::createConfig(
+    const QString& name,
+    const QList<QPair<QString, QByteArray>>& files
+) {
+	auto root = QDir(this->dir.filePath(name));
+	if (!root.mkpath(".")) return QString();
+
+	for (const auto& [path, content]: files) {
+		if (!writeFile(root.filePath(path), content)) return QString();
+	}
+
+	return root.canonicalPath();
+}
+
+EngineGeneration* TestIncrementalReload::load(const QString& root) {
+	auto rootDir = QDir(root);
+	auto scanner = QmlScanner(rootDir);
+	scanner.scanQmlRoot(rootDir.filePath("shell.qml"));
+
+	auto* generation = new EngineGeneration(rootDir, std::move(scanner));
+
+	QUrl url;
+	url.setScheme("qs");
+	url.setPath("@/qs/shell.qml");
+	auto component = QQmlComponent(generation->engine, url);
+
+	if (!component.isReady()) {
+		qWarning() << component.errors();
+		generation->shutdown();
+		return nullptr;
+	}
+
+	generation->root = component.create();
+	Reloadable::reloadRecursive(generation->root, nullptr);
+	return generation;
+}
+
+void TestIncrementalReload::setChanged(
+    EngineGeneration* generation,
+    const QList<QString>& files
+) {
+	generation->changedFiles = QSet<QString>(files.begin(), files.end());
+}
+
+void TestIncrementalReload::carriesState() {
+	auto root = this->createConfig(
+	    "state",
+	    {
+	        {"shell.qml",
+	         "import QtQuick\nimport QsTest\n"
+	         "Item { LazyLoader { source: \"Probe.qml\"; active: true } }\n"},
+	        {"Probe.qml", "import QsTest\nReloadProbe { revision: 1 }\n"},
+	    }
+	);
+
+	QVERIFY(!root.isEmpty());
+	auto* generation = TestIncrementalReload::load(root);
+	QVERIFY(generation != nullptr);
+
+	auto* loader = generation->root->findChild<LazyLoader*>();
+	QVERIFY(loader != nullptr);
+
+	auto oldProbe = QPointer(probe(loader));
+	QVERIFY(oldProbe != nullptr);
+	QCOMPARE(oldProbe->revision, 1);
+	oldProbe->state = "kept";
+
+	auto probePath = QDir(root).filePath("Probe.qml");
+	QVERIFY(writeFile(probePath, "import QsTest\nReloadProbe { revision: 2 }\n"));
+	TestIncrementalReload::setChanged(generation, {probePath});
+	QVERIFY(generation->reloadIncremental());
+
+	auto* newProbe = probe(loader);
+	QVERIFY(newProbe != nullptr);
+	QVERIFY(oldProbe == nullptr);
+	QCOMPARE(newProbe->revision, 2);
+	QCOMPARE(newProbe->state, "kept");
+
+	generation->shutdown();
+}
+
+void TestIncrementalReload::compileFailureKeepsItems() {
+	auto root = this->createConfig(
+	    "failure",
+	    {
+	        {"shell.qml",
+	         "import QtQuick\nimport QsTest\nItem {\n"
+	         "\tLazyLoader { objectName: \"a\"; source: \"ProbeA.qml\"; active: true }\n"
+	         "\tLazyLoader { objectName: \"b\"; source: \"ProbeB.qml\"; active: true }\n"
+	         "}\n"},
+	        {"ProbeA.qml", "import QsTest\nReloadProbe { revision: 1 }\n"},
+	        {"ProbeB.qml", "import QsTest\nReloadProbe { revision: 1 }\n"},
+	    }
+	);
+
+	QVERIFY(!root.isEmpty());
+	auto* generation = TestIncrementalReload::load(root);
+	QVERIFY(generation != nullptr);
+
+	auto* loaderA = generation->root->findChild<LazyLoader*>("a");
+	auto* loaderB = generation->root->findChild<LazyLoader*>("b");
+	QVERIFY(loaderA != nullptr && loaderB != nullptr);
+
+	auto* probeA = probe(loaderA);
+	auto* probeB = probe(loaderB);
+	QVERIFY(probeA != nullptr && probeB != nullptr);
+
+	// A compiles but B does not, so neither may be replaced.
+	auto pathA = QDir(root).filePath("ProbeA.qml");
+	auto pathB = QDir(root).filePath("ProbeB.qml");
+	QVERIFY(writeFile(pathA, "import QsTest\nReloadProbe { revision: 2 }\n"));
+	QVERIFY(writeFile(pathB, "import QsTest\nReloadProbe { revision: }\n"));
+	TestIncrementalReload::setChanged(generation, {pathA, pathB});
+	QVERIFY(!generation->reloadIncremental());
+
+	QCOMPARE(probe(loaderA), probeA);
+	QCOMPARE(probe(loaderB), probeB);
+	QCOMPARE(probeA->revision, 1);
+	QCOMPARE(probeB->revision, 1);
+
+	generation->shutdown();
+}
+
+QTEST_MAIN(TestIncrementalReload);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <qbytearray.h>
+#include <qlist.h>
+#include <qobject.h>
+#include <qpair.h>
+#include <qstring.h>
+#include <qtemporarydir.h>
+#include <qtmetamacros.h>
+
+#include "../reload.hpp"
+
+class EngineGeneration;
+
+// Carries state over from the instance it replaces.
+class ReloadProbe: public Reloadable {
+	Q_OBJECT;
+	Q_PROPERTY(int revision MEMBER revision);
+
+public:
+	explicit ReloadProbe(QObject* parent = nullptr): Reloadable(parent) {}
+
+	void onReload(QObject* oldInstance) override;
+
+	int revision = 0;
+	QString state;
+};
+
+class TestIncrementalReload: public QObject {
+	Q_OBJECT;
+
+private slots:
+	void initTestCase();
+	void carriesState();
+	void compileFailureKeepsItems();
+
+private:
+	// Creates a config directory with the given files, returning its canonical path.
+	QString createConfig(const QString& name, const QList<QPair<QString, QByteArray>>& files);
+	// Creates a generation for the config and loads its root like a full reload would.
+	static EngineGeneration* load(const QString& root);
+	static void setChanged(EngineGeneration* generation, const QList<QString>& files);
+
+	QTemporaryDir dir;
+};
@@ -0,0 +1,158 @@
+#include "logcompression.hpp"
+#include <array>
+
+#include <qbuffer.h>
+#include <qbytearray.h>
+#include <qbytearraylist.h>
+#include <qdatetime.h>
+#include <qlatin1stringview.h>
+#include <qlogging.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+
+#include "../logging.hpp"
+#include "../logging_p.hpp"
+
+using namespace qs::log;
+
+namespace {
+
+constexpr qsizetype MESSAGE_COUNT = 12000;
+
+LogMessage createMessage(qsizetype i) {
+	const auto categories = std::array<QLatin1StringView, 2> {
+	    QLatin1StringView("quickshell.test.a"),
+	    QLatin1StringView("quickshell.test.b"),
+	};
+
+	auto body = i % 8 == 0 ? QByteArray("repeated message")
+	                       : "message " + QByteArray::number(i) + ' ' + QByteArray(i % 40, 'x');
+
+	auto time = QDateTime::fromSecsSinceEpoch(1735732800).addMSecs(i * 250);
+	return LogMessage(i % 3 == 0 ? QtWarningMsg : QtInfoMsg, categories.at(i % 2), body, time);
+}
+
+QByteArray formatLine(const LogMessage& message) {
+	return QByteArray::number(message.time.toSecsSinceEpoch()) + ' '
+	     + QByteArray::number(message.type) + ' ' + message.category.toString().toUtf8() + ' '
+	     + message.body;
+}
+
+// Returns false if the header could not be read or the log is not compressed.
+bool readCompressedHeader(EncodedLogReader& reader) {
+	bool readable = false;
+	quint8 logVersion = 0;
+	quint8 readerVersion = 0;
+	if (!reader.readHeader(&readable, &logVersion, &readerVersion) || !readable) return false;
+	return reader.isCompressed();
+}
+
+// Reads every complete message currently available.
+void readAvailable(EncodedLogReader& reader, QByteArrayList* lines) {
+	LogMessage message;
+	while (reader.read(&message)) {
+		lines->append(formatLine(message));
+	}
+}
+
+} // namespace
+
+void TestLogCompression::completeStream() {
+	QBuffer buffer;
+	QBuffer indexBuffer;
+	QVERIFY(buffer.open(QBuffer::WriteOnly));
+	QVERIFY(indexBuffer.open(QBuffer::WriteOnly));
+
+	EncodedLogWriter writer;
+	writer.setDevice(&buffer);
+	writer.setIndexDevice(&indexBuffer);
+	writer.setCompressed(true);
+	QVERIFY(writer.writeHeader());
+
+	QByteArrayList expected;
+	for (qsizetype i = 0; i != MESSAGE_COUNT; i++) {
+		auto message = createMessage(i);
+		QVERIFY(writer.write(message));
+		expected.append(formatLine(message));
+	}
+
+	const auto& log = buffer.data();
+
+	{
+		EncodedLogReader reader;
+		reader.setData(log.constData(), log.size());
+		if (!readCompressedHeader(reader)) QSKIP("Built without log compression.");
+	}
+
+	// Every block starts at a sync point, and all but the last are complete frames.
+	// Index entries are 16 bytes after the version byte.
+	auto blocks = (indexBuffer.data().size() - 1) / 16;
+	QVERIFY(blocks >= 3);
+
+	// mapped reads
+	{
+		EncodedLogReader reader;
+		reader.setData(log.constData(), log.size());
+		QVERIFY(readCompressedHeader(reader));
+
+		QByteArrayList lines;
+		readAvailable(reader, &lines);
+		QCOMPARE(lines, expected);
+		QCOMPARE(reader.streamPos(), reader.recordStart());
+	}
+
+	// sequential reads
+	{
+		QBuffer source;
+		source.setData(log);
+		QVERIFY(source.open(QBuffer::ReadOnly));
+
+		EncodedLogReader reader;
+		reader.setDevice(&source);
+		QVERIFY(readCompressedHeader(reader));
+
+		QByteArrayList lines;
+		readAvailable(reader, &lines);
+		QCOMPARE(lines, expected);
+		QVERIFY(source.atEnd());
+	}
+}
+
+// Emulates qs log --follow, which rereads the log as it grows while the last block's
+// frame is still open. Every message must be readable as soon as it has been written.
+void TestLogCompression::partialBlock() {
+	QBuffer buffer;
+	QVERIFY(buffer.open(QBuffer::WriteOnly));
+
+	EncodedLogWriter writer;
+	writer.setDevice(&buffer);
+	writer.setCompressed(true);
+	QVERIFY(writer.writeHeader());
+
+	const auto& log = buffer.data();
+	EncodedLogReader reader;
+	reader.setData(log.constData(), log.size());
+	if (!readCompressedHeader(reader)) QSKIP("Built without log compression.");
+
+	QByteArrayList expected;
+	QByteArrayList lines;
+
+	for (qsizetype i = 0; i != MESSAGE_COUNT; i++) {
+		auto message = createMessage(i);
+		QVERIFY(writer.write(message));
+		expected.append(formatLine(message));
+
+		// the buffer may have been reallocated by the write
+		reader.setData(log.constData(), log.size());
+		readAvailable(reader, &lines);
+
+		// a failed read at the end of the data must not consume part of a record
+		QCOMPARE(reader.streamPos(), reader.recordStart());
+		QCOMPARE(lines.length(), expected.length());
+	}
+
+	QCOMPARE(lines, expected);
+}
+
+QTEST_MAIN(TestLogCompression);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+class TestLogCompression: public QObject {
+	Q_OBJECT;
+
+private slots:
+	static void completeStream();
+	static void partialBlock();
+};
@@ -0,0 +1,237 @@
+#include "logindex.hpp"
+#include <array>
+#include <utility>
+
+#include <qbytearray.h>
+#include <qbytearraylist.h>
+#include <qdatetime.h>
+#include <qfile.h>
+#include <qlatin1stringview.h>
+#include <qlist.h>
+#include <qlogging.h>
+#include <qregularexpression.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+
+#include "../logging.hpp"
+#include "../logging_p.hpp"
+#include "../logging_qtprivate.hpp"
+#include "../ringbuf.hpp"
+
+using namespace qs::log;
+using qt_logging_registry::QLoggingRule;
+
+namespace {
+
+const auto LOG_START = QDateTime::fromSecsSinceEpoch(1735732800);
+constexpr qsizetype MESSAGE_COUNT = 12000;
+
+// Four messages per second, so most sync points share a second with the messages before them.
+QDateTime messageTime(qsizetype i) { return LOG_START.addMSecs(i * 250); }
+
+bool writeLog(const QString& path) {
+	const auto categories = std::array<QLatin1StringView, 3> {
+	    QLatin1StringView("quickshell.test.a"),
+	    QLatin1StringView("quickshell.test.b"),
+	    QLatin1StringView("quickshell.test.noisy"),
+	};
+
+	const auto types = std::array<QtMsgType, 4> {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg};
+
+	QFile file(path);
+	QFile indexFile(LogIndex::pathFor(path));
+	if (!file.open(QFile::WriteOnly | QFile::Truncate)) return false;
+	if (!indexFile.open(QFile::WriteOnly | QFile::Truncate)) return false;
+
+	EncodedLogWriter writer;
+	writer.setDevice(&file);
+	if (!writer.writeHeader()) return false;
+	writer.setIndexDevice(&indexFile);
+
+	for (qsizetype i = 0; i != MESSAGE_COUNT; i++) {
+		auto body = i % 8 == 0 ? QByteArray("repeated message")
+		                       : "message " + QByteArray::number(i) + ' ' + QByteArray(i % 40, 'x');
+
+		auto message = LogMessage(types.at(i % 4), categories.at(i % 3), body, messageTime(i));
+		if (!writer.write(message)) return false;
+	}
+
+	return true;
+}
+
+LogQuery createQuery(const QDateTime& since, const QDateTime& until) {
+	auto rules = QList<QLoggingRule> {
+	    QLoggingRule(u"quickshell.test.noisy", false),
+	    QLoggingRule(u"quickshell.test.a.debug", false),
+	};
+
+	return LogQuery(rules, since, until);
+}
+
+QByteArray formatLine(const LogMessage& message) {
+	return QByteArray::number(message.time.toMSecsSinceEpoch()) + ' '
+	     + QByteArray::number(message.type) + ' ' + message.category.toString().toUtf8() + ' '
+	     + message.body;
+}
+
+// Reads accepted messages until the end of the log or the time range, keeping the last tail.
+QByteArrayList readMessages(EncodedLogReader& reader, LogQuery& query, int tail) {
+	QByteArrayList lines;
+	LogMessage message;
+
+	while (reader.read(&message, &query)) {
+		if (query.isAfterRange(message.time)) break;
+		if (!query.accepts(reader, message)) continue;
+
+		lines.append(formatLine(message));
+		if (tail != 0 && lines.length() > tail) lines.removeFirst();
+	}
+
+	return lines;
+}
+
+} // namespace
+
+void TestLogIndex::initTestCase() {
+	QVERIFY(this->dir.isValid());
+	this->path = this->dir.filePath("log.qslog");
+	QVERIFY(writeLog(this->path));
+
+	LogIndex index;
+	QVERIFY(index.open(this->path, QFile(this->path).size()));
+
+	for (qsizetype i = 0; i != index.size(); i++) {
+		this->syncPoints.append(index.at(i));
+	}
+
+	// Several sync points are needed to check that reads start at the right one.
+	QVERIFY(this->syncPoints.length() >= 4);
+
+	QFile file(this->path);
+	QVERIFY(file.open(QFile::ReadOnly));
+	auto data = file.readAll();
+
+	EncodedLogReader reader;
+	reader.setData(data.constData(), data.size());
+
+	bool readable = false;
+	quint8 logVersion = 0;
+	quint8 readerVersion = 0;
+	QVERIFY(reader.readHeader(&readable, &logVersion, &readerVersion) && readable);
+
+	auto query = createQuery(QDateTime(), QDateTime());
+	auto lastSync = static_cast<qint64>(this->syncPoints.last().offset);
+	LogMessage message;
+
+	while (reader.read(&message, &query)) {
+		if (!query.accepts(reader, message)) continue;
+
+		this->totalCount++;
+		if (reader.recordStart() >= lastSync) this->lastSegmentCount++;
+	}
+
+	QCOMPARE(reader.streamPos(), static_cast<qint64>(data.size()));
+	QVERIFY(this->lastSegmentCount > 0);
+}
+
+TestLogIndex::ReadResult TestLogIndex::readIndexed(int tail, LogQuery query) {
+	QFile file(this->path);
+	if (!file.open(QFile::ReadOnly)) return ReadResult();
+
+	auto logReader = LogReader(&file, false, false, tail, std::move(query));
+	if (!logReader.initialize()) return ReadResult();
+
+	auto result = ReadResult();
+	result.start = logReader.reader.pos();
+	result.lines = readMessages(logReader.reader, logReader.query, tail);
+	return result;
+}
+
+TestLogIndex::ReadResult TestLogIndex::readSequential(int tail, LogQuery query) {
+	QFile file(this->path);
+	if (!file.open(QFile::ReadOnly)) return ReadResult();
+	auto data = file.readAll();
+
+	EncodedLogReader reader;
+	reader.setData(data.constData(), data.size());
+
+	bool readable = false;
+	quint8 logVersion = 0;
+	quint8 readerVersion = 0;
+	if (!reader.readHeader(&readable, &logVersion, &readerVersion) || !readable) return ReadResult();
+
+	auto result = ReadResult();
+	result.start = reader.pos();
+	result.lines = readMessages(reader, query, tail);
+	return result;
+}
+
+void TestLogIndex::tail_data() {
+	QTest::addColumn<int>("tail");
+	// Expected start offset, or -1 to only check messages.
+	QTest::addColumn<qint64>("start");
+
+	auto syncCount = this->syncPoints.length();
+	auto lastSync = static_cast<qint64>(this->syncPoints.at(syncCount - 1).offset);
+	auto previousSync = static_cast<qint64>(this->syncPoints.at(syncCount - 2).offset);
+	auto lastSegment = static_cast<int>(this->lastSegmentCount);
+
+	QTest::addRow("single") << 1 << lastSync;
+	QTest::addRow("last segment") << lastSegment << lastSync;
+	QTest::addRow("past last segment") << lastSegment + 1 << previousSync;
+	QTest::addRow("several segments") << lastSegment + 5000 << qint64(-1);
+	QTest::addRow("whole log") << static_cast<int>(this->totalCount) << qint64(1);
+	QTest::addRow("past whole log") << static_cast<int>(this->totalCount) + 10 << qint64(1);
+}
+
+void TestLogIndex::tail() {
+	QFETCH(int, tail);
+	QFETCH(qint64, start);
+
+	auto indexed = this->readIndexed(tail, createQuery(QDateTime(), QDateTime()));
+	auto sequential = this->readSequential(tail, createQuery(QDateTime(), QDateTime()));
+
+	QVERIFY(!sequential.lines.isEmpty());
+	if (start != -1) QCOMPARE(indexed.start, start);
+	QCOMPARE(indexed.lines, sequential.lines);
+}
+
+void TestLogIndex::timeRange_data() {
+	QTest::addColumn<QDateTime>("since");
+	QTest::addColumn<QDateTime>("until");
+	QTest::addColumn<int>("tail");
+
+	auto logEnd = messageTime(MESSAGE_COUNT - 1);
+
+	// Starting exactly on a sync point's second must include earlier messages in that second.
+	for (auto i = 0; i != this->syncPoints.length(); i++) {
+		auto time = QDateTime::fromSecsSinceEpoch(static_cast<qint64>(this->syncPoints.at(i).time));
+
+		QTest::addRow("at sync point %d", i) << time << QDateTime() << 0;
+		QTest::addRow("after sync point %d", i) << time.addMSecs(500) << QDateTime() << 0;
+		QTest::addRow("before sync point %d", i) << time.addSecs(-1) << time << 0;
+	}
+
+	auto middle = QDateTime::fromSecsSinceEpoch(static_cast<qint64>(this->syncPoints.at(1).time));
+
+	QTest::addRow("before log") << LOG_START.addSecs(-10) << QDateTime() << 0;
+	QTest::addRow("after log") << logEnd.addSecs(10) << QDateTime() << 0;
+	QTest::addRow("range") << middle << middle.addSecs(600) << 0;
+	QTest::addRow("range with tail") << middle << middle.addSecs(600) << 50;
+	QTest::addRow("since with tail") << middle << QDateTime() << 50;
+}
+
+void TestLogIndex::timeRange() {
+	QFETCH(QDateTime, since);
+	QFETCH(QDateTime, until);
+	QFETCH(int, tail);
+
+	auto indexed = this->readIndexed(tail, createQuery(since, until));
+	auto sequential = this->readSequential(tail, createQuery(since, until));
+
+	QVERIFY(indexed.start != -1);
+	QCOMPARE(indexed.lines, sequential.lines);
+}
+
+QTEST_MAIN(TestLogIndex);
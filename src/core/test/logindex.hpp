@@ -0,0 +1,40 @@
+#pragma once
+
+#include <qbytearraylist.h>
+#include <qlist.h>
+#include <qobject.h>
+#include <qstring.h>
+#include <qtemporarydir.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+
+#include "../logging_p.hpp"
+
+class TestLogIndex: public QObject {
+	Q_OBJECT;
+
+private slots:
+	void initTestCase();
+	void tail_data();
+	void tail();
+	void timeRange_data();
+	void timeRange();
+
+private:
+	struct ReadResult {
+		qint64 start = -1;
+		QByteArrayList lines;
+	};
+
+	// Reads the log from the sync point chosen by LogReader.
+	ReadResult readIndexed(int tail, qs::log::LogQuery query);
+	// Reads the whole log sequentially, without the index.
+	ReadResult readSequential(int tail, qs::log::LogQuery query);
+
+	QTemporaryDir dir;
+	QString path;
+	QList<qs::log::LogSyncPoint> syncPoints;
+	// Number of displayed messages after the last sync point.
+	qsizetype lastSegmentCount = 0;
+	qsizetype totalCount = 0;
+};
@@ -0,0 +1,156 @@
+#include "logquery.hpp"
+#include <array>
+
+#include <qbuffer.h>
+#include <qbytearray.h>
+#include <qbytearraylist.h>
+#include <qdatetime.h>
+#include <qlatin1stringview.h>
+#include <qlist.h>
+#include <qlogging.h>
+#include <qregularexpression.h>
+#include <qstring.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+
+#include "../logging.hpp"
+#include "../logging_p.hpp"
+#include "../logging_qtprivate.hpp"
+
+using namespace qs::log;
+using qt_logging_registry::QLoggingRule;
+
+namespace {
+
+// Writes a log cycling through categories and levels. Every 8th message is a repeat so
+// recent message references are exercised, including references to skipped records.
+QByteArray createLog(qsizetype count) {
+	const auto categories = std::array<QLatin1StringView, 3> {
+	    QLatin1StringView("quickshell.test.a"),
+	    QLatin1StringView("quickshell.test.b"),
+	    QLatin1StringView("quickshell.test.noisy"),
+	};
+
+	const auto types = std::array<QtMsgType, 4> {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg};
+
+	QBuffer buffer;
+	buffer.open(QBuffer::WriteOnly);
+
+	EncodedLogWriter writer;
+	writer.setDevice(&buffer);
+	if (!writer.writeHeader()) return QByteArray();
+
+	auto start = QDateTime::fromSecsSinceEpoch(1735732800);
+
+	for (qsizetype i = 0; i != count; i++) {
+		auto body = i % 8 == 0 ? QByteArray("repeated message") : "message " + QByteArray::number(i);
+
+		auto message = LogMessage(
+		    types.at(i % 4),
+		    categories.at(i % 3),
+		    body,
+		    start.addMSecs(i * 10)
+		);
+
+		if (!writer.write(message)) return QByteArray();
+	}
+
+	return buffer.data();
+}
+
+LogQuery createQuery(const QString& pattern, bool timeRange) {
+	auto rules = QList<QLoggingRule> {
+	    QLoggingRule(u"quickshell.test.noisy", false),
+	    QLoggingRule(u"quickshell.test.a.debug", false),
+	};
+
+	if (!timeRange) return LogQuery(rules, QDateTime(), QDateTime(), QRegularExpression(pattern));
+
+	auto start = QDateTime::fromSecsSinceEpoch(1735732800);
+	return LogQuery(rules, start.addSecs(10), start.addSecs(50), QRegularExpression(pattern));
+}
+
+// Returns -1 on a read error.
+qsizetype readLog(const QByteArray& log, LogQuery& query, bool prefilter, QByteArrayList* lines) {
+	EncodedLogReader reader;
+	reader.setData(log.constData(), log.size());
+
+	bool readable = false;
+	quint8 logVersion = 0;
+	quint8 readerVersion = 0;
+	if (!reader.readHeader(&readable, &logVersion, &readerVersion) || !readable) return -1;
+
+	qsizetype count = 0;
+	LogMessage message;
+	while (reader.read(&message, prefilter ? &query : nullptr)) {
+		if (!query.accepts(reader, message)) continue;
+		count++;
+
+		if (lines) {
+			lines->append(
+			    QByteArray::number(message.time.toMSecsSinceEpoch()) + ' '
+			    + QByteArray::number(message.type) + ' ' + message.category.toString().toUtf8() + ' '
+			    + message.body
+			);
+		}
+	}
+
+	if (reader.streamPos() != log.size()) return -1;
+	return count;
+}
+
+} // namespace
+
+void TestLogQuery::initTestCase() {
+	this->largeLog = createLog(1000000);
+	QVERIFY(!this->largeLog.isEmpty());
+}
+
+void TestLogQuery::matchesFullDecode_data() { // NOLINT
+	QTest::addColumn<QString>("pattern");
+	QTest::addColumn<bool>("timeRange");
+
+	QTest::addRow("rules") << QString() << false;
+	QTest::addRow("time range") << QString() << true;
+	QTest::addRow("pattern") << QStringLiteral("^message [0-9]*5$") << true;
+	QTest::addRow("repeats") << QStringLiteral("repeated") << false;
+}
+
+void TestLogQuery::matchesFullDecode() {
+	QFETCH(QString, pattern);
+	QFETCH(bool, timeRange);
+
+	auto log = createLog(10000);
+	QVERIFY(!log.isEmpty());
+
+	auto fullQuery = createQuery(pattern, timeRange);
+	auto prefilterQuery = createQuery(pattern, timeRange);
+
+	QByteArrayList fullLines;
+	QByteArrayList prefilterLines;
+	auto fullCount = readLog(log, fullQuery, false, &fullLines);
+	auto prefilterCount = readLog(log, prefilterQuery, true, &prefilterLines);
+
+	QVERIFY(fullCount > 0);
+	QCOMPARE(prefilterCount, fullCount);
+	QCOMPARE(prefilterLines, fullLines);
+}
+
+void TestLogQuery::benchmarkFullDecode() {
+	auto query = createQuery(QString(), false);
+
+	QBENCHMARK {
+		QVERIFY(readLog(this->largeLog, query, false, nullptr) > 0);
+	}
+}
+
+void TestLogQuery::benchmarkQuery() {
+	auto query = createQuery(QString(), false);
+
+	QBENCHMARK {
+		QVERIFY(readLog(this->largeLog, query, true, nullptr) > 0);
+	}
+}
+
+QTEST_MAIN(TestLogQuery);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <qbytearray.h>
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+class TestLogQuery: public QObject {
+	Q_OBJECT;
+
+private slots:
+	void initTestCase();
+	void matchesFullDecode_data();
+	void matchesFullDecode();
+	void benchmarkFullDecode();
+	void benchmarkQuery();
+
+private:
+	QByteArray largeLog;
+};
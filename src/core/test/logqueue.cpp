@@ -0,0 +1,186 @@
+#include "logqueue.hpp"
+#include <array>
+#include <memory>
+
+#include <qbuffer.h>
+#include <qbytearray.h>
+#include <qbytearraylist.h>
+#include <qlatin1stringview.h>
+#include <qlist.h>
+#include <qlogging.h>
+#include <qstring.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qthread.h>
+#include <qtypes.h>
+
+#include "../logging.hpp"
+#include "../logging_p.hpp"
+
+using namespace qs::log;
+
+namespace {
+
+const auto CATEGORY = QLatin1StringView("quickshell.test");
+constexpr auto CAPACITY = static_cast<qsizetype>(LogQueue::CAPACITY);
+
+QString queuedBody(qsizetype i) { return QString("queued message %1").arg(i); }
+
+} // namespace
+
+void TestLogQueue::fill() {
+	auto queue = LogQueue(nullptr);
+	constexpr quint64 EXTRA = 10;
+
+	for (qsizetype i = 0; i != CAPACITY + static_cast<qsizetype>(EXTRA); i++) {
+		auto pushed = queue.push(QtInfoMsg, CATEGORY, queuedBody(i), true);
+		QCOMPARE(pushed, i < CAPACITY);
+	}
+
+	QCOMPARE(queue.dropped(), EXTRA);
+
+	// popping a slot frees it for the next push
+	auto* slot = queue.front();
+	QVERIFY(slot);
+	QCOMPARE(slot->body, queuedBody(0).toUtf8());
+	queue.pop();
+
+	QVERIFY(queue.push(QtWarningMsg, CATEGORY, queuedBody(-1), false));
+	QVERIFY(!queue.push(QtWarningMsg, CATEGORY, queuedBody(-2), false));
+	QCOMPARE(queue.dropped(), EXTRA + 1);
+
+	for (qsizetype i = 1; i != CAPACITY; i++) {
+		slot = queue.front();
+		QVERIFY(slot);
+		QCOMPARE(slot->type, QtInfoMsg);
+		QCOMPARE(slot->body, queuedBody(i).toUtf8());
+		queue.pop();
+	}
+
+	slot = queue.front();
+	QVERIFY(slot);
+	QCOMPARE(slot->type, QtWarningMsg);
+	QCOMPARE(slot->display, false);
+	QCOMPARE(slot->body, queuedBody(-1).toUtf8());
+	queue.pop();
+
+	QVERIFY(!queue.front());
+}
+
+void TestLogQueue::concurrentProducers() {
+	constexpr auto PRODUCERS = 4;
+	constexpr qsizetype MESSAGES = 20000;
+
+	auto queue = LogQueue(nullptr);
+	auto threads = std::array<std::unique_ptr<QThread>, PRODUCERS>();
+
+	for (auto i = 0; i != PRODUCERS; i++) {
+		threads.at(i).reset(QThread::create([&queue, i]() {
+			for (qsizetype n = 0; n != MESSAGES; n++) {
+				queue.push(QtInfoMsg, CATEGORY, QString("%1 %2").arg(i).arg(n), false);
+			}
+		}));
+
+		threads.at(i)->start();
+	}
+
+	auto lastSeen = std::array<qsizetype, PRODUCERS>();
+	lastSeen.fill(-1);
+	qsizetype received = 0;
+
+	auto producersRunning = [&]() {
+		for (const auto& thread: threads) {
+			if (!thread->isFinished()) return true;
+		}
+
+		return false;
+	};
+
+	// Read while producers run so slots are reused, then read whatever remains.
+	auto running = true;
+	while (running) {
+		running = producersRunning();
+
+		while (auto* slot = queue.front()) {
+			auto parts = slot->body.split(' ');
+			QCOMPARE(parts.length(), 2);
+
+			auto producer = parts.at(0).toInt();
+			auto n = parts.at(1).toLongLong();
+
+			// each producer's messages must arrive in order, with drops leaving gaps
+			QVERIFY(producer >= 0 && producer < PRODUCERS);
+			QVERIFY(n > lastSeen.at(producer));
+			lastSeen.at(producer) = n;
+
+			received++;
+			queue.pop();
+		}
+	}
+
+	for (const auto& thread: threads) {
+		thread->wait();
+	}
+
+	QCOMPARE(received + static_cast<qsizetype>(queue.dropped()), PRODUCERS * MESSAGES);
+}
+
+void TestLogQueue::drainBatches() {
+	auto logging = ThreadLogging(nullptr);
+	auto queue = LogQueue(&logging);
+	logging.queue = &queue;
+	logging.lineBuffers.resize(LogQueue::BATCH_SIZE);
+
+	QBuffer detailed;
+	QBuffer sparse;
+	QVERIFY(detailed.open(QBuffer::WriteOnly));
+	QVERIFY(sparse.open(QBuffer::WriteOnly));
+	logging.detailedWriter.setDevice(&detailed);
+	QVERIFY(logging.detailedWriter.writeHeader());
+	logging.fileStream.setDevice(&sparse);
+
+	QByteArrayList expected;
+
+	// Every 4th message repeats, so the writer keeps bodies for deduplication. Bodies
+	// reference slot buffers during the drain, and the second round reuses the same slots
+	// with different text, which would corrupt any body kept by reference.
+	auto pushRound = [&](const QString& prefix, qsizetype count) {
+		for (qsizetype i = 0; i != count; i++) {
+			auto body = i % 4 == 0 ? QString("repeated") : prefix + QString::number(i);
+			if (queue.push(QtInfoMsg, CATEGORY, body, i % 2 == 0)) {
+				expected.append(body.toUtf8());
+			}
+		}
+	};
+
+	pushRound("first ", CAPACITY + 5);
+	QCOMPARE(queue.dropped(), static_cast<quint64>(5));
+
+	logging.drainQueue();
+	QVERIFY(!queue.front());
+	expected.append("5 log messages were dropped as the log queue was full.");
+
+	pushRound("second ", LogQueue::BATCH_SIZE * 3);
+	logging.drainQueue();
+	QVERIFY(!queue.front());
+
+	auto log = detailed.data();
+	EncodedLogReader reader;
+	reader.setData(log.constData(), log.size());
+
+	bool readable = false;
+	quint8 logVersion = 0;
+	quint8 readerVersion = 0;
+	QVERIFY(reader.readHeader(&readable, &logVersion, &readerVersion) && readable);
+
+	QByteArrayList written;
+	LogMessage message;
+	while (reader.read(&message)) {
+		written.append(message.body);
+	}
+
+	QCOMPARE(reader.streamPos(), static_cast<qint64>(log.size()));
+	QCOMPARE(written, expected);
+}
+
+QTEST_MAIN(TestLogQueue);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+class TestLogQueue: public QObject {
+	Q_OBJECT;
+
+private slots:
+	static void fill();
+	static void concurrentProducers();
+	void drainBatches();
+};
@@ -0,0 +1,157 @@
+#include "objectmodel.hpp"
+#include <algorithm>
+
+#include <qabstractitemmodel.h>
+#include <qabstractitemmodeltester.h>
+#include <qlist.h>
+#include <qobject.h>
+#include <qrandom.h>
+#include <qstring.h>
+#include <qstringlist.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+
+#include "../model.hpp"
+
+namespace {
+
+constexpr qsizetype OBJECT_COUNT = 10000;
+
+QList<QObject*> objectsFor(const QList<QObject*>& objects, const QString& str) {
+	auto list = QList<QObject*>();
+	for (auto c: str) list.append(objects.at(c.unicode() - 'A'));
+	return list;
+}
+
+} // namespace
+
+void TestObjectModel::initTestCase() {
+	for (qsizetype i = 0; i != OBJECT_COUNT; i++) {
+		this->objects.append(new QObject());
+	}
+}
+
+void TestObjectModel::cleanupTestCase() { qDeleteAll(this->objects); }
+
+void TestObjectModel::diffUpdate_data() { // NOLINT
+	QTest::addColumn<QString>("oldstr");
+	QTest::addColumn<QString>("newstr");
+	QTest::addColumn<QStringList>("operations");
+
+	QTest::addRow("append") << "ABCD" << "ABCDEFG" << QStringList {"Insert(4, 3)"};
+	QTest::addRow("insert") << "ABFG" << "ABCDEFG" << QStringList {"Insert(2, 3)"};
+	QTest::addRow("remove_mid") << "ABCDEFG" << "ABFG" << QStringList {"Remove(2, 3)"};
+	QTest::addRow("move_range") << "ABCDEFG" << "ADEFBCG" << QStringList {"Move(3, 3, 1)"};
+	QTest::addRow("swap") << "ABC" << "CBA" << QStringList {"Move(2, 1, 0)", "Move(2, 1, 1)"};
+
+	QTest::addRow("mixed") << "ABCDEFG" << "XAFGBY"
+	                       << QStringList {
+	                              "Insert(0, 1)",  // XABCDEFG
+	                              "Move(6, 2, 2)", // XAFGBCDE
+	                              "Insert(5, 1)",  // XAFGBYCDE
+	                              "Remove(6, 3)",  // XAFGBY
+	                          };
+}
+
+void TestObjectModel::diffUpdate() {
+	QFETCH(const QString, oldstr);
+	QFETCH(const QString, newstr);
+	QFETCH(const QStringList, operations);
+
+	auto model = ObjectModel<QObject>(nullptr);
+	auto modelTester = QAbstractItemModelTester(&model);
+
+	model.diffUpdate(objectsFor(this->objects, oldstr));
+	QCOMPARE(model.valueList(), objectsFor(this->objects, oldstr));
+
+	auto actualOperations = QStringList();
+	QObject::connect(
+	    &model,
+	    &QAbstractItemModel::rowsInserted,
+	    &model,
+	    [&](const QModelIndex&, int first, int last) {
+		    actualOperations.append(QString("Insert(%1, %2)").arg(first).arg(last - first + 1));
+	    }
+	);
+
+	QObject::connect(
+	    &model,
+	    &QAbstractItemModel::rowsRemoved,
+	    &model,
+	    [&](const QModelIndex&, int first, int last) {
+		    actualOperations.append(QString("Remove(%1, %2)").arg(first).arg(last - first + 1));
+	    }
+	);
+
+	QObject::connect(
+	    &model,
+	    &QAbstractItemModel::rowsMoved,
+	    &model,
+	    [&](const QModelIndex&, int first, int last, const QModelIndex&, int dest) {
+		    actualOperations.append(
+		        QString("Move(%1, %2, %3)").arg(first).arg(last - first + 1).arg(dest)
+		    );
+	    }
+	);
+
+	model.diffUpdate(objectsFor(this->objects, newstr));
+	QCOMPARE(model.valueList(), objectsFor(this->objects, newstr));
+	QCOMPARE(actualOperations, operations);
+}
+
+void TestObjectModel::randomDiffUpdate() {
+	auto random = QRandomGenerator(1);
+	auto model = ObjectModel<QObject>(nullptr);
+	auto modelTester = QAbstractItemModelTester(&model);
+
+	auto pool = this->objects.sliced(0, 64);
+
+	for (auto i = 0; i != 500; i++) {
+		std::shuffle(pool.begin(), pool.end(), random);
+		auto newValues = pool.sliced(0, random.bounded(pool.length()));
+
+		model.diffUpdate(newValues);
+		QCOMPARE(model.valueList(), newValues);
+	}
+}
+
+void TestObjectModel::benchmarkPermutation() {
+	auto random = QRandomGenerator(1);
+	auto model = ObjectModel<QObject>(nullptr);
+	auto values = this->objects;
+
+	model.diffUpdate(values);
+
+	QBENCHMARK {
+		std::shuffle(values.begin(), values.end(), random);
+		model.diffUpdate(values);
+	}
+
+	QCOMPARE(model.valueList(), values);
+}
+
+void TestObjectModel::benchmarkSmallChange() {
+	auto random = QRandomGenerator(1);
+	auto model = ObjectModel<QObject>(nullptr);
+	auto values = this->objects.sliced(0, OBJECT_COUNT - 100);
+	auto spare = this->objects.sliced(OBJECT_COUNT - 100);
+
+	model.diffUpdate(values);
+
+	QBENCHMARK {
+		// swap a few objects in and out, and move one
+		for (auto i = 0; i != 5; i++) {
+			auto index = random.bounded(values.length());
+			auto spareIndex = random.bounded(spare.length());
+			std::swap(values[index], spare[spareIndex]);
+		}
+
+		values.move(random.bounded(values.length()), random.bounded(values.length()));
+		model.diffUpdate(values);
+	}
+
+	QCOMPARE(model.valueList(), values);
+}
+
+QTEST_MAIN(TestObjectModel);
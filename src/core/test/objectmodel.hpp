@@ -0,0 +1,21 @@
+#pragma once
+
+#include <qlist.h>
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+class TestObjectModel: public QObject {
+	Q_OBJECT;
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+	void diffUpdate_data();
+	void diffUpdate();
+	void randomDiffUpdate();
+	void benchmarkPermutation();
+	void benchmarkSmallChange();
+
+private:
+	QList<QObject*> objects;
+};
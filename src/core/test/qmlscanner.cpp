@@ -0,0 +1,220 @@
+#include "qmlscanner.hpp"
+#include <array>
+
+#include <fcntl.h>
+#include <qbytearray.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qlist.h>
+#include <qpair.h>
+#include <qstring.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+#include <qvector.h>
+#include <sys/stat.h>
+
+#include "../paths.hpp"
+#include "../scan.hpp"
+#include "../scancache.hpp"
+
+namespace {
+
+bool writeFile(const QString& path, const QByteArray& content) {
+	auto file = QFile(path);
+	if (!file.open(QFile::WriteOnly | QFile::Truncate)) return false;
+	return file.write(content) == content.length();
+}
+
+// Rewrites a file without changing its size or mtime, which the scan cache cannot detect.
+bool rewriteInPlace(const QString& path, const QByteArray& content) {
+	struct stat info {};
+	if (stat(path.toLocal8Bit().constData(), &info) != 0) return false;
+	if (info.st_size != content.length()) return false;
+	if (!writeFile(path, content)) return false;
+
+	auto times = std::array<timespec, 2> {info.st_atim, info.st_mtim};
+	return utimensat(AT_FDCWD, path.toLocal8Bit().constData(), times.data(), 0) == 0;
+}
+
+bool touch(const QString& path) {
+	// an explicit time, as the rewrite may land within the filesystem's timestamp granularity
+	auto time = timespec {.tv_sec = 1, .tv_nsec = 0};
+	auto times = std::array {time, time};
+	return utimensat(AT_FDCWD, path.toLocal8Bit().constData(), times.data(), 0) == 0;
+}
+
+// Same values the scanner uses to validate cache records.
+bool statFile(const QString& path, qint64* mtime, qint64* size) {
+	struct stat info {};
+	if (stat(path.toLocal8Bit().constData(), &info) != 0) return false;
+
+	*mtime = info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+	*size = info.st_size;
+	return true;
+}
+
+} // namespace
+
+void TestQmlScanner::initTestCase() {
+	QVERIFY(this->dir.isValid());
+	QsPaths::init("qmlscanner-test", "qmlscanner-test", "", "", this->dir.filePath("cache"));
+}
+
+QString TestQmlScanner::createConfig(
+    const QString& name,
+    const QList<QPair<QString, QByteArray>>& files
+) {
+	auto root = QDir(this->dir.filePath(name));
+	if (!root.mkpath(".")) return QString();
+
+	for (const auto& [path, content]: files) {
+		if (!root.mkpath(QFileInfo(root.filePath(path)).absolutePath())) return QString();
+		if (!writeFile(root.filePath(path), content)) return QString();
+	}
+
+	return root.canonicalPath();
+}
+
+void TestQmlScanner::cachedRecords() {
+	auto root = this->createConfig(
+	    "cached",
+	    {
+	        {"shell.qml", "import QtQuick\nItem {}\n"},
+	        {"Bar.qml", "pragma Singleton\nimport QtQuick\nQtObject {}\n"},
+	    }
+	);
+
+	QVERIFY(!root.isEmpty());
+	auto shell = QDir(root).filePath("shell.qml");
+	auto bar = QDir(root).filePath("Bar.qml");
+
+	{
+		auto scanner = QmlScanner(QDir(root));
+		scanner.scanQmlRoot(shell);
+		QVERIFY(scanner.scannedFiles.contains(bar));
+		QVERIFY(scanner.isSingleton(bar));
+	}
+
+	// Unchanged files are not read again, so a change the cache cannot see is not picked up.
+	QVERIFY(rewriteInPlace(bar, "pragma Singletom\nimport QtQuick\nQtObject {}\n"));
+
+	{
+		auto scanner = QmlScanner(QDir(root));
+		scanner.scanQmlRoot(shell);
+		QVERIFY(scanner.isSingleton(bar));
+	}
+
+	// Once the mtime changes the file is read again.
+	QVERIFY(touch(bar));
+
+	{
+		auto scanner = QmlScanner(QDir(root));
+		scanner.scanQmlRoot(shell);
+		QVERIFY(!scanner.isSingleton(bar));
+		QVERIFY(scanner.fileIntercepts.value(QDir(root).filePath("qmldir")).contains("\nBar 1.0"));
+	}
+}
+
+void TestQmlScanner::persistedRecords() {
+	auto root = this->createConfig(
+	    "persisted",
+	    {
+	        {"shell.qml", "import qs.module\nItem {}\n"},
+	        {"module/Foo.qml", "pragma Singleton\n//@ pragma Internal\nQtObject {}\n"},
+	        {"module/Removed.qml", "import QtQuick\nItem { Foo {} }\n"},
+	    }
+	);
+
+	QVERIFY(!root.isEmpty());
+	auto rootDir = QDir(root);
+	auto foo = rootDir.filePath("module/Foo.qml");
+	auto removed = rootDir.filePath("module/Removed.qml");
+
+	{
+		auto scanner = QmlScanner(rootDir);
+		scanner.scanQmlRoot(rootDir.filePath("shell.qml"));
+		QVERIFY(scanner.scannedFiles.contains(removed));
+	}
+
+	qint64 mtime = 0;
+	qint64 size = 0;
+
+	{
+		// a new instance reads the manifest written by the last scan
+		auto cache = QmlScanCache();
+		QVERIFY(statFile(foo, &mtime, &size));
+		const auto* record = cache.lookupFile(foo, mtime, size);
+		QVERIFY(record);
+		QVERIFY(record->singleton);
+		QVERIFY(record->internal);
+
+		QVERIFY(statFile(removed, &mtime, &size));
+		record = cache.lookupFile(removed, mtime, size);
+		QVERIFY(record);
+		QCOMPARE(record->typeRefs, QVector<QString>({"Foo", "Item"}));
+
+		auto module = rootDir.filePath("module");
+		QVERIFY(statFile(module, &mtime, &size));
+		const auto* files = cache.lookupDir(module, mtime);
+		QVERIFY(files);
+		QVERIFY(files->contains("Foo.qml"));
+		QVERIFY(files->contains("Removed.qml"));
+	}
+
+	// Records of files no longer part of the config are dropped.
+	QVERIFY(QFile::remove(removed));
+
+	{
+		auto scanner = QmlScanner(rootDir);
+		scanner.scanQmlRoot(rootDir.filePath("shell.qml"));
+		QVERIFY(!scanner.scannedFiles.contains(removed));
+	}
+
+	{
+		auto cache = QmlScanCache();
+		QVERIFY(!cache.files.contains(removed));
+		QVERIFY(cache.files.contains(foo));
+	}
+}
+
+void TestQmlScanner::parallelScan() {
+	constexpr auto FILE_COUNT = QmlScanner::PARALLEL_THRESHOLD * 3;
+
+	auto files = QList<QPair<QString, QByteArray>> {{"shell.qml", "import qs.many\nItem {}\n"}};
+
+	// every other file is a singleton, so results landing in the wrong slot are caught
+	for (auto i = 0; i != FILE_COUNT; i++) {
+		auto content = QByteArray(i % 2 == 0 ? "pragma Singleton\n" : "");
+		content += "import QtQuick\nQtObject { property int index: " + QByteArray::number(i) + " }\n";
+		files.append({QString("many/Item%1.qml").arg(i), content});
+	}
+
+	auto root = this->createConfig("parallel", files);
+	QVERIFY(!root.isEmpty());
+	auto rootDir = QDir(root);
+	auto many = QDir(rootDir.filePath("many"));
+
+	auto cold = QmlScanner(rootDir);
+	cold.scanQmlRoot(rootDir.filePath("shell.qml"));
+
+	for (auto i = 0; i != FILE_COUNT; i++) {
+		auto path = many.filePath(QString("Item%1.qml").arg(i));
+		QVERIFY(cold.scannedFiles.contains(path));
+		QCOMPARE(cold.isSingleton(path), i % 2 == 0);
+	}
+
+	// a scan served from the cache must produce the same results
+	auto warm = QmlScanner(rootDir);
+	warm.scanQmlRoot(rootDir.filePath("shell.qml"));
+
+	QCOMPARE(warm.scannedFiles, cold.scannedFiles);
+	QCOMPARE(warm.fileIntercepts, cold.fileIntercepts);
+
+	for (const auto& path: cold.scannedFiles) {
+		QCOMPARE(warm.isSingleton(path), cold.isSingleton(path));
+	}
+}
+
+QTEST_MAIN(TestQmlScanner);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <qbytearray.h>
+#include <qlist.h>
+#include <qobject.h>
+#include <qpair.h>
+#include <qstring.h>
+#include <qtemporarydir.h>
+#include <qtmetamacros.h>
+
+class TestQmlScanner: public QObject {
+	Q_OBJECT;
+
+private slots:
+	void initTestCase();
+	void cachedRecords();
+	void persistedRecords();
+	void parallelScan();
+
+private:
+	// Creates a config directory with the given files, returning its canonical path.
+	QString createConfig(const QString& name, const QList<QPair<QString, QByteArray>>& files);
+
+	QTemporaryDir dir;
+};
@@ -1,4 +1,5 @@
 #include "scriptmodel.hpp"
+#include <algorithm>
 
 #include <qabstractitemmodel.h>
 #include <qabstractitemmodeltester.h>
@@ -7,11 +8,13 @@
 #include <qlist.h>
 #include <qlogging.h>
 #include <qobject.h>
+#include <qrandom.h>
 #include <qsignalspy.h>
 #include <qstring.h>
 #include <qtest.h>
 #include <qtestcase.h>
 #include <qtypes.h>
+#include <qvariant.h>
 
 #include "../scriptmodel.hpp"
 
@@ -110,6 +113,26 @@ void TestScriptModel::unique_data() {
 	                                      {ModelOperation::Move, 4, 2, 2}, // ABEFCDG
 	                                      {ModelOperation::Insert, 4, 2},  // ABEFXYCDG
 	                                  });
+
+	// Duplicate values cannot be tracked by key and use a linear scan.
+
+	QTest::addRow("duplicate_inserted") << "BA" << "AAB"
+	                                    << OpList({
+	                                           {ModelOperation::Move, 1, 1, 0}, // AB
+	                                           {ModelOperation::Insert, 1, 1},  // AAB
+	                                       });
+
+	QTest::addRow("duplicate_removed") << "AAB" << "BA"
+	                                   << OpList({
+	                                          {ModelOperation::Move, 2, 1, 0}, // BAA
+	                                          {ModelOperation::Remove, 2, 1},  // BA
+	                                      });
+
+	QTest::addRow("duplicate_both") << "ABAB" << "BBAA"
+	                                << OpList({
+	                                       {ModelOperation::Move, 1, 1, 0}, // BAAB
+	                                       {ModelOperation::Move, 3, 1, 1}, // BBAA
+	                                   });
 }
 
 void TestScriptModel::unique() {
@@ -178,4 +201,101 @@ void TestScriptModel::unique() {
 	QCOMPARE_EQ(actualOperations, operations);
 }
 
+void TestScriptModel::objectPropPath() {
+	auto item = [](const QString& id, qint32 value) {
+		return QVariantMap {{"meta", QVariantMap {{"id", id}}}, {"value", value}};
+	};
+
+	auto model = ScriptModel();
+	auto modelTester = QAbstractItemModelTester(&model);
+	model.setObjectProp("meta.id");
+	model.setValues({item("a", 1), item("b", 1), item("c", 1)});
+
+	OpList actualOperations;
+
+	auto onMove = [&](const QModelIndex&,
+	                  int sourceStart,
+	                  int sourceEnd,
+	                  const QModelIndex&,
+	                  int dest) {
+		actualOperations << ModelOperation(
+		    ModelOperation::Move,
+		    sourceStart,
+		    sourceEnd - sourceStart + 1,
+		    dest
+		);
+	};
+
+	auto onInsert = [&](const QModelIndex&, int first, int last) {
+		actualOperations << ModelOperation(ModelOperation::Insert, first, last - first + 1);
+	};
+
+	auto onRemove = [&](const QModelIndex&, int first, int last) {
+		actualOperations << ModelOperation(ModelOperation::Remove, first, last - first + 1);
+	};
+
+	QObject::connect(&model, &QAbstractItemModel::rowsInserted, &model, onInsert);
+	QObject::connect(&model, &QAbstractItemModel::rowsRemoved, &model, onRemove);
+	QObject::connect(&model, &QAbstractItemModel::rowsMoved, &model, onMove);
+	auto changedSpy = QSignalSpy(&model, &QAbstractItemModel::dataChanged);
+
+	auto newValues = QVariantList {item("c", 1), item("a", 2), item("b", 1)};
+	model.setValues(newValues);
+
+	QVERIFY(model.values() == newValues);
+	QCOMPARE_EQ(actualOperations, OpList({{ModelOperation::Move, 2, 1, 0}}));
+	QCOMPARE_EQ(changedSpy.count(), 1);
+	QCOMPARE_EQ(changedSpy.at(0).at(0).value<QModelIndex>().row(), 1);
+	QCOMPARE_EQ(changedSpy.at(0).at(1).value<QModelIndex>().row(), 1);
+}
+
+void TestScriptModel::objectPropDuplicates() {
+	auto item = [](const QString& id, qint32 value) {
+		return QVariantMap {{"id", id}, {"value", value}};
+	};
+
+	auto model = ScriptModel();
+	auto modelTester = QAbstractItemModelTester(&model);
+	model.setObjectProp("id");
+	model.setValues({item("b", 1), item("a", 1)});
+
+	auto newValues = QVariantList {item("a", 2), item("a", 3), item("b", 1)};
+	model.setValues(newValues);
+	QVERIFY(model.values() == newValues);
+
+	newValues = QVariantList {item("b", 2), item("a", 3), item("b", 1), item("a", 1)};
+	model.setValues(newValues);
+	QVERIFY(model.values() == newValues);
+
+	newValues = QVariantList {item("a", 1)};
+	model.setValues(newValues);
+	QVERIFY(model.values() == newValues);
+}
+
+void TestScriptModel::benchmarkObjectProp() {
+	auto random = QRandomGenerator(1);
+	auto values = QVariantList();
+
+	for (auto i = 0; i != 5000; i++) {
+		values.append(QVariantMap {{"id", i}, {"name", QString("item %1").arg(i)}});
+	}
+
+	auto model = ScriptModel();
+	model.setObjectProp("id");
+	model.setValues(values);
+
+	auto nextId = 5000;
+
+	QBENCHMARK {
+		std::shuffle(values.begin(), values.end(), random);
+		// exercise inserts, removes and changes along with moves
+		values.removeLast();
+		values.append(QVariantMap {{"id", nextId++}, {"name", "new"}});
+		values[0] = QVariantMap {{"id", values.at(0).toMap().value("id")}, {"name", "changed"}};
+		model.setValues(values);
+	}
+
+	QVERIFY(model.values() == values);
+}
+
 QTEST_MAIN(TestScriptModel);
@@ -34,4 +34,7 @@ class TestScriptModel: public QObject {
 private slots:
 	static void unique_data(); // NOLINT
 	static void unique();
+	static void objectPropPath();
+	static void objectPropDuplicates();
+	static void benchmarkObjectProp();
 };
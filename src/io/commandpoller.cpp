@@ -0,0 +1,334 @@
+#include "commandpoller.hpp"
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include <qcontainerfwd.h>
+#include <qhash.h>
+#include <qlogging.h>
+#include <qloggingcategory.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qtimer.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "../core/generation.hpp"
+#include "../core/logcat.hpp"
+#include "datastream.hpp"
+#include "process.hpp"
+
+namespace {
+QS_LOGGING_CATEGORY(logCommandPoller, "quickshell.io.commandpoller", QtWarningMsg);
+
+// Runs are not started more often than this, regardless of the requested interval.
+constexpr qint32 MIN_INTERVAL = 10;
+
+QString jobKey(
+    const QList<QString>& command,
+    const QHash<QString, QVariant>& environment,
+    const QString& workingDirectory
+) {
+	auto key = command.join(QChar(0));
+	key += QChar(1);
+
+	auto names = environment.keys();
+	std::ranges::sort(names);
+
+	for (const auto& name: names) {
+		const auto& value = environment.value(name);
+		key += name;
+		// unset variables are distinct from empty ones
+		if (!value.isNull()) key += '=' + value.toString();
+		key += QChar(0);
+	}
+
+	key += QChar(1);
+	key += workingDirectory;
+	return key;
+}
+
+} // namespace
+
+CommandPollJob::CommandPollJob(
+    QString key,
+    const QList<QString>& command,
+    const QHash<QString, QVariant>& environment,
+    const QString& workingDirectory,
+    QObject* parent
+)
+    : QObject(parent)
+    , key(std::move(key))
+    , process(new Process(this))
+    , collector(new StdioCollector(this)) {
+	this->process->setFastSpawn(true);
+	this->process->setCommand(command);
+	this->process->setEnvironment(environment);
+	this->process->setWorkingDirectory(workingDirectory);
+	this->process->setStdoutParser(this->collector);
+	this->process->postReload();
+
+	QObject::connect(this->process, &Process::exited, this, &CommandPollJob::onExited);
+}
+
+void CommandPollJob::run() {
+	if (this->process->isRunning()) return;
+	this->process->setRunning(true);
+}
+
+bool CommandPollJob::isRunning() const { return this->process->isRunning(); }
+
+qint32 CommandPollJob::interval() const {
+	qint32 interval = -1;
+
+	for (auto* poller: this->pollers) {
+		if (!poller->isRunning()) continue;
+
+		auto pollerInterval = qMax(poller->interval(), MIN_INTERVAL);
+		if (interval == -1 || pollerInterval < interval) interval = pollerInterval;
+	}
+
+	return interval;
+}
+
+void CommandPollJob::onExited(qint32 exitCode) {
+	// Comparing the bytes directly is cheaper than hashing them, as a hash would
+	// also have to read the whole output, and the previous output is kept anyway.
+	auto output = this->collector->data();
+	auto outputChanged = !this->mHasOutput || output != this->outputBytes;
+	auto exitCodeChanged = !this->mHasOutput || exitCode != this->mExitCode;
+
+	this->mHasOutput = true;
+	this->mExitCode = exitCode;
+
+	if (outputChanged) {
+		this->outputBytes = std::move(output);
+		this->mOutput = QString::fromUtf8(this->outputBytes);
+		emit this->outputChanged();
+	}
+
+	if (exitCodeChanged) emit this->exitCodeChanged();
+}
+
+CommandPollerRegistry::CommandPollerRegistry() {
+	this->timer.setSingleShot(true);
+	this->timer.setTimerType(Qt::CoarseTimer);
+	QObject::connect(&this->timer, &QTimer::timeout, this, &CommandPollerRegistry::onTimeout);
+}
+
+CommandPollerRegistry* CommandPollerRegistry::forGeneration(EngineGeneration* generation) {
+	if (!generation) {
+		static auto* registry = new CommandPollerRegistry(); // NOLINT
+		return registry;
+	}
+
+	static const int key = 0;
+	auto* ext = generation->findExtension(&key);
+
+	if (!ext) {
+		ext = new CommandPollerRegistry();
+		generation->registerExtension(&key, ext);
+	}
+
+	return dynamic_cast<CommandPollerRegistry*>(ext);
+}
+
+qint64 CommandPollerRegistry::now() {
+	auto time = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::milliseconds>(time).count();
+}
+
+CommandPollJob* CommandPollerRegistry::subscribe(
+    CommandPoller* poller,
+    const QList<QString>& command,
+    const QHash<QString, QVariant>& environment,
+    const QString& workingDirectory
+) {
+	auto key = jobKey(command, environment, workingDirectory);
+	auto* job = this->jobs.value(key);
+
+	if (!job) {
+		qCDebug(logCommandPoller) << "Creating poll job for" << command;
+		job = new CommandPollJob(key, command, environment, workingDirectory, this);
+		this->jobs.insert(key, job);
+	}
+
+	job->pollers.append(poller);
+
+	// New pollers should not have to wait a full interval for their first output.
+	if (!job->hasOutput() && poller->isRunning()) job->run();
+
+	this->reschedule(job);
+	return job;
+}
+
+void CommandPollerRegistry::unsubscribe(CommandPoller* poller, CommandPollJob* job) {
+	job->pollers.removeOne(poller);
+
+	if (job->pollers.isEmpty()) {
+		qCDebug(logCommandPoller) << "Removing unused poll job" << job;
+		this->jobs.remove(job->key);
+		// may be called from a handler of one of the job's signals
+		job->deleteLater();
+	}
+
+	this->schedule();
+}
+
+void CommandPollerRegistry::reschedule(CommandPollJob* job) {
+	auto interval = job->interval();
+
+	if (interval != -1) {
+		// Aligning runs to multiples of their interval makes pollers with the same or
+		// evenly dividing intervals wake up together, instead of at their own offsets.
+		auto time = CommandPollerRegistry::now();
+		job->nextRun = (time / interval + 1) * interval;
+	}
+
+	this->schedule();
+}
+
+void CommandPollerRegistry::schedule() {
+	qint64 next = -1;
+
+	for (auto* job: this->jobs) {
+		if (job->interval() == -1) continue;
+		if (next == -1 || job->nextRun < next) next = job->nextRun;
+	}
+
+	if (next == -1) {
+		this->timer.stop();
+		return;
+	}
+
+	// never more than the longest interval
+	auto delay = qMax(next - CommandPollerRegistry::now(), static_cast<qint64>(0));
+	this->timer.start(static_cast<qint32>(delay));
+}
+
+void CommandPollerRegistry::onTimeout() {
+	auto time = CommandPollerRegistry::now();
+
+	for (auto* job: this->jobs) {
+		auto interval = job->interval();
+		if (interval == -1) continue;
+
+		// Coarse timers may fire a few percent early. Jobs due within that window run
+		// now so they share this wakeup instead of scheduling another one.
+		if (job->nextRun - time > interval / 20) continue;
+
+		// a run that outlives its interval is not doubled up
+		job->run();
+		job->nextRun = (time / interval + 1) * interval;
+		if (job->nextRun - time <= interval / 20) job->nextRun += interval;
+	}
+
+	this->schedule();
+}
+
+CommandPoller::~CommandPoller() { this->unsubscribe(); }
+
+void CommandPoller::onPostReload() {
+	this->registry = CommandPollerRegistry::forGeneration(
+	    EngineGeneration::findObjectGeneration(this)
+	);
+
+	this->resubscribe();
+}
+
+void CommandPoller::resubscribe() {
+	if (!this->isPostReload || !this->registry) return;
+
+	auto oldOutput = this->output();
+	auto oldExitCode = this->exitCode();
+	auto oldJob = this->job;
+	this->job = nullptr;
+
+	if (!this->mCommand.isEmpty()) {
+		auto command = this->mCommand;
+
+		// Jobs are shared between objects, so paths relative to the shell root are
+		// resolved before they are compared.
+		auto& cmd = command.first();
+		if (cmd.startsWith("root://")) {
+			if (auto* generation = EngineGeneration::findObjectGeneration(this)) {
+				cmd = cmd.sliced(7);
+				cmd = generation->rootPath.filePath(cmd.startsWith('/') ? cmd.sliced(1) : cmd);
+			}
+		}
+
+		// subscribed before the old job is released so an unchanged job is kept alive
+		auto* job =
+		    this->registry->subscribe(this, command, this->mEnvironment, this->mWorkingDirectory);
+
+		QObject::connect(job, &CommandPollJob::outputChanged, this, &CommandPoller::outputChanged);
+		QObject::connect(job, &CommandPollJob::exitCodeChanged, this, &CommandPoller::exitCodeChanged);
+		this->job = job;
+	}
+
+	if (oldJob) {
+		QObject::disconnect(oldJob, nullptr, this, nullptr);
+		this->registry->unsubscribe(this, oldJob);
+	}
+
+	if (this->output() != oldOutput) emit this->outputChanged();
+	if (this->exitCode() != oldExitCode) emit this->exitCodeChanged();
+}
+
+void CommandPoller::unsubscribe() {
+	// The registry and its jobs are destroyed with the engine generation, which may
+	// happen before this poller is destroyed.
+	if (this->registry && this->job) {
+		QObject::disconnect(this->job, nullptr, this, nullptr);
+		this->registry->unsubscribe(this, this->job);
+	}
+
+	this->job = nullptr;
+}
+
+void CommandPoller::refresh() {
+	if (this->job) this->job->run();
+}
+
+QString CommandPoller::output() const { return this->job ? this->job->output() : QString(); }
+qint32 CommandPoller::exitCode() const { return this->job ? this->job->exitCode() : 0; }
+
+void CommandPoller::setCommand(QList<QString> command) {
+	if (command == this->mCommand) return;
+	this->mCommand = std::move(command);
+	emit this->commandChanged();
+	this->resubscribe();
+}
+
+void CommandPoller::setEnvironment(QHash<QString, QVariant> environment) {
+	if (environment == this->mEnvironment) return;
+	this->mEnvironment = std::move(environment);
+	emit this->environmentChanged();
+	this->resubscribe();
+}
+
+void CommandPoller::setWorkingDirectory(QString workingDirectory) {
+	if (workingDirectory == this->mWorkingDirectory) return;
+	this->mWorkingDirectory = std::move(workingDirectory);
+	emit this->workingDirectoryChanged();
+	this->resubscribe();
+}
+
+void CommandPoller::setInterval(qint32 interval) {
+	if (interval == this->mInterval) return;
+	this->mInterval = interval;
+	emit this->intervalChanged();
+	if (this->registry && this->job) this->registry->reschedule(this->job);
+}
+
+void CommandPoller::setRunning(bool running) {
+	if (running == this->mRunning) return;
+	this->mRunning = running;
+	emit this->runningChanged();
+
+	if (this->registry && this->job) {
+		if (running && !this->job->hasOutput()) this->job->run();
+		this->registry->reschedule(this->job);
+	}
+}
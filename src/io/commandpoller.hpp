@@ -0,0 +1,194 @@
+#pragma once
+
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
+#include <qhash.h>
+#include <qobject.h>
+#include <qpointer.h>
+#include <qqmlintegration.h>
+#include <qtimer.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "../core/generation.hpp"
+#include "../core/reload.hpp"
+
+class Process;
+class StdioCollector;
+
+class CommandPoller;
+
+// A command shared by every CommandPoller with the same command, environment
+// and working directory.
+class CommandPollJob: public QObject {
+	Q_OBJECT;
+
+public:
+	explicit CommandPollJob(
+	    QString key,
+	    const QList<QString>& command,
+	    const QHash<QString, QVariant>& environment,
+	    const QString& workingDirectory,
+	    QObject* parent = nullptr
+	);
+
+	void run();
+
+	[[nodiscard]] bool isRunning() const;
+	[[nodiscard]] bool hasOutput() const { return this->mHasOutput; }
+	[[nodiscard]] QString output() const { return this->mOutput; }
+	[[nodiscard]] qint32 exitCode() const { return this->mExitCode; }
+
+	// the smallest interval of all running pollers, or -1 if none are running
+	[[nodiscard]] qint32 interval() const;
+
+	QString key;
+	QList<CommandPoller*> pollers;
+	// aligned time of the next run, in milliseconds of the steady clock
+	qint64 nextRun = 0;
+
+signals:
+	// Emitted when a run finishes with output that differs from the previous run.
+	void outputChanged();
+	void exitCodeChanged();
+
+private slots:
+	void onExited(qint32 exitCode);
+
+private:
+	Process* process = nullptr;
+	StdioCollector* collector = nullptr;
+	QByteArray outputBytes;
+	QString mOutput;
+	qint32 mExitCode = 0;
+	bool mHasOutput = false;
+};
+
+class CommandPollerRegistry
+    : public QObject
+    , public EngineGenerationExt {
+	Q_OBJECT;
+
+public:
+	CommandPollerRegistry();
+
+	// Objects outside of an engine generation share a global registry.
+	static CommandPollerRegistry* forGeneration(EngineGeneration* generation);
+
+	CommandPollJob* subscribe(
+	    CommandPoller* poller,
+	    const QList<QString>& command,
+	    const QHash<QString, QVariant>& environment,
+	    const QString& workingDirectory
+	);
+	void unsubscribe(CommandPoller* poller, CommandPollJob* job);
+	// Reschedules a job after the interval of one of its pollers changed.
+	void reschedule(CommandPollJob* job);
+
+	[[nodiscard]] qsizetype jobCount() const { return this->jobs.size(); }
+
+private slots:
+	void onTimeout();
+
+private:
+	void schedule();
+	static qint64 now();
+
+	QHash<QString, CommandPollJob*> jobs;
+	QTimer timer;
+};
+
+///! Runs a command periodically, sharing runs with identical pollers.
+/// Runs @@command every @@interval milliseconds and exposes its output.
+///
+/// Unlike a @@Process started by a @@QtQml.Timer, every CommandPoller with the same
+/// command, environment and working directory shares a single process,
+/// even across @@Quickshell.Variants instances. The command runs at the shortest interval
+/// of the running pollers sharing it, and runs of different commands are aligned
+/// so they wake up quickshell together.
+///
+/// @@outputChanged(s) is only emitted when the output differs from the previous run.
+///
+/// ```qml
+/// CommandPoller {
+///   id: brightness
+///   command: [ "brightnessctl", "get" ]
+///   interval: 2000
+/// }
+///
+/// Text { text: brightness.output }
+/// ```
+class CommandPoller: public PostReloadHook {
+	Q_OBJECT;
+	// clang-format off
+	/// The command to run. See @@Process.command.
+	Q_PROPERTY(QList<QString> command READ command WRITE setCommand NOTIFY commandChanged);
+	/// Changes to the environment of the command. See @@Process.environment.
+	Q_PROPERTY(QHash<QString, QVariant> environment READ environment WRITE setEnvironment NOTIFY environmentChanged);
+	/// The working directory of the command. See @@Process.workingDirectory.
+	Q_PROPERTY(QString workingDirectory READ workingDirectory WRITE setWorkingDirectory NOTIFY workingDirectoryChanged);
+	/// The time between runs in milliseconds. Defaults to 1000.
+	///
+	/// If other pollers of the same command have a shorter interval, it runs at that interval.
+	Q_PROPERTY(qint32 interval READ interval WRITE setInterval NOTIFY intervalChanged);
+	/// If the command should be run periodically. Defaults to true.
+	Q_PROPERTY(bool running READ isRunning WRITE setRunning NOTIFY runningChanged);
+	/// The stdout of the last finished run of the command.
+	Q_PROPERTY(QString output READ output NOTIFY outputChanged);
+	/// The exit code of the last finished run of the command.
+	Q_PROPERTY(qint32 exitCode READ exitCode NOTIFY exitCodeChanged);
+	// clang-format on
+	QML_ELEMENT;
+
+public:
+	explicit CommandPoller(QObject* parent = nullptr): PostReloadHook(parent) {}
+	~CommandPoller() override;
+	Q_DISABLE_COPY_MOVE(CommandPoller);
+
+	void onPostReload() override;
+
+	/// Runs the command now, unless it is already running.
+	Q_INVOKABLE void refresh();
+
+	[[nodiscard]] QList<QString> command() const { return this->mCommand; }
+	void setCommand(QList<QString> command);
+
+	[[nodiscard]] QHash<QString, QVariant> environment() const { return this->mEnvironment; }
+	void setEnvironment(QHash<QString, QVariant> environment);
+
+	[[nodiscard]] QString workingDirectory() const { return this->mWorkingDirectory; }
+	void setWorkingDirectory(QString workingDirectory);
+
+	[[nodiscard]] qint32 interval() const { return this->mInterval; }
+	void setInterval(qint32 interval);
+
+	[[nodiscard]] bool isRunning() const { return this->mRunning; }
+	void setRunning(bool running);
+
+	[[nodiscard]] QString output() const;
+	[[nodiscard]] qint32 exitCode() const;
+
+signals:
+	void commandChanged();
+	void environmentChanged();
+	void workingDirectoryChanged();
+	void intervalChanged();
+	void runningChanged();
+	void outputChanged();
+	void exitCodeChanged();
+
+private:
+	void resubscribe();
+	void unsubscribe();
+
+	QList<QString> mCommand;
+	QHash<QString, QVariant> mEnvironment;
+	QString mWorkingDirectory;
+	qint32 mInterval = 1000;
+	bool mRunning = true;
+
+	QPointer<CommandPollerRegistry> registry;
+	// Cleared if the registry is destroyed before this poller.
+	QPointer<CommandPollJob> job;
+};
@@ -1,11 +1,16 @@
 #include "datastream.hpp"
 #include <algorithm>
+#include <cstring>
 #include <utility>
 
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
 #include <qlocalsocket.h>
 #include <qobject.h>
+#include <qstring.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
+#include <qvariant.h>
 
 DataStreamParser* DataStream::reader() const { return this->mReader; }
 
@@ -20,6 +25,7 @@ void DataStream::setReader(DataStreamParser* reader) {
 
 	if (reader != nullptr) {
 		QObject::connect(reader, &QObject::destroyed, this, &DataStream::onReaderDestroyed);
+		QObject::connect(reader, &DataStreamParser::readyForData, this, &DataStream::onBytesAvailable);
 	}
 
 	emit this->readerChanged();
@@ -35,19 +41,36 @@ void DataStream::onReaderDestroyed() {
 }
 
 void DataStream::onBytesAvailable() {
-	if (this->mReader == nullptr) return;
+	// unread data is left in the device until the reader catches up
+	if (this->mReader == nullptr || this->mReader->isBusy()) return;
 	auto buf = this->ioDevice()->readAll();
 	this->mReader->parseBytes(buf, this->buffer);
 }
 
+namespace {
+
+const char* findMarker(const char* data, qsizetype length, const QByteArray& marker) {
+	if (marker.length() == 1) {
+		return static_cast<const char*>(memchr(data, marker.at(0), length));
+	}
+
+	return static_cast<const char*>(memmem(data, length, marker.constData(), marker.length()));
+}
+
+} // namespace
+
 void SplitParser::parseBytes(QByteArray& incoming, QByteArray& buffer) {
-	if (this->mSplitMarker.isEmpty()) {
+	auto batch = QVariantList();
+	auto* batchPtr = this->mBatch ? &batch : nullptr;
+
+	if (this->mMarkerBytes.isEmpty()) {
 		if (!buffer.isEmpty()) {
-			emit this->read(QString(buffer));
+			this->emitChunk(buffer.constData(), buffer.length(), batchPtr);
 			buffer.clear();
 		}
 
-		emit this->read(QString(incoming));
+		if (&incoming != &buffer) this->emitChunk(incoming.constData(), incoming.length(), batchPtr);
+		this->emitBatch(batch);
 		return;
 	}
 
@@ -57,49 +80,70 @@ void SplitParser::parseBytes(QByteArray& incoming, QByteArray& buffer) {
 		this->parseBytes(buffer, buffer);
 	}
 
-	auto marker = this->mSplitMarker.toUtf8();
+	// Copied in case a handler changes the marker while parsing.
+	auto marker = this->mMarkerBytes;
 	auto mlen = marker.length();
 
-	auto blen = buffer.size();
-	auto ilen = incoming.size();
+	// Incoming data is searched in place unless part of a chunk is already buffered.
+	qsizetype searchStart = 0;
+	auto inBuffer = &incoming == &buffer || !buffer.isEmpty();
 
-	qsizetype start = &incoming == &buffer ? 0 : -blen;
-	for (auto readi = -std::min(blen, mlen - 1); readi <= ilen - mlen; readi++) {
-		for (auto marki = 0; marki < mlen; marki++) {
-			qint8 byte; // NOLINT
-			if (readi + marki < 0) byte = buffer[blen + readi + marki];
-			else byte = incoming[readi + marki];
+	if (&incoming != &buffer && !buffer.isEmpty()) {
+		searchStart = std::max(static_cast<qsizetype>(0), buffer.length() - (mlen - 1));
+		buffer.append(incoming);
+	}
 
-			if (byte != marker[marki]) goto fail;
-		}
+	const auto& data = inBuffer ? buffer : incoming;
+	const auto* begin = data.constData();
+	const auto* end = begin + data.length(); // NOLINT
+	const auto* start = begin;
 
-		{
-			QByteArray slice;
-			if (start < 0) slice = buffer.sliced(0, std::min(blen, blen + readi));
-			if (readi > 0) {
-				auto sstart = std::max(static_cast<qsizetype>(0), start);
-				slice.append(incoming.sliced(sstart, readi - sstart));
-			}
-			readi += mlen;
-			start = readi;
-			emit this->read(QString(slice));
-		}
+	// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	for (const auto* searchFrom = begin + searchStart; searchFrom < end;) {
+		const auto* match = findMarker(searchFrom, end - searchFrom, marker);
+		if (match == nullptr) break;
 
-	fail:;
+		this->emitChunk(start, match - start, batchPtr);
+		start = match + mlen;
+		searchFrom = start;
 	}
+	// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
 
-	if (start < 0) {
-		buffer.append(incoming);
+	auto consumed = start - begin;
+
+	if (inBuffer) {
+		buffer.remove(0, consumed);
+	} else if (consumed == 0) {
+		buffer = incoming;
 	} else {
-		// Will break the init case if inlined. Must be before clear.
-		auto slice = incoming.sliced(start);
-		buffer.clear();
-		buffer.insert(0, slice);
+		buffer = incoming.sliced(consumed);
+	}
+
+	this->emitBatch(batch);
+}
+
+void SplitParser::emitChunk(const char* data, qsizetype length, QVariantList* batch) {
+	if (this->mBytes) {
+		auto bytes = QByteArray(data, length);
+		if (batch) batch->append(bytes);
+		else emit this->readBytes(bytes);
+	} else {
+		auto string = QString::fromUtf8(data, length);
+		if (batch) batch->append(string);
+		else emit this->read(string);
 	}
 }
 
+void SplitParser::emitBatch(QVariantList& batch) {
+	if (!batch.isEmpty()) emit this->readBatch(batch);
+}
+
 void SplitParser::streamEnded(QByteArray& buffer) {
-	if (!buffer.isEmpty()) emit this->read(QString(buffer));
+	if (buffer.isEmpty()) return;
+
+	auto batch = QVariantList();
+	this->emitChunk(buffer.constData(), buffer.length(), this->mBatch ? &batch : nullptr);
+	this->emitBatch(batch);
 }
 
 QString SplitParser::splitMarker() const { return this->mSplitMarker; }
@@ -108,12 +152,122 @@ void SplitParser::setSplitMarker(QString marker) {
 	if (marker == this->mSplitMarker) return;
 
 	this->mSplitMarker = std::move(marker);
+	this->mMarkerBytes = this->mSplitMarker.toUtf8();
 	this->mSplitMarkerChanged = true;
 	emit this->splitMarkerChanged();
 }
 
+void SplitParser::setBytes(bool bytes) {
+	if (bytes == this->mBytes) return;
+	this->mBytes = bytes;
+	emit this->bytesChanged();
+}
+
+void SplitParser::setBatch(bool batch) {
+	if (batch == this->mBatch) return;
+	this->mBatch = batch;
+	emit this->batchChanged();
+}
+
+void ByteRingBuffer::setCapacity(qsizetype capacity) {
+	if (capacity == this->mCapacity) return;
+
+	auto data = this->toByteArray();
+	this->storage.clear();
+	this->mCapacity = capacity;
+	this->start = 0;
+	this->mSize = 0;
+	this->append(data);
+}
+
+qsizetype ByteRingBuffer::append(const QByteArray& data) {
+	auto capacity = this->mCapacity;
+	auto length = data.size();
+	if (capacity == 0 || length == 0) return length;
+
+	// Storage grows as needed until the first wraparound, so large capacities are not
+	// allocated for small outputs.
+	if (this->start == 0 && this->mSize + length <= capacity) {
+		this->storage.truncate(this->mSize);
+		this->storage.append(data);
+		this->mSize += length;
+		return 0;
+	}
+
+	this->storage.resize(capacity);
+	auto* storage = this->storage.data();
+	const auto* src = data.constData();
+
+	if (length >= capacity) {
+		auto dropped = this->mSize + length - capacity;
+		std::memcpy(storage, src + length - capacity, capacity); // NOLINT
+		this->start = 0;
+		this->mSize = capacity;
+		return dropped;
+	}
+
+	auto dropped = std::max(static_cast<qsizetype>(0), this->mSize + length - capacity);
+	this->start = (this->start + dropped) % capacity;
+	this->mSize -= dropped;
+
+	auto end = (this->start + this->mSize) % capacity;
+	auto first = std::min(length, capacity - end);
+	std::memcpy(storage + end, src, first);            // NOLINT
+	std::memcpy(storage, src + first, length - first); // NOLINT
+	this->mSize += length;
+
+	return dropped;
+}
+
+void ByteRingBuffer::clear() {
+	this->storage.clear();
+	this->start = 0;
+	this->mSize = 0;
+}
+
+QByteArray ByteRingBuffer::toByteArray() const {
+	if (this->mSize == 0) return QByteArray();
+
+	const auto* storage = this->storage.constData();
+	auto first = std::min(this->mSize, this->mCapacity - this->start);
+
+	auto data = QByteArray(this->mSize, Qt::Uninitialized);
+	std::memcpy(data.data(), storage + this->start, first);          // NOLINT
+	std::memcpy(data.data() + first, storage, this->mSize - first); // NOLINT
+	return data;
+}
+
 void StdioCollector::parseBytes(QByteArray& incoming, QByteArray& buffer) {
-	buffer.append(incoming);
+	if (this->streamDone) {
+		this->streamDone = false;
+
+		if (this->mDroppedBytes != 0) {
+			this->mDroppedBytes = 0;
+			emit this->droppedBytesChanged();
+		}
+	}
+
+	if (this->mMaxBytes != 0) {
+		// data buffered before maxBytes was set
+		if (&incoming != &buffer && !buffer.isEmpty()) this->appendBounded(buffer);
+		this->appendBounded(incoming);
+		buffer.clear();
+
+		if (!this->mWaitForEnd) {
+			this->mData = this->ring.toByteArray();
+			emit this->dataChanged();
+		}
+
+		return;
+	}
+
+	this->takeBounded(buffer);
+
+	if (&incoming != &buffer) {
+		// drop the shared copy first so appending does not copy the whole buffer
+		if (!this->mWaitForEnd) this->mData.clear();
+		buffer.append(incoming);
+	}
 
 	if (!this->mWaitForEnd) {
 		this->mData = buffer;
@@ -122,14 +276,51 @@ void StdioCollector::parseBytes(QByteArray& incoming, QByteArray& buffer) {
 }
 
 void StdioCollector::streamEnded(QByteArray& buffer) {
-	if (this->mWaitForEnd) {
+	if (this->mMaxBytes != 0) {
+		if (!buffer.isEmpty()) this->appendBounded(buffer);
+		buffer.clear();
+
+		this->mData = this->ring.toByteArray();
+		this->ring.clear();
+		emit this->dataChanged();
+	} else if (this->takeBounded(buffer) || this->mWaitForEnd) {
 		this->mData = buffer;
 		emit this->dataChanged();
 	}
 
+	this->streamDone = true;
 	emit this->streamFinished();
 }
 
+void StdioCollector::appendBounded(const QByteArray& data) {
+	auto dropped = this->ring.append(data);
+	if (dropped == 0) return;
+
+	auto first = this->mDroppedBytes == 0;
+	this->mDroppedBytes += dropped;
+	emit this->droppedBytesChanged();
+
+	if (first) emit this->overflowed();
+}
+
+bool StdioCollector::takeBounded(QByteArray& buffer) {
+	// maxBytes was unset during the stream
+	if (this->ring.isEmpty()) return false;
+
+	buffer.prepend(this->ring.toByteArray());
+	this->ring.clear();
+	return true;
+}
+
+void StdioCollector::setMaxBytes(qint64 maxBytes) {
+	maxBytes = std::max(maxBytes, static_cast<qint64>(0));
+	if (maxBytes == this->mMaxBytes) return;
+
+	this->mMaxBytes = maxBytes;
+	if (maxBytes != 0) this->ring.setCapacity(maxBytes);
+	emit this->maxBytesChanged();
+}
+
 void StdioCollector::setWaitForEnd(bool waitForEnd) {
 	if (waitForEnd == this->mWaitForEnd) return;
 	this->mWaitForEnd = waitForEnd;
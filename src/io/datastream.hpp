@@ -6,6 +6,7 @@
 #include <qobject.h>
 #include <qqmlintegration.h>
 #include <qtmetamacros.h>
+#include <qtypes.h>
 #include <qvariant.h>
 
 class DataStreamParser;
@@ -57,13 +58,45 @@ public:
 	virtual void parseBytes(QByteArray& incoming, QByteArray& buffer) = 0;
 	virtual void streamEnded(QByteArray& /*buffer*/) {}
 
+	// Returns true if the parser is not keeping up with the stream. Streams stop reading
+	// from their source while the parser is busy, and resume when readyForData is emitted.
+	[[nodiscard]] virtual bool isBusy() const { return false; }
+
 signals:
 	/// Emitted when data is read from the stream.
 	void read(QString data);
+	// Emitted when a busy parser can accept data again.
+	void readyForData();
+};
+
+// Fixed capacity byte buffer keeping the most recently appended bytes.
+class ByteRingBuffer {
+public:
+	// Resizes the buffer, keeping the most recent bytes that fit.
+	void setCapacity(qsizetype capacity);
+	[[nodiscard]] qsizetype capacity() const { return this->mCapacity; }
+	[[nodiscard]] qsizetype size() const { return this->mSize; }
+	[[nodiscard]] bool isEmpty() const { return this->mSize == 0; }
+
+	// Returns the number of bytes discarded, including bytes of data that did not fit.
+	qsizetype append(const QByteArray& data);
+	void clear();
+
+	// Returns the stored bytes, oldest first.
+	[[nodiscard]] QByteArray toByteArray() const;
+
+private:
+	QByteArray storage;
+	qsizetype mCapacity = 0;
+	qsizetype start = 0;
+	qsizetype mSize = 0;
 };
 
 ///! DataStreamParser for delimited data streams.
 /// DataStreamParser for delimited data streams. @@DataStreamParser.read(s) is emitted once per delimited chunk of the stream.
+///
+/// For high volume streams, @@bytes skips decoding chunks as text and @@batch
+/// reduces the number of signals emitted to one per read from the stream.
 class SplitParser: public DataStreamParser {
 	Q_OBJECT;
 	/// The delimiter for parsed data. May be multiple characters. Defaults to `\n`.
@@ -71,6 +104,14 @@ class SplitParser: public DataStreamParser {
 	/// If the delimiter is empty read lengths may be arbitrary (whatever is returned by the
 	/// underlying read call.)
 	Q_PROPERTY(QString splitMarker READ splitMarker WRITE setSplitMarker NOTIFY splitMarkerChanged);
+	/// If true, chunks are emitted as [ArrayBuffer]s through @@readBytes(s) instead of
+	/// being decoded as text and emitted through @@DataStreamParser.read(s). Defaults to false.
+	///
+	/// [ArrayBuffer]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/ArrayBuffer
+	Q_PROPERTY(bool bytes READ bytes WRITE setBytes NOTIFY bytesChanged);
+	/// If true, all chunks found in a single read from the stream are emitted together through
+	/// @@readBatch(s) instead of one signal per chunk. Defaults to false.
+	Q_PROPERTY(bool batch READ batch WRITE setBatch NOTIFY batchChanged);
 	QML_ELEMENT;
 
 public:
@@ -82,16 +123,39 @@ public:
 	[[nodiscard]] QString splitMarker() const;
 	void setSplitMarker(QString marker);
 
+	[[nodiscard]] bool bytes() const { return this->mBytes; }
+	void setBytes(bool bytes);
+
+	[[nodiscard]] bool batch() const { return this->mBatch; }
+	void setBatch(bool batch);
+
 signals:
 	void splitMarkerChanged();
+	void bytesChanged();
+	void batchChanged();
+	/// Emitted once per delimited chunk of the stream if @@bytes is true and @@batch is false.
+	void readBytes(QByteArray data);
+	/// Emitted once per read from the stream containing at least one delimited chunk
+	/// if @@batch is true. Chunks are strings, or [ArrayBuffer]s if @@bytes is true.
+	///
+	/// [ArrayBuffer]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/ArrayBuffer
+	void readBatch(QVariantList data);
 
 private:
+	void emitChunk(const char* data, qsizetype length, QVariantList* batch);
+	void emitBatch(QVariantList& batch);
+
 	QString mSplitMarker = "\n";
+	QByteArray mMarkerBytes = "\n";
 	bool mSplitMarkerChanged = false;
+	bool mBytes = false;
+	bool mBatch = false;
 };
 
 ///! DataStreamParser that collects all output into a buffer
 /// StdioCollector collects all process output into a buffer exposed as @@text or @@data.
+///
+/// For long running or chatty commands, set @@maxBytes to only keep the end of the output.
 class StdioCollector: public DataStreamParser {
 	Q_OBJECT;
 	QML_ELEMENT;
@@ -105,6 +169,14 @@ class StdioCollector: public DataStreamParser {
 	Q_PROPERTY(QByteArray data READ data NOTIFY dataChanged);
 	/// If true, @@text and @@data will not be updated until the stream ends. Defaults to true.
 	Q_PROPERTY(bool waitForEnd READ waitForEnd WRITE setWaitForEnd NOTIFY waitForEndChanged);
+	/// The maximum number of bytes to keep, or 0 to keep everything. Defaults to 0.
+	///
+	/// If the output is larger than this, only the last `maxBytes` bytes are kept in
+	/// @@text and @@data, and @@overflowed(s) is emitted. Multi-byte characters at the start
+	/// of @@text may be cut off.
+	Q_PROPERTY(qint64 maxBytes READ maxBytes WRITE setMaxBytes NOTIFY maxBytesChanged);
+	/// The number of bytes discarded from the start of the current stream due to @@maxBytes.
+	Q_PROPERTY(qint64 droppedBytes READ droppedBytes NOTIFY droppedBytesChanged);
 
 public:
 	explicit StdioCollector(QObject* parent = nullptr): DataStreamParser(parent) {}
@@ -118,12 +190,29 @@ public:
 	[[nodiscard]] bool waitForEnd() const { return this->mWaitForEnd; }
 	void setWaitForEnd(bool waitForEnd);
 
+	[[nodiscard]] qint64 maxBytes() const { return this->mMaxBytes; }
+	void setMaxBytes(qint64 maxBytes);
+
+	[[nodiscard]] qint64 droppedBytes() const { return this->mDroppedBytes; }
+
 signals:
 	void waitForEndChanged();
 	void dataChanged();
 	void streamFinished();
+	void maxBytesChanged();
+	void droppedBytesChanged();
+	/// Emitted the first time output is discarded from a stream due to @@maxBytes.
+	void overflowed();
 
 private:
+	void appendBounded(const QByteArray& data);
+	bool takeBounded(QByteArray& buffer);
+
 	bool mWaitForEnd = true;
 	QByteArray mData;
+	qint64 mMaxBytes = 0;
+	// holds the output instead of the stream buffer if maxBytes is set
+	ByteRingBuffer ring;
+	qint64 mDroppedBytes = 0;
+	bool streamDone = false;
 };
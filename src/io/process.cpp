@@ -18,6 +18,7 @@
 #include "../core/reload.hpp"
 #include "datastream.hpp"
 #include "processcore.hpp"
+#include "spawn.hpp"
 
 Process::Process(QObject* parent): PostReloadHook(parent) {
 	QObject::connect(
@@ -35,22 +36,34 @@ Process::~Process() {
 
 		this->process->setParent(nullptr);
 		this->process->kill();
+	} else if (this->spawned != nullptr && this->spawned->processId() != 0) {
+		// Deleting after the process finishes avoids blocking on it.
+		QObject::connect(
+		    this->spawned,
+		    &qs::io::process::SpawnedProcess::finished,
+		    this->spawned,
+		    &QObject::deleteLater
+		);
+
+		this->spawned->setParent(nullptr);
+		this->spawned->kill();
 	}
 }
 
 void Process::onPostReload() { this->startProcessIfReady(); }
 
-bool Process::isRunning() const { return this->process != nullptr; }
+bool Process::isRunning() const { return this->process != nullptr || this->spawned != nullptr; }
 
 void Process::setRunning(bool running) {
 	this->targetRunning = running;
 	if (running) this->startProcessIfReady();
-	else if (this->isRunning()) this->process->terminate();
+	else if (this->isRunning()) this->withProcess([](auto* process) { process->terminate(); });
 }
 
 QVariant Process::processId() const {
-	if (this->process == nullptr) return QVariant::fromValue(nullptr);
-	return QVariant::fromValue(this->process->processId());
+	if (this->process != nullptr) return QVariant::fromValue(this->process->processId());
+	if (this->spawned != nullptr) return QVariant::fromValue(this->spawned->processId());
+	return QVariant::fromValue(nullptr);
 }
 
 QList<QString> Process::command() const { return this->mCommand; }
@@ -106,9 +119,12 @@ void Process::setStdoutParser(DataStreamParser* parser) {
 	if (this->mStdoutParser != nullptr) {
 		QObject::disconnect(this->mStdoutParser, nullptr, this, nullptr);
 
-		if (this->process != nullptr) {
-			this->process->closeReadChannel(QProcess::StandardOutput);
-			this->process->readAllStandardOutput(); // discard
+		if (this->isRunning()) {
+			this->withProcess([](auto* process) {
+				process->closeReadChannel(QProcess::StandardOutput);
+				process->readAllStandardOutput(); // discard
+			});
+
 			this->stdoutBuffer.clear();
 		}
 	}
@@ -117,6 +133,7 @@ void Process::setStdoutParser(DataStreamParser* parser) {
 
 	if (parser != nullptr) {
 		QObject::connect(parser, &QObject::destroyed, this, &Process::onStdoutParserDestroyed);
+		QObject::connect(parser, &DataStreamParser::readyForData, this, &Process::onStdoutReadyRead);
 	}
 
 	emit this->stdoutParserChanged();
@@ -128,6 +145,8 @@ void Process::setStdoutParser(DataStreamParser* parser) {
 
 void Process::onStdoutParserDestroyed() {
 	this->mStdoutParser = nullptr;
+	// a busy parser will not report being ready anymore
+	this->setReadPaused(QProcess::StandardOutput, false);
 	emit this->stdoutParserChanged();
 }
 
@@ -139,9 +158,12 @@ void Process::setStderrParser(DataStreamParser* parser) {
 	if (this->mStderrParser != nullptr) {
 		QObject::disconnect(this->mStderrParser, nullptr, this, nullptr);
 
-		if (this->process != nullptr) {
-			this->process->closeReadChannel(QProcess::StandardError);
-			this->process->readAllStandardError(); // discard
+		if (this->isRunning()) {
+			this->withProcess([](auto* process) {
+				process->closeReadChannel(QProcess::StandardError);
+				process->readAllStandardError(); // discard
+			});
+
 			this->stderrBuffer.clear();
 		}
 	}
@@ -150,6 +172,7 @@ void Process::setStderrParser(DataStreamParser* parser) {
 
 	if (parser != nullptr) {
 		QObject::connect(parser, &QObject::destroyed, this, &Process::onStderrParserDestroyed);
+		QObject::connect(parser, &DataStreamParser::readyForData, this, &Process::onStderrReadyRead);
 	}
 
 	emit this->stderrParserChanged();
@@ -161,6 +184,8 @@ void Process::setStderrParser(DataStreamParser* parser) {
 
 void Process::onStderrParserDestroyed() {
 	this->mStderrParser = nullptr;
+	// a busy parser will not report being ready anymore
+	this->setReadPaused(QProcess::StandardError, false);
 	emit this->stderrParserChanged();
 }
 
@@ -170,15 +195,21 @@ void Process::setStdinEnabled(bool enabled) {
 	if (enabled == this->mStdinEnabled) return;
 	this->mStdinEnabled = enabled;
 
-	if (!enabled && this->process != nullptr) {
-		this->process->closeWriteChannel();
+	if (!enabled && this->isRunning()) {
+		this->withProcess([](auto* process) { process->closeWriteChannel(); });
 	}
 
 	emit this->stdinEnabledChanged();
 }
 
+void Process::setFastSpawn(bool fastSpawn) {
+	if (fastSpawn == this->mFastSpawn) return;
+	this->mFastSpawn = fastSpawn;
+	emit this->fastSpawnChanged();
+}
+
 void Process::startProcessIfReady() {
-	if (this->process != nullptr || !this->isPostReload || !this->targetRunning
+	if (this->isRunning() || !this->isPostReload || !this->targetRunning
 	    || this->mCommand.isEmpty())
 		return;
 
@@ -195,6 +226,11 @@ void Process::startProcessIfReady() {
 
 	auto args = this->mCommand.sliced(1);
 
+	if (this->mFastSpawn && qs::io::process::SpawnedProcess::isSupported()) {
+		this->startSpawnedProcess(cmd, args);
+		return;
+	}
+
 	this->process = new QProcess(this);
 
 	// clang-format off
@@ -216,6 +252,36 @@ void Process::startProcessIfReady() {
 	this->process->start(cmd, args);
 }
 
+void Process::startSpawnedProcess(const QString& program, const QList<QString>& arguments) {
+	using qs::io::process::SpawnedProcess;
+
+	this->spawned = new SpawnedProcess(this);
+
+	// clang-format off
+	QObject::connect(this->spawned, &SpawnedProcess::started, this, &Process::onStarted);
+	QObject::connect(this->spawned, &SpawnedProcess::finished, this, &Process::onFinished);
+	QObject::connect(this->spawned, &SpawnedProcess::errorOccurred, this, &Process::onErrorOccurred);
+	QObject::connect(this->spawned, &SpawnedProcess::readyReadStandardOutput, this, &Process::onStdoutReadyRead);
+	QObject::connect(this->spawned, &SpawnedProcess::readyReadStandardError, this, &Process::onStderrReadyRead);
+	// clang-format on
+
+	this->stdoutBuffer.clear();
+	this->stderrBuffer.clear();
+
+	this->spawned->start({
+	    .program = program,
+	    .arguments = arguments,
+	    .environment = qs::io::process::createProcessEnvironment(
+	        this->mClearEnvironment,
+	        this->mEnvironment
+	    ),
+	    .workingDirectory = this->mWorkingDirectory,
+	    .readStdout = this->mStdoutParser != nullptr,
+	    .readStderr = this->mStderrParser != nullptr,
+	    .writeStdin = this->mStdinEnabled,
+	});
+}
+
 void Process::exec(QList<QString> command) {
 	this->exec(qs::io::process::ProcessContext(std::move(command)));
 }
@@ -226,6 +292,7 @@ void Process::exec(const qs::io::process::ProcessContext& context) {
 	if (context.environmentSet) this->setEnvironment(context.environment);
 	if (context.clearEnvironmentSet) this->setEnvironmentCleared(context.clearEnvironment);
 	if (context.workingDirectorySet) this->setWorkingDirectory(context.workingDirectory);
+	if (context.fastSpawnSet) this->setFastSpawn(context.fastSpawn);
 
 	if (this->mCommand.isEmpty()) {
 		qmlWarning(this) << "Cannot start process as command is empty.";
@@ -244,6 +311,20 @@ void Process::startDetached() {
 	auto& cmd = this->mCommand.first();
 	auto args = this->mCommand.sliced(1);
 
+	if (this->mFastSpawn) {
+		auto started = qs::io::process::SpawnedProcess::startDetached({
+		    .program = cmd,
+		    .arguments = args,
+		    .environment = qs::io::process::createProcessEnvironment(
+		        this->mClearEnvironment,
+		        this->mEnvironment
+		    ),
+		    .workingDirectory = this->mWorkingDirectory,
+		});
+
+		if (started) return;
+	}
+
 	QProcess process;
 
 	this->setupEnvironment(&process);
@@ -272,8 +353,18 @@ void Process::onStarted() {
 }
 
 void Process::onFinished(qint32 exitCode, QProcess::ExitStatus exitStatus) {
-	this->process->deleteLater();
-	this->process = nullptr;
+	// output held back from busy parsers
+	if (this->mStdoutParser) {
+		auto buf = this->withProcess([](auto* process) { return process->readAllStandardOutput(); });
+		if (!buf.isEmpty()) this->mStdoutParser->parseBytes(buf, this->stdoutBuffer);
+	}
+
+	if (this->mStderrParser) {
+		auto buf = this->withProcess([](auto* process) { return process->readAllStandardError(); });
+		if (!buf.isEmpty()) this->mStderrParser->parseBytes(buf, this->stderrBuffer);
+	}
+
+	this->releaseProcess();
 	if (this->mStdoutParser) this->mStdoutParser->streamEnded(this->stdoutBuffer);
 	if (this->mStderrParser) this->mStderrParser->streamEnded(this->stderrBuffer);
 	this->stdoutBuffer.clear();
@@ -290,30 +381,48 @@ void Process::onErrorOccurred(QProcess::ProcessError error) {
 	if (error == QProcess::FailedToStart) { // other cases should be covered by other events
 		qWarning() << "Process failed to start, likely because the binary could not be found. Command:"
 		           << this->mCommand;
-		this->process->deleteLater();
-		this->process = nullptr;
+		this->releaseProcess();
 		emit this->runningChanged();
 	}
 }
 
+void Process::releaseProcess() {
+	this->withProcess([](auto* process) { process->deleteLater(); });
+	this->process = nullptr;
+	this->spawned = nullptr;
+}
+
 void Process::onStdoutReadyRead() {
-	if (this->mStdoutParser == nullptr) return;
-	auto buf = this->process->readAllStandardOutput();
+	// unread output is left in the process until the parser catches up
+	if (!this->isRunning() || this->mStdoutParser == nullptr) return;
+	auto busy = this->mStdoutParser->isBusy();
+	this->setReadPaused(QProcess::StandardOutput, busy);
+	if (busy) return;
+	auto buf = this->withProcess([](auto* process) { return process->readAllStandardOutput(); });
 	this->mStdoutParser->parseBytes(buf, this->stdoutBuffer);
 }
 
 void Process::onStderrReadyRead() {
-	if (this->mStderrParser == nullptr) return;
-	auto buf = this->process->readAllStandardError();
+	if (!this->isRunning() || this->mStderrParser == nullptr) return;
+	auto busy = this->mStderrParser->isBusy();
+	this->setReadPaused(QProcess::StandardError, busy);
+	if (busy) return;
+	auto buf = this->withProcess([](auto* process) { return process->readAllStandardError(); });
 	this->mStderrParser->parseBytes(buf, this->stderrBuffer);
 }
 
+void Process::setReadPaused(QProcess::ProcessChannel channel, bool paused) {
+	// QProcess always reads its pipes into memory, so only spawned processes stop reading.
+	if (this->spawned != nullptr) this->spawned->setReadChannelPaused(channel, paused);
+}
+
 void Process::signal(qint32 signal) {
-	if (this->process == nullptr) return;
-	kill(static_cast<qint32>(this->process->processId()), signal); // NOLINT
+	if (!this->isRunning()) return;
+	auto pid = this->withProcess([](auto* process) { return process->processId(); });
+	kill(static_cast<qint32>(pid), signal); // NOLINT
 }
 
 void Process::write(const QString& data) {
-	if (this->process == nullptr) return;
-	this->process->write(data.toUtf8());
+	if (!this->isRunning()) return;
+	this->withProcess([&](auto* process) { process->write(data.toUtf8()); });
 }
@@ -14,6 +14,11 @@ void setupProcessEnvironment(
     bool clear,
     const QHash<QString, QVariant>& envChanges
 ) {
+	process->setProcessEnvironment(createProcessEnvironment(clear, envChanges));
+}
+
+QProcessEnvironment
+createProcessEnvironment(bool clear, const QHash<QString, QVariant>& envChanges) {
 	const auto& sysenv = qs::Common::INITIAL_ENVIRONMENT;
 	auto env = clear ? QProcessEnvironment() : sysenv;
 
@@ -31,7 +36,7 @@ void setupProcessEnvironment(
 		}
 	}
 
-	process->setProcessEnvironment(env);
+	return env;
 }
 
 } // namespace qs::io::process
@@ -17,6 +17,7 @@ class ProcessContext {
 	Q_PROPERTY(bool clearEnvironment MEMBER clearEnvironment WRITE setClearEnvironment);
 	Q_PROPERTY(QString workingDirectory MEMBER workingDirectory WRITE setWorkingDirectory);
 	Q_PROPERTY(bool unbindStdout MEMBER unbindStdout WRITE setUnbindStdout);
+	Q_PROPERTY(bool fastSpawn MEMBER fastSpawn WRITE setFastSpawn);
 	Q_GADGET;
 	QML_STRUCTURED_VALUE;
 	QML_VALUE_TYPE(processContext);
@@ -48,15 +49,22 @@ public:
 
 	void setUnbindStdout(bool unbindStdout) { this->unbindStdout = unbindStdout; }
 
+	void setFastSpawn(bool fastSpawn) {
+		this->fastSpawn = fastSpawn;
+		this->fastSpawnSet = true;
+	}
+
 	QList<QString> command;
 	QHash<QString, QVariant> environment;
 	bool clearEnvironment = false;
 	QString workingDirectory;
+	bool fastSpawn = false;
 
 	bool commandSet : 1 = false;
 	bool environmentSet : 1 = false;
 	bool clearEnvironmentSet : 1 = false;
 	bool workingDirectorySet : 1 = false;
+	bool fastSpawnSet : 1 = false;
 	bool unbindStdout : 1 = true;
 };
 
@@ -66,4 +74,7 @@ void setupProcessEnvironment(
     const QHash<QString, QVariant>& envChanges
 );
 
+QProcessEnvironment
+createProcessEnvironment(bool clear, const QHash<QString, QVariant>& envChanges);
+
 } // namespace qs::io::process
@@ -0,0 +1,265 @@
+#include "recordparser.hpp"
+#include <cstring>
+#include <utility>
+
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
+#include <qjsondocument.h>
+#include <qjsonparseerror.h>
+#include <qlogging.h>
+#include <qloggingcategory.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qobjectdefs.h>
+#include <qthreadpool.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "../core/logcat.hpp"
+
+namespace {
+QS_LOGGING_CATEGORY(logRecordParser, "quickshell.io.recordparser", QtWarningMsg);
+
+// Larger lengths are assumed to be a corrupt or misconfigured stream.
+constexpr quint64 MAX_FRAME_SIZE = 64ull * 1024 * 1024;
+// Streams stop reading while this much data is waiting for a running decode.
+constexpr qsizetype MAX_PENDING_BYTES = 4 * 1024 * 1024;
+
+QVariant decodePayload(const QByteArray& data, RecordFormat::Enum format) {
+	switch (format) {
+	case RecordFormat::Json: {
+		auto error = QJsonParseError();
+		auto json = QJsonDocument::fromJson(data, &error);
+
+		if (error.error != QJsonParseError::NoError) {
+			qCWarning(logRecordParser) << "Skipping invalid JSON record:" << error.errorString()
+			                           << "at offset" << error.offset;
+			return QVariant();
+		}
+
+		return json.toVariant();
+	}
+	case RecordFormat::Text: return QString::fromUtf8(data);
+	case RecordFormat::Bytes: return data;
+	default: return QVariant();
+	}
+}
+
+bool isBlank(const char* data, qsizetype length) {
+	for (qsizetype i = 0; i < length; i++) {
+		auto c = data[i]; // NOLINT
+		if (c != ' ' && c != '\t' && c != '\r') return false;
+	}
+
+	return true;
+}
+
+} // namespace
+
+RecordDecodeJob::RecordDecodeJob(QList<QByteArray> frames, RecordDecoder decoder)
+    : frames(std::move(frames))
+    , decoder(std::move(decoder)) {
+	this->setAutoDelete(false);
+}
+
+void RecordDecodeJob::run() {
+	this->records.reserve(this->frames.length());
+
+	for (const auto& frame: this->frames) {
+		auto record = this->decoder(frame);
+		if (record.isValid()) this->records.append(std::move(record));
+	}
+
+	this->frames.clear();
+	QMetaObject::invokeMethod(this, &RecordDecodeJob::finished, Qt::QueuedConnection);
+}
+
+void RecordDecodeJob::finished() {
+	if (!this->records.isEmpty()) emit this->done(this->records);
+	// The job may outlive its parser, so it owns itself and is deleted on the main thread.
+	delete this;
+}
+
+void RecordParser::parseBytes(QByteArray& incoming, QByteArray& buffer) {
+	if (&incoming != &buffer) buffer.append(incoming);
+
+	auto frames = QList<QByteArray>();
+	auto consumed = this->takeFrames(buffer, frames);
+	buffer.remove(0, consumed);
+
+	this->queueFrames(std::move(frames));
+}
+
+void RecordParser::streamEnded(QByteArray& buffer) {
+	auto frames = QList<QByteArray>();
+	if (!buffer.isEmpty()) this->takeFinalFrame(buffer, frames);
+	buffer.clear();
+
+	this->queueFrames(std::move(frames));
+}
+
+void RecordParser::queueFrames(QList<QByteArray> frames) {
+	if (frames.isEmpty()) return;
+
+	for (const auto& frame: frames) this->pendingBytes += frame.size();
+
+	if (this->pendingFrames.isEmpty()) this->pendingFrames = std::move(frames);
+	else this->pendingFrames.append(std::move(frames));
+
+	// Frames read while a job is running are picked up when it finishes.
+	if (!this->liveJob) this->startDecode();
+}
+
+bool RecordParser::isBusy() const { return this->pendingBytes >= MAX_PENDING_BYTES; }
+
+void RecordParser::startDecode() {
+	auto wasBusy = this->isBusy();
+
+	auto* job = new RecordDecodeJob(std::move(this->pendingFrames), this->decoder());
+	this->pendingFrames.clear();
+	this->pendingBytes = 0;
+
+	QObject::connect(job, &RecordDecodeJob::done, this, &RecordParser::onDecodeFinished);
+	QObject::connect(job, &QObject::destroyed, this, [this]() {
+		this->liveJob = nullptr;
+		if (!this->pendingFrames.isEmpty()) this->startDecode();
+	});
+
+	this->liveJob = job;
+	QThreadPool::globalInstance()->start(job);
+
+	if (wasBusy) emit this->readyForData();
+}
+
+void RecordParser::onDecodeFinished(const QVariantList& records) { emit this->records(records); }
+
+qsizetype JsonLinesParser::takeFrames(const QByteArray& data, QList<QByteArray>& frames) {
+	const auto* begin = data.constData();
+	const auto* end = begin + data.length(); // NOLINT
+	const auto* start = begin;
+
+	// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	while (start != end) {
+		const auto* newline = static_cast<const char*>(memchr(start, '\n', end - start));
+		if (newline == nullptr) break;
+
+		if (!isBlank(start, newline - start)) {
+			frames.append(data.sliced(start - begin, newline - start));
+		}
+
+		start = newline + 1;
+	}
+	// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+	return start - begin;
+}
+
+void JsonLinesParser::takeFinalFrame(const QByteArray& data, QList<QByteArray>& frames) {
+	if (!isBlank(data.constData(), data.length())) frames.append(data);
+}
+
+RecordDecoder JsonLinesParser::decoder() const {
+	return [](const QByteArray& frame) { return decodePayload(frame, RecordFormat::Json); };
+}
+
+qsizetype FramedParser::effectiveHeaderSize() const {
+	return qMax(this->mHeaderSize, this->mLengthOffset + this->mLengthSize);
+}
+
+qsizetype FramedParser::takeFrames(const QByteArray& data, QList<QByteArray>& frames) {
+	if (this->mInvalid) return data.length();
+
+	auto headerSize = this->effectiveHeaderSize();
+	qsizetype start = 0;
+
+	while (data.length() - start >= headerSize) {
+		const auto* field = data.constData() + start + this->mLengthOffset; // NOLINT
+
+		quint64 length = 0;
+		for (qint32 i = 0; i < this->mLengthSize; i++) {
+			auto byteIndex = this->mLittleEndian ? this->mLengthSize - 1 - i : i;
+			length = (length << 8) | static_cast<quint8>(field[byteIndex]); // NOLINT
+		}
+
+		if (length > MAX_FRAME_SIZE) {
+			qCWarning(logRecordParser) << "Discarding stream after reading a payload length of"
+			                           << length << "bytes, which exceeds the maximum of"
+			                           << MAX_FRAME_SIZE;
+			this->mInvalid = true;
+			return data.length();
+		}
+
+		auto frameSize = headerSize + static_cast<qsizetype>(length);
+		if (data.length() - start < frameSize) break;
+
+		frames.append(data.sliced(start, frameSize));
+		start += frameSize;
+	}
+
+	return start;
+}
+
+void FramedParser::streamEnded(QByteArray& buffer) {
+	// incomplete frames at the end of a stream are dropped
+	buffer.clear();
+	this->mInvalid = false;
+}
+
+RecordDecoder FramedParser::decoder() const {
+	return [headerSize = this->effectiveHeaderSize(),
+	        format = this->mFormat,
+	        includeHeader = this->mIncludeHeader](const QByteArray& frame) -> QVariant {
+		auto payload = decodePayload(frame.sliced(headerSize), format);
+		if (!includeHeader || !payload.isValid()) return payload;
+
+		return QVariantMap {
+		    {"header", frame.first(headerSize)},
+		    {"payload", payload},
+		};
+	};
+}
+
+void FramedParser::setLengthOffset(qint32 lengthOffset) {
+	if (lengthOffset < 0) lengthOffset = 0;
+	if (lengthOffset == this->mLengthOffset) return;
+	this->mLengthOffset = lengthOffset;
+	emit this->lengthOffsetChanged();
+}
+
+void FramedParser::setLengthSize(qint32 lengthSize) {
+	if (lengthSize != 1 && lengthSize != 2 && lengthSize != 4 && lengthSize != 8) {
+		qCWarning(logRecordParser) << "Ignoring invalid FramedParser.lengthSize" << lengthSize
+		                           << "(must be 1, 2, 4 or 8)";
+		return;
+	}
+
+	if (lengthSize == this->mLengthSize) return;
+	this->mLengthSize = lengthSize;
+	emit this->lengthSizeChanged();
+}
+
+void FramedParser::setHeaderSize(qint32 headerSize) {
+	if (headerSize < 0) headerSize = 0;
+	if (headerSize == this->mHeaderSize) return;
+	this->mHeaderSize = headerSize;
+	emit this->headerSizeChanged();
+}
+
+void FramedParser::setLittleEndian(bool littleEndian) {
+	if (littleEndian == this->mLittleEndian) return;
+	this->mLittleEndian = littleEndian;
+	emit this->littleEndianChanged();
+}
+
+void FramedParser::setFormat(RecordFormat::Enum format) {
+	if (format == this->mFormat) return;
+	this->mFormat = format;
+	emit this->formatChanged();
+}
+
+void FramedParser::setIncludeHeader(bool includeHeader) {
+	if (includeHeader == this->mIncludeHeader) return;
+	this->mIncludeHeader = includeHeader;
+	emit this->includeHeaderChanged();
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <functional>
+
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
+#include <qobject.h>
+#include <qqmlintegration.h>
+#include <qrunnable.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "datastream.hpp"
+
+///! Encoding of records read by a RecordParser.
+class RecordFormat: public QObject {
+	Q_OBJECT;
+	QML_ELEMENT;
+	QML_SINGLETON;
+
+public:
+	enum Enum : quint8 {
+		/// Records are parsed as JSON, and emitted as javascript objects or arrays.
+		Json = 0,
+		/// Records are decoded as UTF-8 and emitted as strings.
+		Text = 1,
+		/// Records are emitted as [ArrayBuffer]s.
+		///
+		/// [ArrayBuffer]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/ArrayBuffer
+		Bytes = 2,
+	};
+	Q_ENUM(Enum);
+};
+
+using RecordDecoder = std::function<QVariant(const QByteArray&)>;
+
+class RecordDecodeJob
+    : public QObject
+    , public QRunnable {
+	Q_OBJECT;
+
+public:
+	explicit RecordDecodeJob(QList<QByteArray> frames, RecordDecoder decoder);
+
+	void run() override;
+
+signals:
+	void done(QVariantList records);
+
+private slots:
+	void finished();
+
+private:
+	QList<QByteArray> frames;
+	RecordDecoder decoder;
+	QVariantList records;
+};
+
+///! DataStreamParser for streams of structured records.
+/// Base class of parsers that split a stream into records and decode them on a background
+/// thread, so large or frequent messages do not stall the UI.
+///
+/// Records are delivered in stream order through @@records(s). Records read while the
+/// previous records are still being decoded are coalesced into the next batch, so at most
+/// one batch is delivered per event loop iteration. If records are read much faster than
+/// they can be decoded, the stream stops reading until decoding catches up.
+///
+/// See also: @@JsonLinesParser, @@FramedParser.
+class RecordParser: public DataStreamParser {
+	Q_OBJECT;
+	QML_ELEMENT;
+	QML_UNCREATABLE("base class");
+
+public:
+	explicit RecordParser(QObject* parent = nullptr): DataStreamParser(parent) {}
+
+	void parseBytes(QByteArray& incoming, QByteArray& buffer) override;
+	void streamEnded(QByteArray& buffer) override;
+	[[nodiscard]] bool isBusy() const override;
+
+signals:
+	/// Emitted with every record decoded since the last emission, in stream order.
+	void records(QVariantList records);
+
+protected:
+	// Appends every complete frame at the start of data to frames, returning the number
+	// of bytes consumed. Incomplete frames are kept in the buffer until more data arrives.
+	virtual qsizetype takeFrames(const QByteArray& data, QList<QByteArray>& frames) = 0;
+	// Called with the unconsumed data when the stream ends.
+	virtual void takeFinalFrame(const QByteArray& /*data*/, QList<QByteArray>& /*frames*/) {}
+	// Returns a function decoding a single frame. Called on the main thread, and run on
+	// a background thread, so it must not reference the parser.
+	[[nodiscard]] virtual RecordDecoder decoder() const = 0;
+
+private slots:
+	void onDecodeFinished(const QVariantList& records);
+
+private:
+	void queueFrames(QList<QByteArray> frames);
+	void startDecode();
+
+	QList<QByteArray> pendingFrames;
+	qsizetype pendingBytes = 0;
+	RecordDecodeJob* liveJob = nullptr;
+};
+
+///! RecordParser for newline delimited JSON.
+/// Parses a stream of [JSON lines], such as the output of `swaymsg -t subscribe -m`
+/// or `jq -c`, into javascript objects. Each line must be a JSON object or array.
+/// Blank lines are skipped, and lines that are not valid JSON are logged and skipped.
+///
+/// ```qml
+/// Process {
+///   command: [ "swaymsg", "-t", "subscribe", "-m", "[\"window\"]" ]
+///   running: true
+///   stdout: JsonLinesParser {
+///     onRecords: records => records.forEach(event => console.log(event.change))
+///   }
+/// }
+/// ```
+///
+/// [JSON lines]: https://jsonlines.org
+class JsonLinesParser: public RecordParser {
+	Q_OBJECT;
+	QML_ELEMENT;
+
+public:
+	explicit JsonLinesParser(QObject* parent = nullptr): RecordParser(parent) {}
+
+protected:
+	qsizetype takeFrames(const QByteArray& data, QList<QByteArray>& frames) override;
+	void takeFinalFrame(const QByteArray& data, QList<QByteArray>& frames) override;
+	[[nodiscard]] RecordDecoder decoder() const override;
+};
+
+///! RecordParser for length prefixed messages.
+/// Parses a stream of messages that each start with a fixed size header containing
+/// the length of the message payload.
+///
+/// For example, i3 and sway IPC messages have a 14 byte header, consisting of the string
+/// `i3-ipc`, a 4 byte payload length and a 4 byte message type, in native byte order.
+///
+/// ```qml
+/// FramedParser {
+///   lengthOffset: 6
+///   headerSize: 14
+///   littleEndian: true
+///   includeHeader: true
+///   onRecords: records => {
+///     for (const record of records) {
+///       const type = new DataView(record.header).getUint32(10, true);
+///       // ...
+///     }
+///   }
+/// }
+/// ```
+class FramedParser: public RecordParser {
+	Q_OBJECT;
+	QML_ELEMENT;
+	// clang-format off
+	/// Offset of the payload length in the header. Defaults to 0.
+	Q_PROPERTY(qint32 lengthOffset READ lengthOffset WRITE setLengthOffset NOTIFY lengthOffsetChanged);
+	/// Size of the payload length in bytes. Must be 1, 2, 4 or 8. Defaults to 4.
+	Q_PROPERTY(qint32 lengthSize READ lengthSize WRITE setLengthSize NOTIFY lengthSizeChanged);
+	/// Total size of the header preceding the payload. If smaller than the end of the
+	/// payload length, the header ends after the payload length. Defaults to 0.
+	Q_PROPERTY(qint32 headerSize READ headerSize WRITE setHeaderSize NOTIFY headerSizeChanged);
+	/// If true, the payload length is little endian. Defaults to false (network byte order).
+	Q_PROPERTY(bool littleEndian READ littleEndian WRITE setLittleEndian NOTIFY littleEndianChanged);
+	/// Encoding of the payload. Defaults to `RecordFormat.Json`.
+	Q_PROPERTY(RecordFormat::Enum format READ format WRITE setFormat NOTIFY formatChanged);
+	/// If true, records are objects with the header as an [ArrayBuffer] in `header`
+	/// and the decoded payload in `payload`. Defaults to false.
+	///
+	/// [ArrayBuffer]: https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/ArrayBuffer
+	Q_PROPERTY(bool includeHeader READ includeHeader WRITE setIncludeHeader NOTIFY includeHeaderChanged);
+	// clang-format on
+
+public:
+	explicit FramedParser(QObject* parent = nullptr): RecordParser(parent) {}
+
+	void streamEnded(QByteArray& buffer) override;
+
+	[[nodiscard]] qint32 lengthOffset() const { return this->mLengthOffset; }
+	void setLengthOffset(qint32 lengthOffset);
+
+	[[nodiscard]] qint32 lengthSize() const { return this->mLengthSize; }
+	void setLengthSize(qint32 lengthSize);
+
+	[[nodiscard]] qint32 headerSize() const { return this->mHeaderSize; }
+	void setHeaderSize(qint32 headerSize);
+
+	[[nodiscard]] bool littleEndian() const { return this->mLittleEndian; }
+	void setLittleEndian(bool littleEndian);
+
+	[[nodiscard]] RecordFormat::Enum format() const { return this->mFormat; }
+	void setFormat(RecordFormat::Enum format);
+
+	[[nodiscard]] bool includeHeader() const { return this->mIncludeHeader; }
+	void setIncludeHeader(bool includeHeader);
+
+signals:
+	void lengthOffsetChanged();
+	void lengthSizeChanged();
+	void headerSizeChanged();
+	void littleEndianChanged();
+	void formatChanged();
+	void includeHeaderChanged();
+
+protected:
+	qsizetype takeFrames(const QByteArray& data, QList<QByteArray>& frames) override;
+	[[nodiscard]] RecordDecoder decoder() const override;
+
+private:
+	[[nodiscard]] qsizetype effectiveHeaderSize() const;
+
+	qint32 mLengthOffset = 0;
+	qint32 mLengthSize = 4;
+	qint32 mHeaderSize = 0;
+	bool mLittleEndian = false;
+	RecordFormat::Enum mFormat = RecordFormat::Json;
+	bool mIncludeHeader = false;
+	// set when a payload length exceeds the maximum, discarding the rest of the stream
+	bool mInvalid = false;
+};
@@ -10,18 +10,25 @@
 #include <qqmlcomponent.h>
 #include <qqmlengine.h>
 #include <qtmetamacros.h>
+#include <qtypes.h>
 
 #include "../core/logcat.hpp"
 #include "datastream.hpp"
 
 QS_LOGGING_CATEGORY(logSocket, "quickshell.io.socket", QtWarningMsg);
 
+namespace {
+// Limits how much is read ahead of a busy parser before the peer is blocked.
+constexpr qint64 SOCKET_READ_BUFFER_SIZE = 1024 * 1024;
+} // namespace
+
 void Socket::setSocket(QLocalSocket* socket) {
 	if (this->socket != nullptr) this->socket->deleteLater();
 	this->socket = socket;
 
 	if (socket != nullptr) {
 		socket->setParent(this);
+		socket->setReadBufferSize(SOCKET_READ_BUFFER_SIZE);
 
 		// clang-format off
 		QObject::connect(this->socket, &QLocalSocket::connected, this, &Socket::onSocketConnected);
@@ -0,0 +1,399 @@
+#include "spawn.hpp"
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
+#include <qlogging.h>
+#include <qloggingcategory.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qobjectdefs.h>
+#include <qprocess.h>
+#include <qsocketnotifier.h>
+#include <qtypes.h>
+#include <spawn.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../core/logcat.hpp"
+
+namespace qs::io::process {
+
+namespace {
+QS_LOGGING_CATEGORY(logSpawn, "quickshell.io.spawn", QtWarningMsg);
+
+int pidfdOpen(pid_t pid) {
+#ifdef SYS_pidfd_open
+	return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+// Null terminated array of C strings, as taken by exec.
+class CStringArray {
+public:
+	explicit CStringArray(const QList<QString>& strings) {
+		this->storage.reserve(strings.length());
+		for (const auto& string: strings) this->storage.append(string.toLocal8Bit());
+
+		this->pointers.reserve(strings.length() + 1);
+		for (auto& bytes: this->storage) this->pointers.append(bytes.data());
+		this->pointers.append(nullptr);
+	}
+
+	[[nodiscard]] char** data() { return this->pointers.data(); }
+
+private:
+	QList<QByteArray> storage;
+	QList<char*> pointers;
+};
+
+void closeFd(int& fd) {
+	if (fd == -1) return;
+	::close(fd);
+	fd = -1;
+}
+
+} // namespace
+
+SpawnedProcess::~SpawnedProcess() {
+	SpawnedProcess::closePipe(this->stdoutPipe);
+	SpawnedProcess::closePipe(this->stderrPipe);
+	SpawnedProcess::closePipe(this->stdinPipe);
+
+	if (this->pid != 0) {
+		// Unlike QProcess this does not wait for a graceful exit.
+		::kill(static_cast<pid_t>(this->pid), SIGKILL);
+		::waitpid(static_cast<pid_t>(this->pid), nullptr, 0);
+	}
+
+	closeFd(this->pidfd);
+}
+
+bool SpawnedProcess::isSupported() {
+	static auto supported = [] {
+		auto fd = pidfdOpen(getpid());
+		if (fd == -1) {
+			qCInfo(logSpawn) << "pidfd_open is not supported, falling back to QProcess.";
+			return false;
+		}
+
+		::close(fd);
+		return true;
+	}();
+
+	return supported;
+}
+
+bool SpawnedProcess::start(const SpawnOptions& options) {
+	if (!SpawnedProcess::isSupported()) return false;
+
+	// Same as QProcess, so writes to a closed stdin do not kill quickshell.
+	struct sigaction sigpipe {};
+	if (::sigaction(SIGPIPE, nullptr, &sigpipe) == 0 && sigpipe.sa_handler == SIG_DFL) {
+		::signal(SIGPIPE, SIG_IGN);
+	}
+
+	// read end, write end
+	auto stdoutFds = std::array<int, 2> {-1, -1};
+	auto stderrFds = std::array<int, 2> {-1, -1};
+	auto stdinFds = std::array<int, 2> {-1, -1};
+
+	auto closeAll = [&]() {
+		for (auto* fds: {&stdoutFds, &stderrFds, &stdinFds}) {
+			closeFd((*fds)[0]);
+			closeFd((*fds)[1]);
+		}
+	};
+
+	auto pipeOutput = !options.detached;
+	auto pipeFailed = (pipeOutput && options.readStdout && ::pipe2(stdoutFds.data(), O_CLOEXEC) == -1)
+	               || (pipeOutput && options.readStderr && ::pipe2(stderrFds.data(), O_CLOEXEC) == -1)
+	               || (!options.detached && options.writeStdin
+	                   && ::pipe2(stdinFds.data(), O_CLOEXEC) == -1);
+
+	if (pipeFailed) {
+		qCWarning(logSpawn) << "Failed to create pipes for" << options.program << ':'
+		                    << strerror(errno);
+		closeAll();
+		emit this->errorOccurred(QProcess::FailedToStart);
+		return true;
+	}
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+
+	if (stdinFds[0] != -1) {
+		posix_spawn_file_actions_adddup2(&actions, stdinFds[0], STDIN_FILENO);
+	} else {
+		posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+	}
+
+	auto setupOutput = [&](int fd, int pipeFd) {
+		if (pipeFd != -1) posix_spawn_file_actions_adddup2(&actions, pipeFd, fd);
+		else if (!options.inheritOutput) {
+			posix_spawn_file_actions_addopen(&actions, fd, "/dev/null", O_WRONLY, 0);
+		}
+	};
+
+	setupOutput(STDOUT_FILENO, stdoutFds[1]);
+	setupOutput(STDERR_FILENO, stderrFds[1]);
+
+	auto workingDirectory = options.workingDirectory.toLocal8Bit();
+	if (!workingDirectory.isEmpty()) {
+		posix_spawn_file_actions_addchdir_np(&actions, workingDirectory.constData());
+	}
+
+	posix_spawnattr_t attr;
+	posix_spawnattr_init(&attr);
+
+	sigset_t mask;
+	sigemptyset(&mask);
+	posix_spawnattr_setsigmask(&attr, &mask);
+
+	sigset_t defaults;
+	sigfillset(&defaults);
+	posix_spawnattr_setsigdefault(&attr, &defaults);
+
+	short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_SETSID
+	if (options.detached) flags |= POSIX_SPAWN_SETSID;
+#endif
+	posix_spawnattr_setflags(&attr, flags);
+
+	auto arguments = QList<QString>({options.program}) + options.arguments;
+	auto argv = CStringArray(arguments);
+	auto envp = CStringArray(options.environment.toStringList());
+	auto program = options.program.toLocal8Bit();
+
+	pid_t pid = 0;
+	auto result =
+	    posix_spawnp(&pid, program.constData(), &actions, &attr, argv.data(), envp.data());
+
+	posix_spawn_file_actions_destroy(&actions);
+	posix_spawnattr_destroy(&attr);
+
+	closeFd(stdoutFds[1]);
+	closeFd(stderrFds[1]);
+	closeFd(stdinFds[0]);
+
+	if (result != 0) {
+		qCWarning(logSpawn) << "Failed to spawn" << options.program << ':' << strerror(result);
+		closeAll();
+		emit this->errorOccurred(QProcess::FailedToStart);
+		return true;
+	}
+
+	this->pid = pid;
+	this->pidfd = pidfdOpen(pid);
+
+	if (this->pidfd == -1) {
+		qCWarning(logSpawn) << "Failed to open pidfd for" << options.program << ':' << strerror(errno);
+		::kill(pid, SIGKILL);
+		::waitpid(pid, nullptr, 0);
+		this->pid = 0;
+		closeAll();
+		emit this->errorOccurred(QProcess::FailedToStart);
+		return true;
+	}
+
+	this->pidfdNotifier = new QSocketNotifier(this->pidfd, QSocketNotifier::Read, this);
+	QObject::connect(
+	    this->pidfdNotifier,
+	    &QSocketNotifier::activated,
+	    this,
+	    &SpawnedProcess::onPidfdActivated
+	);
+
+	auto setupPipe = [this](Pipe& pipe, int fd, QSocketNotifier::Type type, auto slot) {
+		if (fd == -1) return;
+		::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+		pipe.fd = fd;
+		pipe.notifier = new QSocketNotifier(fd, type, this);
+		QObject::connect(pipe.notifier, &QSocketNotifier::activated, this, slot);
+	};
+
+	// clang-format off
+	setupPipe(this->stdoutPipe, stdoutFds[0], QSocketNotifier::Read, &SpawnedProcess::onStdoutActivated);
+	setupPipe(this->stderrPipe, stderrFds[0], QSocketNotifier::Read, &SpawnedProcess::onStderrActivated);
+	setupPipe(this->stdinPipe, stdinFds[1], QSocketNotifier::Write, &SpawnedProcess::onStdinActivated);
+	// clang-format on
+	if (this->stdinPipe.notifier) this->stdinPipe.notifier->setEnabled(false);
+
+	// QProcess also reports startup asynchronously. Exit and output can be seen before the
+	// queued call runs, in which case it is emitted first.
+	this->startPending = true;
+	QMetaObject::invokeMethod(this, &SpawnedProcess::emitStarted, Qt::QueuedConnection);
+	return true;
+}
+
+void SpawnedProcess::emitStarted() {
+	if (!std::exchange(this->startPending, false)) return;
+	emit this->started();
+}
+
+bool SpawnedProcess::startDetached(SpawnOptions options) {
+	options.detached = true;
+	options.writeStdin = false;
+
+	auto* process = new SpawnedProcess();
+	QObject::connect(process, &SpawnedProcess::finished, process, &QObject::deleteLater);
+	QObject::connect(process, &SpawnedProcess::errorOccurred, process, &QObject::deleteLater);
+
+	if (!process->start(options)) {
+		delete process;
+		return false;
+	}
+
+	return true;
+}
+
+void SpawnedProcess::onPidfdActivated() {
+	auto status = 0;
+	auto result = ::waitpid(static_cast<pid_t>(this->pid), &status, WNOHANG);
+	if (result == 0) return;
+
+	this->pid = 0;
+	this->pidfdNotifier->setEnabled(false);
+	closeFd(this->pidfd);
+	this->emitStarted();
+
+	// Output written just before exit may not have been read yet. It is read even if
+	// paused, as the pipes are closed below.
+	this->stdoutPipe.paused = false;
+	this->stderrPipe.paused = false;
+	this->onStdoutActivated();
+	this->onStderrActivated();
+	SpawnedProcess::closePipe(this->stdoutPipe);
+	SpawnedProcess::closePipe(this->stderrPipe);
+	SpawnedProcess::closePipe(this->stdinPipe);
+
+	if (result == -1) {
+		qCWarning(logSpawn) << "Failed to wait for spawned process:" << strerror(errno);
+		emit this->finished(-1, QProcess::CrashExit);
+	} else if (WIFEXITED(status)) {
+		emit this->finished(WEXITSTATUS(status), QProcess::NormalExit);
+	} else {
+		emit this->finished(WTERMSIG(status), QProcess::CrashExit);
+	}
+}
+
+void SpawnedProcess::onStdoutActivated() {
+	if (this->stdoutPipe.fd == -1 || this->stdoutPipe.paused) return;
+	this->emitStarted();
+	if (!SpawnedProcess::drain(this->stdoutPipe)) SpawnedProcess::closePipe(this->stdoutPipe);
+	if (!this->stdoutPipe.buffer.isEmpty()) emit this->readyReadStandardOutput();
+}
+
+void SpawnedProcess::onStderrActivated() {
+	if (this->stderrPipe.fd == -1 || this->stderrPipe.paused) return;
+	this->emitStarted();
+	if (!SpawnedProcess::drain(this->stderrPipe)) SpawnedProcess::closePipe(this->stderrPipe);
+	if (!this->stderrPipe.buffer.isEmpty()) emit this->readyReadStandardError();
+}
+
+void SpawnedProcess::onStdinActivated() { this->flushStdin(); }
+
+bool SpawnedProcess::drain(Pipe& pipe) {
+	auto chunk = std::array<char, 65536> {};
+
+	while (true) {
+		auto count = ::read(pipe.fd, chunk.data(), chunk.size());
+
+		if (count > 0) {
+			pipe.buffer.append(chunk.data(), count);
+		} else if (count == -1 && errno == EINTR) {
+			continue;
+		} else {
+			return count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+		}
+	}
+}
+
+void SpawnedProcess::closePipe(Pipe& pipe) {
+	if (pipe.notifier) {
+		pipe.notifier->setEnabled(false);
+		pipe.notifier->deleteLater();
+		pipe.notifier = nullptr;
+	}
+
+	closeFd(pipe.fd);
+}
+
+QByteArray SpawnedProcess::readAllStandardOutput() {
+	return std::exchange(this->stdoutPipe.buffer, QByteArray());
+}
+
+QByteArray SpawnedProcess::readAllStandardError() {
+	return std::exchange(this->stderrPipe.buffer, QByteArray());
+}
+
+void SpawnedProcess::closeReadChannel(QProcess::ProcessChannel channel) {
+	auto& pipe = channel == QProcess::StandardOutput ? this->stdoutPipe : this->stderrPipe;
+	SpawnedProcess::closePipe(pipe);
+	pipe.buffer.clear();
+}
+
+void SpawnedProcess::setReadChannelPaused(QProcess::ProcessChannel channel, bool paused) {
+	auto& pipe = channel == QProcess::StandardOutput ? this->stdoutPipe : this->stderrPipe;
+	if (paused == pipe.paused) return;
+	pipe.paused = paused;
+
+	// Data left in the pipe is reported again once the notifier is enabled.
+	if (pipe.notifier) pipe.notifier->setEnabled(!paused);
+}
+
+void SpawnedProcess::write(const QByteArray& data) {
+	if (this->stdinPipe.fd == -1 || this->closeStdinWhenFlushed) return;
+	this->stdinPipe.buffer.append(data);
+	this->flushStdin();
+}
+
+void SpawnedProcess::closeWriteChannel() {
+	this->closeStdinWhenFlushed = true;
+	this->flushStdin();
+}
+
+void SpawnedProcess::flushStdin() {
+	auto& pipe = this->stdinPipe;
+	if (pipe.fd == -1) return;
+
+	while (!pipe.buffer.isEmpty()) {
+		auto count = ::write(pipe.fd, pipe.buffer.constData(), pipe.buffer.size());
+
+		if (count > 0) {
+			pipe.buffer.remove(0, count);
+		} else if (count == -1 && errno == EINTR) {
+			continue;
+		} else if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			pipe.notifier->setEnabled(true);
+			return;
+		} else {
+			// the process closed its stdin
+			pipe.buffer.clear();
+			SpawnedProcess::closePipe(pipe);
+			return;
+		}
+	}
+
+	pipe.notifier->setEnabled(false);
+	if (this->closeStdinWhenFlushed) SpawnedProcess::closePipe(pipe);
+}
+
+void SpawnedProcess::terminate() {
+	if (this->pid != 0) ::kill(static_cast<pid_t>(this->pid), SIGTERM);
+}
+
+void SpawnedProcess::kill() {
+	if (this->pid != 0) ::kill(static_cast<pid_t>(this->pid), SIGKILL);
+}
+
+} // namespace qs::io::process
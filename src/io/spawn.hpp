@@ -0,0 +1,105 @@
+#pragma once
+
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
+#include <qobject.h>
+#include <qprocess.h>
+#include <qsocketnotifier.h>
+#include <qtclasshelpermacros.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+
+namespace qs::io::process {
+
+struct SpawnOptions {
+	QString program;
+	QList<QString> arguments;
+	QProcessEnvironment environment;
+	QString workingDirectory;
+	// Ignored for detached processes, as their output cannot be read.
+	bool readStdout = true;
+	bool readStderr = true;
+	bool writeStdin = true;
+	// Output that is not read is inherited from quickshell if set, instead of being
+	// sent to /dev/null.
+	bool inheritOutput = false;
+	// Starts the process in a new session with stdin bound to /dev/null, and does not
+	// report its output or exit status.
+	bool detached = false;
+};
+
+// Child process started with posix_spawn, which avoids copying the page tables of
+// the (large) parent process like QProcess's fork does. Exit is tracked with a pidfd.
+//
+// Mirrors the subset of the QProcess interface used by Process.
+class SpawnedProcess: public QObject {
+	Q_OBJECT;
+
+public:
+	explicit SpawnedProcess(QObject* parent = nullptr): QObject(parent) {}
+	~SpawnedProcess() override;
+	Q_DISABLE_COPY_MOVE(SpawnedProcess);
+
+	// Returns false if the system does not support pidfds, in which case QProcess
+	// should be used instead. Spawn failures are reported through errorOccurred.
+	bool start(const SpawnOptions& options);
+
+	// Starts a detached process that is reaped in the background.
+	static bool startDetached(SpawnOptions options);
+
+	[[nodiscard]] qint64 processId() const { return this->pid; }
+
+	QByteArray readAllStandardOutput();
+	QByteArray readAllStandardError();
+	void closeReadChannel(QProcess::ProcessChannel channel);
+	// Stops reading from the channel's pipe while paused, so a process writing faster than
+	// its output is consumed blocks instead of being buffered without bound.
+	void setReadChannelPaused(QProcess::ProcessChannel channel, bool paused);
+
+	void write(const QByteArray& data);
+	void closeWriteChannel();
+
+	void terminate();
+	void kill();
+
+	// Returns true if pidfd_open is supported by the running kernel.
+	static bool isSupported();
+
+signals:
+	void started();
+	void finished(qint32 exitCode, QProcess::ExitStatus exitStatus);
+	void errorOccurred(QProcess::ProcessError error);
+	void readyReadStandardOutput();
+	void readyReadStandardError();
+
+private slots:
+	void emitStarted();
+	void onPidfdActivated();
+	void onStdoutActivated();
+	void onStderrActivated();
+	void onStdinActivated();
+
+private:
+	struct Pipe {
+		int fd = -1;
+		QSocketNotifier* notifier = nullptr;
+		QByteArray buffer;
+		bool paused = false;
+	};
+
+	// Reads everything currently available, returning false on EOF or error.
+	static bool drain(Pipe& pipe);
+	static void closePipe(Pipe& pipe);
+	void flushStdin();
+
+	qint64 pid = 0;
+	int pidfd = -1;
+	QSocketNotifier* pidfdNotifier = nullptr;
+	Pipe stdoutPipe;
+	Pipe stderrPipe;
+	Pipe stdinPipe;
+	bool closeStdinWhenFlushed = false;
+	bool startPending = false;
+};
+
+} // namespace qs::io::process
@@ -0,0 +1,111 @@
+#include "commandpoller.hpp"
+
+#include <qfile.h>
+#include <qiodevice.h>
+#include <qsignalspy.h>
+#include <qtemporaryfile.h>
+#include <qtest.h>
+#include <qtestcase.h>
+
+#include "../commandpoller.hpp"
+
+namespace {
+
+void writeFile(QFile& file, const QByteArray& content) {
+	file.resize(0);
+	file.write(content);
+	file.flush();
+}
+
+} // namespace
+
+void TestCommandPoller::sharedJobs() {
+	auto* registry = CommandPollerRegistry::forGeneration(nullptr);
+	auto jobCount = registry->jobCount();
+
+	auto a = CommandPoller();
+	auto b = CommandPoller();
+	auto c = CommandPoller();
+	auto aSpy = QSignalSpy(&a, &CommandPoller::outputChanged);
+	auto bSpy = QSignalSpy(&b, &CommandPoller::outputChanged);
+
+	a.setCommand({"echo", "shared"});
+	b.setCommand({"echo", "shared"});
+	c.setCommand({"echo", "other"});
+
+	a.postReload();
+	b.postReload();
+	c.postReload();
+
+	QCOMPARE(registry->jobCount(), jobCount + 2);
+
+	QVERIFY(aSpy.wait(1000));
+	if (bSpy.isEmpty()) QVERIFY(bSpy.wait(1000));
+	QCOMPARE(a.output(), "shared\n");
+	QCOMPARE(b.output(), "shared\n");
+
+	b.setEnvironment({{"QS_TEST_VAR", "1"}});
+	QCOMPARE(registry->jobCount(), jobCount + 3);
+
+	c.setCommand({"echo", "shared"});
+	QCOMPARE(registry->jobCount(), jobCount + 2);
+	// the shared job's output is available immediately
+	QCOMPARE(c.output(), "shared\n");
+}
+
+void TestCommandPoller::changedOutput() {
+	auto file = QTemporaryFile();
+	QVERIFY(file.open());
+	writeFile(file, "a");
+
+	auto poller = CommandPoller();
+	auto spy = QSignalSpy(&poller, &CommandPoller::outputChanged);
+
+	poller.setInterval(20);
+	poller.setCommand({"cat", file.fileName()});
+	poller.postReload();
+
+	QVERIFY(spy.wait(1000));
+	QCOMPARE(poller.output(), "a");
+
+	// unchanged output across several runs is not reported
+	QTest::qWait(200);
+	QCOMPARE(spy.count(), 1);
+
+	writeFile(file, "b");
+	QVERIFY(spy.wait(1000));
+	QCOMPARE(spy.count(), 2);
+	QCOMPARE(poller.output(), "b");
+
+	poller.setRunning(false);
+	writeFile(file, "c");
+	QTest::qWait(200);
+	QCOMPARE(poller.output(), "b");
+
+	poller.refresh();
+	QVERIFY(spy.wait(1000));
+	QCOMPARE(poller.output(), "c");
+}
+
+void TestCommandPoller::alignedRuns() {
+	auto* registry = CommandPollerRegistry::forGeneration(nullptr);
+
+	auto a = CommandPoller();
+	auto b = CommandPoller();
+	a.setInterval(100);
+	b.setInterval(100);
+	a.setCommand({"echo", "a"});
+	b.setCommand({"echo", "b"});
+	a.postReload();
+	b.postReload();
+
+	auto* aJob = registry->subscribe(&a, {"echo", "a"}, {}, {});
+	auto* bJob = registry->subscribe(&b, {"echo", "b"}, {}, {});
+	QCOMPARE(aJob->nextRun % 100, 0);
+	QCOMPARE(aJob->nextRun, bJob->nextRun);
+
+	registry->unsubscribe(&a, aJob);
+	registry->unsubscribe(&b, bJob);
+}
+
+QTEST_MAIN(TestCommandPoller);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+class TestCommandPoller: public QObject {
+	Q_OBJECT;
+
+private slots:
+	static void sharedJobs();
+	static void changedOutput();
+	static void alignedRuns();
+};
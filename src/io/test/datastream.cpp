@@ -1,12 +1,15 @@
 #include "datastream.hpp"
 
 #include <qbytearray.h>
+#include <qcontainerfwd.h>
 #include <qlist.h>
 #include <qlogging.h>
 #include <qobject.h>
 #include <qsignalspy.h>
 #include <qtest.h>
 #include <qtestcase.h>
+#include <qtypes.h>
+#include <qvariant.h>
 
 #include "../datastream.hpp"
 
@@ -103,4 +106,105 @@ void TestSplitParser::initBuffer() { // NOLINT
 	QCOMPARE(buf, "baz");
 }
 
+void TestSplitParser::bytesAndBatch() { // NOLINT
+	auto parser = SplitParser();
+	auto readSpy = QSignalSpy(&parser, &DataStreamParser::read);
+	auto bytesSpy = QSignalSpy(&parser, &SplitParser::readBytes);
+	auto batchSpy = QSignalSpy(&parser, &SplitParser::readBatch);
+
+	parser.setSplitMarker("--");
+	parser.setBytes(true);
+
+	auto buffer = QByteArray("foo-");
+	auto incoming = QByteArray("-bar--baz");
+	parser.parseBytes(incoming, buffer);
+
+	QCOMPARE(readSpy.length(), 0);
+	QCOMPARE(bytesSpy.length(), 2);
+	QCOMPARE(bytesSpy.at(0).at(0).toByteArray(), "foo");
+	QCOMPARE(bytesSpy.at(1).at(0).toByteArray(), "bar");
+	QCOMPARE(buffer, "baz");
+
+	parser.setBatch(true);
+	incoming = "--qux--quux";
+	parser.parseBytes(incoming, buffer);
+
+	QCOMPARE(bytesSpy.length(), 2);
+	QCOMPARE(batchSpy.length(), 1);
+	auto batch = batchSpy.at(0).at(0).toList();
+	QCOMPARE(batch.length(), 2);
+	QCOMPARE(batch.at(0).toByteArray(), "baz");
+	QCOMPARE(batch.at(1).toByteArray(), "qux");
+	QCOMPARE(buffer, "quux");
+
+	// reads without a complete chunk do not emit an empty batch
+	incoming = "quuux";
+	parser.parseBytes(incoming, buffer);
+	QCOMPARE(batchSpy.length(), 1);
+	QCOMPARE(buffer, "quuxquuux");
+
+	parser.setBytes(false);
+	parser.streamEnded(buffer);
+	QCOMPARE(batchSpy.length(), 2);
+	QCOMPARE(batchSpy.at(1).at(0).toList(), QVariantList({QString("quuxquuux")}));
+}
+
+void TestSplitParser::benchmarkSplit_data() { // NOLINT
+	QTest::addColumn<QString>("mark");
+	QTest::addColumn<bool>("bytes");
+	QTest::addColumn<bool>("batch");
+
+	QTest::addRow("newline") << "\n" << false << false;
+	QTest::addRow("multichar") << "\r\n" << false << false;
+	QTest::addRow("bytes") << "\n" << true << false;
+	QTest::addRow("batch") << "\n" << false << true;
+	QTest::addRow("bytes-batch") << "\n" << true << true;
+}
+
+void TestSplitParser::benchmarkSplit() { // NOLINT
+	// NOLINTBEGIN
+	QFETCH(QString, mark);
+	QFETCH(bool, bytes);
+	QFETCH(bool, batch);
+	// NOLINTEND
+
+	// Roughly 8MB of journal-like lines, read in 64KB chunks.
+	auto data = QByteArray();
+	auto markBytes = mark.toUtf8();
+	for (auto i = 0; data.length() < 8 * 1024 * 1024; i++) {
+		data.append("Oct 17 12:00:00 host systemd[1]: Started session ");
+		data.append(QByteArray::number(i));
+		data.append(" of user someone with a reasonably long trailing message.");
+		data.append(markBytes);
+	}
+
+	constexpr qsizetype READ_SIZE = 64 * 1024;
+
+	qsizetype chunks = 0;
+
+	QBENCHMARK {
+		auto parser = SplitParser();
+		parser.setSplitMarker(mark);
+		parser.setBytes(bytes);
+		parser.setBatch(batch);
+
+		chunks = 0;
+		QObject::connect(&parser, &DataStreamParser::read, [&]() { chunks++; });
+		QObject::connect(&parser, &SplitParser::readBytes, [&]() { chunks++; });
+		QObject::connect(&parser, &SplitParser::readBatch, [&](const QVariantList& list) {
+			chunks += list.length();
+		});
+
+		auto buffer = QByteArray();
+		for (qsizetype offset = 0; offset < data.length(); offset += READ_SIZE) {
+			auto incoming = data.sliced(offset, qMin(READ_SIZE, data.length() - offset));
+			parser.parseBytes(incoming, buffer);
+		}
+
+		parser.streamEnded(buffer);
+	}
+
+	QVERIFY(chunks > 0);
+}
+
 QTEST_MAIN(TestSplitParser);
@@ -10,4 +10,8 @@ private slots:
 	void splits_data(); // NOLINT
 	void splits();
 	void initBuffer();
+	void bytesAndBatch();
+
+	void benchmarkSplit_data(); // NOLINT
+	void benchmarkSplit();
 };
@@ -1,10 +1,14 @@
 #include "process.hpp"
 
 #include <qlist.h>
+#include <qprocess.h>
 #include <qsignalspy.h>
+#include <qstring.h>
 #include <qtest.h>
 #include <qtestcase.h>
+#include <qtypes.h>
 
+#include "../datastream.hpp"
 #include "../process.hpp"
 
 void TestProcess::startAfterReload() {
@@ -44,4 +48,107 @@ void TestProcess::testExec() {
 	QVERIFY(process.isRunning());
 }
 
+void TestProcess::fastSpawnOutput() {
+	auto process = Process();
+	auto collector = StdioCollector();
+	auto exitedSpy = QSignalSpy(&process, &Process::exited);
+
+	process.postReload();
+	process.setFastSpawn(true);
+	process.setStdoutParser(&collector);
+	process.setCommand({"sh", "-c", "echo $QS_TEST_VAR; pwd; exit 3"});
+	process.setEnvironment({{"QS_TEST_VAR", "hello"}});
+	process.setWorkingDirectory("/");
+	process.setRunning(true);
+
+	QVERIFY(process.isRunning());
+	QVERIFY(process.processId().toLongLong() != 0);
+	QVERIFY(exitedSpy.wait(1000));
+
+	QCOMPARE(exitedSpy.at(0).at(0).toInt(), 3);
+	QCOMPARE(exitedSpy.at(0).at(1).value<QProcess::ExitStatus>(), QProcess::NormalExit);
+	QCOMPARE(collector.text(), "hello\n/\n");
+	QVERIFY(!process.isRunning());
+}
+
+void TestProcess::fastSpawnStdin() {
+	auto process = Process();
+	auto collector = StdioCollector();
+	auto exitedSpy = QSignalSpy(&process, &Process::exited);
+
+	process.postReload();
+	process.setFastSpawn(true);
+	process.setStdoutParser(&collector);
+	process.setStdinEnabled(true);
+	process.setCommand({"cat"});
+	process.setRunning(true);
+
+	process.write("foo\n");
+	process.write("bar\n");
+	process.setStdinEnabled(false);
+
+	QVERIFY(exitedSpy.wait(1000));
+	QCOMPARE(collector.text(), "foo\nbar\n");
+}
+
+void TestProcess::fastSpawnFailure() {
+	auto process = Process();
+	auto startedSpy = QSignalSpy(&process, &Process::started);
+
+	process.postReload();
+	process.setFastSpawn(true);
+	process.setCommand({"quickshell-test-nonexistent-command"});
+	process.setRunning(true);
+
+	QVERIFY(!process.isRunning());
+	QVERIFY(!startedSpy.wait(100));
+}
+
+void TestProcess::fastSpawnBackpressure() {
+	constexpr qsizetype SIZE = 1024 * 1024;
+
+	auto process = Process();
+	auto parser = BusyParser();
+	auto exitedSpy = QSignalSpy(&process, &Process::exited);
+
+	parser.setBusy(true);
+	process.postReload();
+	process.setFastSpawn(true);
+	process.setStdoutParser(&parser);
+	process.setCommand({"head", "-c", QString::number(SIZE), "/dev/zero"});
+	process.setRunning(true);
+
+	// Output is not read while the parser is busy, so the process blocks once the pipe is full.
+	QVERIFY(!exitedSpy.wait(200));
+	QCOMPARE(parser.received, static_cast<qsizetype>(0));
+
+	parser.setBusy(false);
+	QVERIFY(exitedSpy.wait(1000));
+	QCOMPARE(parser.received, SIZE);
+}
+
+void TestProcess::benchmarkSpawn_data() { // NOLINT
+	QTest::addColumn<bool>("fastSpawn");
+	QTest::addRow("qprocess") << false;
+	QTest::addRow("posix_spawn") << true;
+}
+
+void TestProcess::benchmarkSpawn() {
+	QFETCH(bool, fastSpawn); // NOLINT
+
+	auto process = Process();
+	auto collector = StdioCollector();
+	process.postReload();
+	process.setFastSpawn(fastSpawn);
+	process.setStdoutParser(&collector);
+	process.setCommand({"true"});
+
+	// Time from starting a short command until its exit is reported.
+	QBENCHMARK {
+		auto exitedSpy = QSignalSpy(&process, &Process::exited);
+		process.setRunning(true);
+		QVERIFY(exitedSpy.wait(1000));
+	}
+}
+
 QTEST_MAIN(TestProcess);
@@ -1,7 +1,33 @@
 #pragma once
 
+#include <qbytearray.h>
 #include <qobject.h>
 #include <qtmetamacros.h>
+#include <qtypes.h>
+
+#include "../datastream.hpp"
+
+// Counts received bytes, and reports being busy while set.
+class BusyParser: public DataStreamParser {
+	Q_OBJECT;
+
+public:
+	void parseBytes(QByteArray& incoming, QByteArray& /*buffer*/) override {
+		this->received += incoming.length();
+	}
+
+	[[nodiscard]] bool isBusy() const override { return this->busy; }
+
+	void setBusy(bool busy) {
+		this->busy = busy;
+		if (!busy) emit this->readyForData();
+	}
+
+	qsizetype received = 0;
+
+private:
+	bool busy = false;
+};
 
 class TestProcess: public QObject {
 	Q_OBJECT;
@@ -9,4 +35,11 @@ class TestProcess: public QObject {
 private slots:
 	static void startAfterReload();
 	static void testExec();
+	static void fastSpawnOutput();
+	static void fastSpawnStdin();
+	static void fastSpawnFailure();
+	static void fastSpawnBackpressure();
+
+	void benchmarkSpawn_data(); // NOLINT
+	void benchmarkSpawn();
 };
@@ -0,0 +1,134 @@
+#include "recordparser.hpp"
+
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
+#include <qlist.h>
+#include <qsignalspy.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+#include <qvariant.h>
+
+#include "../recordparser.hpp"
+
+namespace {
+
+QVariantList collect(QSignalSpy& spy) {
+	auto records = QVariantList();
+	for (const auto& emission: spy) records.append(emission.at(0).toList());
+	return records;
+}
+
+QByteArray frame(const QByteArray& payload, bool littleEndian) {
+	auto length = static_cast<quint32>(payload.length());
+	auto header = QByteArray(4, 0);
+
+	for (auto i = 0; i < 4; i++) {
+		auto shift = littleEndian ? i * 8 : (3 - i) * 8;
+		header[i] = static_cast<char>((length >> shift) & 0xff);
+	}
+
+	return header + payload;
+}
+
+} // namespace
+
+void TestRecordParser::jsonLines() {
+	auto parser = JsonLinesParser();
+	auto spy = QSignalSpy(&parser, &RecordParser::records);
+
+	auto buffer = QByteArray();
+	auto incoming = QByteArray("{\"a\": 1}\n\n  \n{\"b\"");
+	parser.parseBytes(incoming, buffer);
+	QCOMPARE(buffer, "{\"b\"");
+
+	incoming = ": [1, 2]}\nnot json\n[3]";
+	parser.parseBytes(incoming, buffer);
+	QCOMPARE(buffer, "[3]");
+
+	parser.streamEnded(buffer);
+	QVERIFY(buffer.isEmpty());
+
+	QTRY_COMPARE(collect(spy).length(), 3);
+	auto records = collect(spy);
+	QCOMPARE(records.at(0).toMap().value("a").toInt(), 1);
+	QCOMPARE(records.at(1).toMap().value("b").toList().length(), 2);
+	QCOMPARE(records.at(2).toList().at(0).toInt(), 3);
+}
+
+void TestRecordParser::framed() {
+	for (auto littleEndian: {false, true}) {
+		auto parser = FramedParser();
+		auto spy = QSignalSpy(&parser, &RecordParser::records);
+		parser.setLittleEndian(littleEndian);
+		parser.setFormat(RecordFormat::Text);
+
+		auto data = frame("foo", littleEndian) + frame("", littleEndian)
+		          + frame(QByteArray(300, 'x'), littleEndian) + frame("bar", littleEndian);
+
+		// feed the stream one byte at a time to split every header and payload
+		auto buffer = QByteArray();
+		for (auto i = 0; i < data.length(); i++) {
+			auto incoming = data.sliced(i, 1);
+			parser.parseBytes(incoming, buffer);
+		}
+
+		QVERIFY(buffer.isEmpty());
+		QTRY_COMPARE(collect(spy).length(), 4);
+
+		auto records = collect(spy);
+		QCOMPARE(records.at(0).toString(), "foo");
+		QCOMPARE(records.at(1).toString(), "");
+		QCOMPARE(records.at(2).toString(), QString(300, 'x'));
+		QCOMPARE(records.at(3).toString(), "bar");
+	}
+}
+
+void TestRecordParser::framedHeader() {
+	auto parser = FramedParser();
+	auto spy = QSignalSpy(&parser, &RecordParser::records);
+
+	// i3 ipc style header: magic, length, type
+	parser.setLengthOffset(6);
+	parser.setHeaderSize(14);
+	parser.setLittleEndian(true);
+	parser.setIncludeHeader(true);
+
+	auto payload = QByteArray("{\"change\":\"focus\"}");
+	auto data = QByteArray("i3-ipc") + frame(payload, true).first(4) + QByteArray("\x03\0\0\x80", 4)
+	          + payload;
+
+	auto buffer = QByteArray();
+	parser.parseBytes(data, buffer);
+	QVERIFY(buffer.isEmpty());
+
+	QTRY_COMPARE(spy.length(), 1);
+	auto record = collect(spy).at(0).toMap();
+	QCOMPARE(record.value("header").toByteArray(), data.first(14));
+	QCOMPARE(record.value("payload").toMap().value("change").toString(), "focus");
+}
+
+void TestRecordParser::coalesce() {
+	auto parser = JsonLinesParser();
+	auto spy = QSignalSpy(&parser, &RecordParser::records);
+
+	constexpr qsizetype COUNT = 1000;
+
+	auto buffer = QByteArray();
+	for (qsizetype i = 0; i < COUNT; i++) {
+		auto incoming = '[' + QByteArray::number(i) + "]\n";
+		parser.parseBytes(incoming, buffer);
+	}
+
+	QTRY_COMPARE(collect(spy).length(), COUNT);
+
+	// reads are batched while a decode is running
+	QVERIFY(spy.length() < COUNT);
+
+	auto records = collect(spy);
+	for (qsizetype i = 0; i < COUNT; i++) {
+		QCOMPARE(records.at(i).toList().at(0).toLongLong(), i);
+	}
+}
+
+QTEST_MAIN(TestRecordParser);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+class TestRecordParser: public QObject {
+	Q_OBJECT;
+
+private slots:
+	static void jsonLines();
+	static void framed();
+	static void framedHeader();
+	static void coalesce();
+};
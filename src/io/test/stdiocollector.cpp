@@ -0,0 +1,86 @@
+#include "stdiocollector.hpp"
+
+#include <qbytearray.h>
+#include <qsignalspy.h>
+#include <qtest.h>
+#include <qtestcase.h>
+
+#include "../datastream.hpp"
+
+void TestStdioCollector::ringBuffer() {
+	auto ring = ByteRingBuffer();
+	ring.setCapacity(8);
+
+	QCOMPARE(ring.append("abc"), 0);
+	QCOMPARE(ring.append("defgh"), 0);
+	QCOMPARE(ring.toByteArray(), "abcdefgh");
+
+	QCOMPARE(ring.append("ij"), 2);
+	QCOMPARE(ring.toByteArray(), "cdefghij");
+
+	QCOMPARE(ring.append("klmnopqrstu"), 11);
+	QCOMPARE(ring.toByteArray(), "nopqrstu");
+
+	QCOMPARE(ring.append("vwxyz"), 5);
+	QCOMPARE(ring.toByteArray(), "stuvwxyz");
+
+	ring.setCapacity(4);
+	QCOMPARE(ring.toByteArray(), "wxyz");
+
+	ring.setCapacity(6);
+	QCOMPARE(ring.append("12"), 0);
+	QCOMPARE(ring.toByteArray(), "wxyz12");
+
+	ring.clear();
+	QVERIFY(ring.isEmpty());
+	QCOMPARE(ring.toByteArray(), "");
+}
+
+void TestStdioCollector::bounded() {
+	auto collector = StdioCollector();
+	auto dataSpy = QSignalSpy(&collector, &StdioCollector::dataChanged);
+	auto overflowSpy = QSignalSpy(&collector, &StdioCollector::overflowed);
+
+	collector.setWaitForEnd(false);
+	collector.setMaxBytes(6);
+
+	auto buffer = QByteArray();
+	for (const auto* chunk: {"abc", "def", "ghi", "jkl"}) {
+		auto incoming = QByteArray(chunk);
+		collector.parseBytes(incoming, buffer);
+	}
+
+	QVERIFY(buffer.isEmpty());
+	QCOMPARE(collector.data(), "ghijkl");
+	QCOMPARE(collector.droppedBytes(), 6);
+	QCOMPARE(dataSpy.length(), 4);
+	QCOMPARE(overflowSpy.length(), 1);
+
+	collector.streamEnded(buffer);
+	QCOMPARE(collector.data(), "ghijkl");
+	QCOMPARE(collector.droppedBytes(), 6);
+
+	// the next stream starts empty
+	auto incoming = QByteArray("mno");
+	collector.parseBytes(incoming, buffer);
+	QCOMPARE(collector.data(), "mno");
+	QCOMPARE(collector.droppedBytes(), 0);
+}
+
+void TestStdioCollector::unboundDuringStream() {
+	auto collector = StdioCollector();
+	collector.setMaxBytes(4);
+
+	auto buffer = QByteArray();
+	auto incoming = QByteArray("abcdef");
+	collector.parseBytes(incoming, buffer);
+
+	collector.setMaxBytes(0);
+	incoming = "ghi";
+	collector.parseBytes(incoming, buffer);
+
+	collector.streamEnded(buffer);
+	QCOMPARE(collector.data(), "cdefghi");
+}
+
+QTEST_MAIN(TestStdioCollector);
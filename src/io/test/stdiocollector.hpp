@@ -0,0 +1,13 @@
+#pragma once
+
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+class TestStdioCollector: public QObject {
+	Q_OBJECT;
+
+private slots:
+	static void ringBuffer();
+	static void bounded();
+	static void unboundDuringStream();
+};
@@ -3,6 +3,8 @@
 #include <variant>
 
 #include <qbuffer.h>
+#include <qbytearray.h>
+#include <qjsondocument.h>
 #include <qlocalserver.h>
 #include <qlocalsocket.h>
 #include <qlogging.h>
@@ -12,6 +14,7 @@
 #include "../core/generation.hpp"
 #include "../core/logcat.hpp"
 #include "../core/paths.hpp"
+#include "../core/reloadstats.hpp"
 #include "ipccommand.hpp"
 
 namespace qs::ipc {
@@ -102,6 +105,11 @@ void IpcClient::waitForDisconnected() { this->socket.waitForDisconnected(); }
 
 void IpcClient::kill() { this->sendMessage(IpcCommand(IpcKillCommand())); }
 
+bool IpcClient::queryReloadStats(QByteArray& json) {
+	this->sendMessage(IpcCommand(IpcReloadStatsCommand()));
+	return this->waitForResponse(json);
+}
+
 void IpcClient::onError(QLocalSocket::LocalSocketError error) {
 	qCCritical(logIpc) << "Socket Error" << error;
 }
@@ -124,4 +132,9 @@ void IpcKillCommand::exec(IpcServerConnection* /*unused*/) {
 	EngineGeneration::currentGeneration()->quit();
 }
 
+void IpcReloadStatsCommand::exec(IpcServerConnection* conn) {
+	auto history = ReloadStatsLog::instance()->toJson();
+	conn->respond(QJsonDocument(history).toJson(QJsonDocument::Compact));
+}
+
 } // namespace qs::ipc
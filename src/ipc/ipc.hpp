@@ -6,6 +6,7 @@
 #include <utility>
 #include <variant>
 
+#include <qbytearray.h>
 #include <qflags.h>
 #include <qlocalserver.h>
 #include <qlocalsocket.h>
@@ -184,6 +185,8 @@ public:
 	void waitForDisconnected();
 
 	void kill();
+	// Returns false if no response was received.
+	bool queryReloadStats(QByteArray& json);
 
 	template <typename T>
 	void sendMessage(const T& message) {
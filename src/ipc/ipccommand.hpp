@@ -11,11 +11,17 @@ struct IpcKillCommand: std::monostate {
 	static void exec(IpcServerConnection* /*unused*/);
 };
 
+// Responds with a json array of recent reload statistics.
+struct IpcReloadStatsCommand: std::monostate {
+	static void exec(IpcServerConnection* conn);
+};
+
 using IpcCommand = std::variant<
     std::monostate,
     IpcKillCommand,
     qs::io::ipc::comm::QueryMetadataCommand,
     qs::io::ipc::comm::StringCallCommand,
-    qs::io::ipc::comm::StringPropReadCommand>;
+    qs::io::ipc::comm::StringPropReadCommand,
+    IpcReloadStatsCommand>;
 
 } // namespace qs::ipc
@@ -21,6 +21,8 @@
 #include <qlogging.h>
 #include <qloggingcategory.h>
 #include <qnamespace.h>
+#include <qstring.h>
+#include <qstringlist.h>
 #include <qstandardpaths.h>
 #include <qtenvironmentvariables.h>
 #include <qtversion.h>
@@ -264,9 +266,33 @@ int selectInstance(CommandState& cmd, InstanceLockInfo* instance, bool deadFallb
 	return 0;
 }
 
+// Parses ISO 8601 date-times, or a time of day which is taken to be today.
+bool parseLogTime(const QString& str, QDateTime* time) {
+	if (str.isEmpty()) return true;
+
+	*time = QDateTime::fromString(str, Qt::ISODate);
+	if (time->isValid()) return true;
+
+	*time = QDateTime::fromString(str, "yyyy-MM-dd hh:mm:ss");
+	if (time->isValid()) return true;
+
+	auto timeOfDay = QTime::fromString(str, Qt::ISODate);
+	if (timeOfDay.isValid()) {
+		*time = QDateTime(QDate::currentDate(), timeOfDay);
+		return true;
+	}
+
+	qCCritical(logBare) << "Could not parse time" << str;
+	return false;
+}
+
 int readLogFile(CommandState& cmd) {
 	auto path = *cmd.log.file;
 
+	QDateTime since;
+	QDateTime until;
+	if (!parseLogTime(*cmd.log.since, &since) || !parseLogTime(*cmd.log.until, &until)) return -1;
+
 	if (path.isEmpty()) {
 		InstanceLockInfo instance;
 		auto r = selectInstance(cmd, &instance, true);
@@ -287,7 +313,11 @@ int readLogFile(CommandState& cmd) {
 	           cmd.log.timestamp,
 	           cmd.log.tail,
 	           cmd.log.follow,
-	           *cmd.log.readoutRules
+	           *cmd.log.readoutRules,
+	           since,
+	           until,
+	           *cmd.log.grep,
+	           cmd.output.json
 	       )
 	         ? 0
 	         : -1;
@@ -402,6 +432,69 @@ int killInstances(CommandState& cmd) {
 	});
 }
 
+int printReloadStats(CommandState& cmd) {
+	InstanceLockInfo instance;
+	auto r = selectInstance(cmd, &instance);
+	if (r != 0) return r;
+
+	QByteArray json;
+	auto received = false;
+
+	r = IpcClient::connect(instance.instance.instanceId, [&](IpcClient& client) {
+		received = client.queryReloadStats(json);
+	});
+
+	if (r != 0) return r;
+	if (!received) return -1;
+
+	if (cmd.output.json) {
+		qCInfo(logBare).noquote() << json;
+		return 0;
+	}
+
+	auto history = QJsonDocument::fromJson(json).array();
+
+	if (history.isEmpty()) {
+		qCInfo(logBare) << "No reloads recorded.";
+		return 0;
+	}
+
+	auto ms = [](const QJsonValue& value) {
+		return QString::number(value.toDouble(), 'f', 1) + "ms";
+	};
+
+	auto mib = [](const QJsonValue& value) {
+		return QString::number(value.toDouble() / (1024 * 1024), 'f', 1) + "MiB";
+	};
+
+	for (const auto& entry: history) {
+		auto stats = entry.toObject();
+		auto phases = stats.value("phases").toObject();
+		auto heap = stats.value("jsHeap").toObject();
+
+		QStringList phaseStrs;
+		for (const auto* name: {"scan", "compile", "create", "reload", "postReload", "destroy", "gc"}) {
+			if (!phases.contains(name)) continue;
+			phaseStrs.append(QString::fromLatin1(name) + ' ' + ms(phases.value(name)));
+		}
+
+		QString status;
+		if (!stats.value("success").toBool()) status = " (failed)";
+		else if (!stats.value("complete").toBool()) status = " (interrupted)";
+
+		auto total = stats.contains("total") ? " in " + ms(stats.value("total")) : QString();
+
+		qCInfo(logBare).noquote().nospace()
+		    << stats.value("time").toString() << ' ' << stats.value("kind").toString() << status
+		    << total << "\n  " << phaseStrs.join(", ") << "\n  "
+		    << stats.value("scannedFiles").toInteger() << " files, "
+		    << stats.value("objects").toInteger() << " objects, js heap " << mib(heap.value("used"))
+		    << " used / " << mib(heap.value("allocated")) << " allocated";
+	}
+
+	return 0;
+}
+
 int ipcCommand(CommandState& cmd) {
 	InstanceLockInfo instance;
 	auto r = selectInstance(cmd, &instance);
@@ -537,6 +630,8 @@ int runCommand(int argc, char** argv, QCoreApplication* coreApplication) {
 		return listInstances(state);
 	} else if (*state.subcommand.kill) {
 		return killInstances(state);
+	} else if (*state.subcommand.reloads) {
+		return printReloadStats(state);
 	} else if (*state.subcommand.msg || *state.ipc.ipc) {
 		return ipcCommand(state);
 	} else {
@@ -181,17 +181,6 @@ int launch(const LaunchArgs& args, char** argv, QCoreApplication* coreApplicatio
 		qputenv(var.toUtf8(), val.toUtf8());
 	}
 
-	// The qml engine currently refuses to cache non file (qsintercept) paths.
-
-	// if (auto* cacheDir = QsPaths::instance()->cacheDir()) {
-	// 	auto qmlCacheDir = cacheDir->filePath("qml-engine-cache");
-	// 	qputenv("QML_DISK_CACHE_PATH", qmlCacheDir.toLocal8Bit());
-	//
-	// 	if (!qEnvironmentVariableIsSet("QML_DISK_CACHE")) {
-	// 		qputenv("QML_DISK_CACHE", "aot,qmlc");
-	// 	}
-	// }
-
 	// While the simple animation driver can lead to better animations in some cases,
 	// it also can cause excessive repainting at excessively high framerates which can
 	// lead to noticeable amounts of gpu usage, including overheating on some systems.
@@ -43,6 +43,9 @@ struct CommandState {
 		QStringOption rules;
 		QStringOption readoutRules;
 		QStringOption file;
+		QStringOption since;
+		QStringOption until;
+		QStringOption grep;
 	} log;
 
 	struct {
@@ -84,6 +87,7 @@ struct CommandState {
 		CLI::App* log = nullptr;
 		CLI::App* list = nullptr;
 		CLI::App* kill = nullptr;
+		CLI::App* reloads = nullptr;
 		CLI::App* msg = nullptr;
 	} subcommand;
 
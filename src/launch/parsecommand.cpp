@@ -160,6 +160,21 @@ int parseCommand(int argc, char** argv, CommandState& state) {
 		sub->add_option("-r,--rules", state.log.readoutRules, "Log file to read.")
 		    ->description("Rules to apply to the log being read, in the format of QT_LOGGING_RULES.");
 
+		sub->add_option("--since", state.log.since)
+		    ->description(
+		        "Only print messages logged at or after the given time.\n"
+		        "Accepts ISO 8601 date-times (2025-01-01T12:00:00) or a time of day (12:00:00)."
+		    );
+
+		sub->add_option("--until", state.log.until)
+		    ->description("Only print messages logged at or before the given time. See --since.");
+
+		sub->add_option("-g,--grep", state.log.grep)
+		    ->description("Only print messages matching the given regular expression.");
+
+		sub->add_flag("-j,--json", state.output.json)
+		    ->description("Print messages as JSON objects, one per line.");
+
 		auto* instance = addInstanceSelection(sub)->excludes(file);
 		addConfigSelection(sub, true)->excludes(instance)->excludes(file);
 		addLoggingOptions(sub, false);
@@ -198,6 +213,19 @@ int parseCommand(int argc, char** argv, CommandState& state) {
 		state.subcommand.kill = sub;
 	}
 
+	{
+		auto* sub =
+		    cli->add_subcommand("reloads", "Print timing and memory statistics of recent reloads.");
+
+		sub->add_flag("-j,--json", state.output.json, "Output the statistics as a json array.");
+
+		auto* instance = addInstanceSelection(sub);
+		addConfigSelection(sub, true)->excludes(instance);
+		addLoggingOptions(sub, false, true);
+
+		state.subcommand.reloads = sub;
+	}
+
 	{
 		auto* sub = cli->add_subcommand("ipc", "Communicate with other Quickshell instances.")
 		                ->require_subcommand();
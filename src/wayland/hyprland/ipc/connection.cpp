@@ -1,5 +1,4 @@
 #include "connection.hpp"
-#include <algorithm>
 #include <functional>
 #include <utility>
 
@@ -16,7 +15,9 @@
 #include <qobject.h>
 #include <qproperty.h>
 #include <qqml.h>
+#include <qset.h>
 #include <qtenvironmentvariables.h>
+#include <qtimer.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
 #include <qvariant.h>
@@ -35,6 +36,14 @@ namespace qs::hyprland::ipc {
 namespace {
 QS_LOGGING_CATEGORY(logHyprlandIpc, "quickshell.hyprland.ipc", QtWarningMsg);
 QS_LOGGING_CATEGORY(logHyprlandIpcEvents, "quickshell.hyprland.ipc.events", QtWarningMsg);
+
+// Delay before a refresh after an event that could not be applied exactly, so bursts
+// of such events are coalesced.
+constexpr qint32 RECONCILE_DELAY_MS = 250;
+// Interval of full refreshes correcting drift from missed or inexact events.
+constexpr qint32 RECONCILE_INTERVAL_MS = 60000;
+// Number of events kept for HyprlandIpc::recentEvents.
+constexpr qsizetype EVENT_HISTORY_SIZE = 128;
 } // namespace
 
 HyprlandIpc::HyprlandIpc() {
@@ -63,6 +72,7 @@ HyprlandIpc::HyprlandIpc() {
 
 	this->mRequestSocketPath = hyprlandDir + "/.socket.sock";
 	this->mEventSocketPath = hyprlandDir + "/.socket2.sock";
+	this->requests.setSocketPath(this->mRequestSocketPath);
 
 	// clang-format off
 	QObject::connect(&this->eventSocket, &QLocalSocket::errorOccurred, this, &HyprlandIpc::eventSocketError);
@@ -72,12 +82,15 @@ HyprlandIpc::HyprlandIpc() {
 	auto *instance = HyprlandToplevelMappingManager::instance();
 	QObject::connect(instance, &HyprlandToplevelMappingManager::toplevelAddressed, this, &HyprlandIpc::toplevelAddressed);
 
+	QObject::connect(&this->reconcileTimer, &QTimer::timeout, this, &HyprlandIpc::reconcile);
+	QObject::connect(&this->workspaceRefreshTimer, &QTimer::timeout, this, &HyprlandIpc::onWorkspaceRefreshTimeout);
 	// clang-format on
 
+	this->reconcileTimer.setSingleShot(true);
+	this->workspaceRefreshTimer.setSingleShot(true);
+	this->workspaceRefreshTimer.setInterval(RECONCILE_DELAY_MS);
 	this->eventSocket.connectToServer(this->mEventSocketPath, QLocalSocket::ReadOnly);
-	this->refreshMonitors(true);
-	this->refreshWorkspaces(true);
-	this->refreshToplevels();
+	this->reconcile();
 }
 
 QString HyprlandIpc::requestSocketPath() const { return this->mRequestSocketPath; }
@@ -103,13 +116,19 @@ void HyprlandIpc::eventSocketStateChanged(QLocalSocket::LocalSocketState state)
 }
 
 void HyprlandIpc::eventSocketReady() {
-	while (true) {
+	// partial lines are left in the buffer until the rest arrives
+	while (this->eventSocket.canReadLine()) {
 		auto rawEvent = this->eventSocket.readLine();
-		if (rawEvent.isEmpty()) break;
 
 		// remove trailing \n
 		rawEvent.truncate(rawEvent.length() - 1);
 		auto splitIdx = rawEvent.indexOf(">>");
+
+		if (splitIdx == -1) {
+			qCWarning(logHyprlandIpc) << "Ignoring malformed event:" << rawEvent;
+			continue;
+		}
+
 		auto event = QByteArrayView(rawEvent.data(), splitIdx);
 		auto data = QByteArrayView(
 		    rawEvent.data() + splitIdx + 2,     // NOLINT
@@ -121,6 +140,9 @@ void HyprlandIpc::eventSocketReady() {
 		this->event.data = data;
 		this->onEvent(&this->event);
 		emit this->rawEvent(&this->event);
+
+		if (this->mRecentEvents.length() == EVENT_HISTORY_SIZE) this->mRecentEvents.removeFirst();
+		this->mRecentEvents.append(std::move(rawEvent));
 	}
 }
 
@@ -158,32 +180,7 @@ void HyprlandIpc::makeRequest(
     const QByteArray& request,
     const std::function<void(bool, QByteArray)>& callback
 ) {
-	auto* requestSocket = new QLocalSocket(this);
-	qCDebug(logHyprlandIpc) << "Making request:" << request;
-
-	auto connectedCallback = [this, request, requestSocket, callback]() {
-		auto responseCallback = [requestSocket, callback]() {
-			auto response = requestSocket->readAll();
-			callback(true, std::move(response));
-			delete requestSocket;
-		};
-
-		QObject::connect(requestSocket, &QLocalSocket::readyRead, this, responseCallback);
-
-		requestSocket->write(request);
-		requestSocket->flush();
-	};
-
-	auto errorCallback = [=](QLocalSocket::LocalSocketError error) {
-		qCWarning(logHyprlandIpc) << "Error making request:" << error << "request:" << request;
-		requestSocket->deleteLater();
-		callback(false, {});
-	};
-
-	QObject::connect(requestSocket, &QLocalSocket::connected, this, connectedCallback);
-	QObject::connect(requestSocket, &QLocalSocket::errorOccurred, this, errorCallback);
-
-	requestSocket->connectToServer(this->mRequestSocketPath);
+	this->requests.makeRequest(request, callback);
 }
 
 void HyprlandIpc::dispatch(const QString& request) {
@@ -259,9 +256,7 @@ HyprlandIpc* HyprlandIpc::instance() {
 
 void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 	if (event->name == "configreloaded") {
-		this->refreshMonitors(true);
-		this->refreshWorkspaces(true);
-		this->refreshToplevels();
+		this->reconcile();
 	} else if (event->name == "monitoraddedv2") {
 		auto args = event->parseView(3);
 
@@ -289,25 +284,18 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 		// refresh even if it already existed because workspace focus might have changed.
 		this->refreshMonitors(false);
 	} else if (event->name == "monitorremoved") {
-		const auto& mList = this->mMonitors.valueList();
 		auto name = QString::fromUtf8(event->data);
+		auto* monitor = this->findMonitorByName(name, false);
 
-		auto monitorIter = std::ranges::find_if(mList, [name](HyprlandMonitor* m) {
-			return m->bindableName().value() == name;
-		});
-
-		if (monitorIter == mList.end()) {
+		if (!monitor) {
 			qCWarning(logHyprlandIpc) << "Got removal for monitor" << name
 			                          << "which was not previously tracked.";
 			return;
 		}
 
-		auto index = monitorIter - mList.begin();
-		auto* monitor = *monitorIter;
-
 		qCDebug(logHyprlandIpc) << "Monitor removed with id" << monitor->bindableId().value() << "name"
 		                        << monitor->bindableName().value();
-		this->mMonitors.removeAt(index);
+		this->untrackMonitor(monitor);
 
 		// delete the monitor object in the next event loop cycle so it's likely to
 		// still exist when future events reference it after destruction.
@@ -332,32 +320,28 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 		workspace->updateInitial(id, name);
 
 		if (!existed) {
-			this->refreshWorkspaces(false);
 			this->mWorkspaces.insertObjectSorted(workspace, &HyprlandIpc::compareWorkspaces);
 		}
+
+		// Workspaces created silently, such as by movetoworkspacesilent or window rules, are
+		// not followed by a workspacev2 or moveworkspacev2 event carrying their monitor.
+		this->scheduleWorkspaceRefresh();
 	} else if (event->name == "destroyworkspacev2") {
 		auto args = event->parseView(2);
 
 		auto id = args.at(0).toInt();
 		auto name = QString::fromUtf8(args.at(1));
 
-		const auto& mList = this->mWorkspaces.valueList();
+		auto* workspace = this->workspacesById.value(id);
 
-		auto workspaceIter = std::ranges::find_if(mList, [id](HyprlandWorkspace* m) {
-			return m->bindableId().value() == id;
-		});
-
-		if (workspaceIter == mList.end()) {
+		if (!workspace) {
 			qCWarning(logHyprlandIpc) << "Got removal for workspace id" << id << "name" << name
 			                          << "which was not previously tracked.";
 			return;
 		}
 
-		auto index = workspaceIter - mList.begin();
-		auto* workspace = *workspaceIter;
-
 		qCDebug(logHyprlandIpc) << "Workspace removed with id" << id << "name" << name;
-		this->mWorkspaces.removeAt(index);
+		this->untrackWorkspace(workspace);
 
 		// workspaces have not been observed to be referenced after deletion
 		delete workspace;
@@ -413,27 +397,23 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 		auto id = args.at(0).toInt();
 		auto name = QString::fromUtf8(args.at(1));
 
-		const auto& mList = this->mWorkspaces.valueList();
-
-		auto workspaceIter = std::ranges::find_if(mList, [id](HyprlandWorkspace* m) {
-			return m->bindableId().value() == id;
-		});
-
-		if (workspaceIter == mList.end()) return;
+		auto* workspace = this->workspacesById.value(id);
+		if (!workspace) return;
 
-		qCDebug(logHyprlandIpc) << "Workspace with id" << id << "renamed from"
-		                        << (*workspaceIter)->bindableName().value() << "to" << name;
+		auto oldName = workspace->bindableName().value();
+		qCDebug(logHyprlandIpc) << "Workspace with id" << id << "renamed from" << oldName << "to"
+		                        << name;
 
-		(*workspaceIter)->bindableName().setValue(name);
+		workspace->bindableName().setValue(name);
+		this->updateWorkspaceIndex(workspace, id, oldName);
 	} else if (event->name == "fullscreen") {
+		// The event does not say which workspace changed. The focused workspace is updated
+		// immediately and corrected by the refresh if the window was on another one.
 		if (auto* workspace = this->bFocusedWorkspace.value()) {
 			workspace->bindableHasFullscreen().setValue(event->data == "1");
 		}
 
-		// In theory knowing the current workspace would be enough to determine where
-		// the fullscreen state changed, but this falls apart if you move a fullscreen
-		// window between workspaces.
-		this->refreshWorkspaces(false);
+		this->scheduleWorkspaceRefresh();
 	} else if (event->name == "openwindow") {
 		auto args = event->parseView(4);
 		auto ok = false;
@@ -449,6 +429,7 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 		if (!workspace) {
 			qCWarning(logHyprlandIpc) << "Got openwindow for workspace" << workspaceName
 			                          << "which was not previously tracked.";
+			this->scheduleReconcile();
 			return;
 		}
 
@@ -461,7 +442,7 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 		workspace->insertToplevel(toplevel);
 
 		if (!existed) {
-			this->mToplevels.insertObject(toplevel);
+			this->trackToplevel(toplevel);
 			qCDebug(logHyprlandIpc) << "New toplevel created with address" << windowAddress << ", title"
 			                        << windowTitle << ", workspace" << workspaceName;
 		}
@@ -472,21 +453,16 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 
 		if (!ok) return;
 
-		const auto& mList = this->mToplevels.valueList();
-		auto toplevelIter = std::ranges::find_if(mList, [windowAddress](HyprlandToplevel* m) {
-			return m->address() == windowAddress;
-		});
+		auto* toplevel = this->findToplevelByAddress(windowAddress, false);
 
-		if (toplevelIter == mList.end()) {
+		if (!toplevel) {
 			qCWarning(logHyprlandIpc) << "Got closewindow for address" << windowAddress
 			                          << "which was not previously tracked.";
 			return;
 		}
 
-		auto* toplevel = *toplevelIter;
 		if (toplevel == this->bActiveToplevel.value()) this->bActiveToplevel = nullptr;
-		auto index = toplevelIter - mList.begin();
-		this->mToplevels.removeAt(index);
+		this->untrackToplevel(toplevel);
 
 		// Remove from workspace
 		auto* workspace = toplevel->bindableWorkspace().value();
@@ -505,6 +481,7 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 		if (!toplevel) {
 			qCWarning(logHyprlandIpc) << "Got movewindowv2 event for client with address" << windowAddress
 			                          << "which was not previously tracked.";
+			this->scheduleReconcile();
 			return;
 		}
 
@@ -512,6 +489,7 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 		if (!workspace) {
 			qCWarning(logHyprlandIpc) << "Got movewindowv2 event for workspace" << args.at(2)
 			                          << "which was not previously tracked.";
+			this->scheduleReconcile();
 			return;
 		}
 
@@ -520,6 +498,10 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 
 		if (oldWorkspace) {
 			oldWorkspace->removeToplevel(toplevel);
+
+			// The event does not say if the moved window is fullscreen, which would move the
+			// fullscreen state of the workspace with it.
+			if (oldWorkspace->bindableHasFullscreen().value()) this->scheduleWorkspaceRefresh();
 		}
 
 		workspace->insertToplevel(toplevel);
@@ -567,24 +549,10 @@ void HyprlandIpc::onEvent(HyprlandIpcEvent* event) {
 
 HyprlandWorkspace*
 HyprlandIpc::findWorkspaceByName(const QString& name, bool createIfMissing, qint32 id) {
-	const auto& mList = this->mWorkspaces.valueList();
 	HyprlandWorkspace* workspace = nullptr;
 
-	if (id != -1) {
-		auto workspaceIter = std::ranges::find_if(mList, [&](HyprlandWorkspace* m) {
-			return m->bindableId().value() == id;
-		});
-
-		workspace = workspaceIter == mList.end() ? nullptr : *workspaceIter;
-	}
-
-	if (!workspace) {
-		auto workspaceIter = std::ranges::find_if(mList, [&](HyprlandWorkspace* m) {
-			return m->bindableName().value() == name;
-		});
-
-		workspace = workspaceIter == mList.end() ? nullptr : *workspaceIter;
-	}
+	if (id != -1) workspace = this->workspacesById.value(id);
+	if (!workspace) workspace = this->workspacesByName.value(name);
 
 	if (workspace) {
 		return workspace;
@@ -601,6 +569,35 @@ HyprlandIpc::findWorkspaceByName(const QString& name, bool createIfMissing, qint
 	}
 }
 
+void HyprlandIpc::updateWorkspaceIndex(
+    HyprlandWorkspace* workspace,
+    qint32 oldId,
+    const QString& oldName
+) {
+	auto id = workspace->bindableId().value();
+	auto name = workspace->bindableName().value();
+
+	if (id != oldId && this->workspacesById.value(oldId) == workspace) {
+		this->workspacesById.remove(oldId);
+	}
+
+	if (name != oldName && this->workspacesByName.value(oldName) == workspace) {
+		this->workspacesByName.remove(oldName);
+	}
+
+	if (id != -1) this->workspacesById.insert(id, workspace);
+	this->workspacesByName.insert(name, workspace);
+}
+
+void HyprlandIpc::untrackWorkspace(HyprlandWorkspace* workspace) {
+	this->mWorkspaces.removeObject(workspace);
+
+	auto id = workspace->bindableId().value();
+	auto name = workspace->bindableName().value();
+	if (this->workspacesById.value(id) == workspace) this->workspacesById.remove(id);
+	if (this->workspacesByName.value(name) == workspace) this->workspacesByName.remove(name);
+}
+
 void HyprlandIpc::refreshWorkspaces(bool canCreate) {
 	if (this->requestingWorkspaces) return;
 	this->requestingWorkspaces = true;
@@ -612,29 +609,22 @@ void HyprlandIpc::refreshWorkspaces(bool canCreate) {
 		qCDebug(logHyprlandIpc) << "Parsing workspaces response";
 		auto json = QJsonDocument::fromJson(resp).array();
 
-		const auto& mList = this->mWorkspaces.valueList();
-		auto ids = QVector<quint32>();
+		auto ids = QSet<qint32>();
+		ids.reserve(json.size());
 
 		for (auto entry: json) {
 			auto object = entry.toObject().toVariantMap();
 
 			auto id = object.value("id").toInt();
-
-			auto workspaceIter = std::ranges::find_if(mList, [&](HyprlandWorkspace* m) {
-				return m->bindableId().value() == id;
-			});
+			auto* workspace = this->workspacesById.value(id);
 
 			// Only fall back to name-based filtering as a last resort, for workspaces where
 			// no ID has been determined yet.
-			if (workspaceIter == mList.end()) {
-				auto name = object.value("name").toString();
-
-				workspaceIter = std::ranges::find_if(mList, [&](HyprlandWorkspace* m) {
-					return m->bindableId().value() == -1 && m->bindableName().value() == name;
-				});
+			if (!workspace) {
+				workspace = this->workspacesByName.value(object.value("name").toString());
+				if (workspace && workspace->bindableId().value() != -1) workspace = nullptr;
 			}
 
-			auto* workspace = workspaceIter == mList.end() ? nullptr : *workspaceIter;
 			auto existed = workspace != nullptr;
 
 			if (!existed) {
@@ -648,20 +638,20 @@ void HyprlandIpc::refreshWorkspaces(bool canCreate) {
 				this->mWorkspaces.insertObjectSorted(workspace, &HyprlandIpc::compareWorkspaces);
 			}
 
-			ids.push_back(id);
+			ids.insert(id);
 		}
 
 		if (canCreate) {
 			auto removedWorkspaces = QVector<HyprlandWorkspace*>();
 
-			for (auto* workspace: mList) {
+			for (auto* workspace: this->mWorkspaces.valueList()) {
 				if (!ids.contains(workspace->bindableId().value())) {
 					removedWorkspaces.push_back(workspace);
 				}
 			}
 
 			for (auto* workspace: removedWorkspaces) {
-				this->mWorkspaces.removeObject(workspace);
+				this->untrackWorkspace(workspace);
 				delete workspace;
 			}
 		}
@@ -669,13 +659,7 @@ void HyprlandIpc::refreshWorkspaces(bool canCreate) {
 }
 
 HyprlandToplevel* HyprlandIpc::findToplevelByAddress(quint64 address, bool createIfMissing) {
-	const auto& mList = this->mToplevels.valueList();
-	HyprlandToplevel* toplevel = nullptr;
-
-	auto toplevelIter =
-	    std::ranges::find_if(mList, [&](HyprlandToplevel* m) { return m->address() == address; });
-
-	toplevel = toplevelIter == mList.end() ? nullptr : *toplevelIter;
+	auto* toplevel = this->toplevelsByAddress.value(address);
 
 	if (!toplevel && createIfMissing) {
 		qCDebug(logHyprlandIpc) << "Toplevel with address" << address
@@ -683,12 +667,26 @@ HyprlandToplevel* HyprlandIpc::findToplevelByAddress(quint64 address, bool creat
 
 		toplevel = new HyprlandToplevel(this);
 		toplevel->updateInitial(address, "", "");
-		this->mToplevels.insertObject(toplevel);
+		this->trackToplevel(toplevel);
 	}
 
 	return toplevel;
 }
 
+// Addresses of tracked toplevels do not change after they are added.
+void HyprlandIpc::trackToplevel(HyprlandToplevel* toplevel) {
+	this->mToplevels.insertObject(toplevel);
+	this->toplevelsByAddress.insert(toplevel->address(), toplevel);
+}
+
+void HyprlandIpc::untrackToplevel(HyprlandToplevel* toplevel) {
+	this->mToplevels.removeObject(toplevel);
+
+	if (this->toplevelsByAddress.value(toplevel->address()) == toplevel) {
+		this->toplevelsByAddress.remove(toplevel->address());
+	}
+}
+
 void HyprlandIpc::refreshToplevels() {
 	if (this->requestingToplevels) return;
 	this->requestingToplevels = true;
@@ -700,8 +698,6 @@ void HyprlandIpc::refreshToplevels() {
 		qCDebug(logHyprlandIpc) << "Parsing j/clients response";
 		auto json = QJsonDocument::fromJson(resp).array();
 
-		const auto& mList = this->mToplevels.valueList();
-
 		for (auto entry: json) {
 			auto object = entry.toObject().toVariantMap();
 
@@ -713,36 +709,29 @@ void HyprlandIpc::refreshToplevels() {
 				continue;
 			}
 
-			auto toplevelsIter =
-			    std::ranges::find_if(mList, [&](HyprlandToplevel* m) { return m->address() == address; });
-
-			auto* toplevel = toplevelsIter == mList.end() ? nullptr : *toplevelsIter;
+			auto* toplevel = this->toplevelsByAddress.value(address);
 			auto exists = toplevel != nullptr;
 
 			if (!exists) toplevel = new HyprlandToplevel(this);
+			auto* oldWorkspace = toplevel->bindableWorkspace().value();
 			toplevel->updateFromObject(object);
 
 			if (!exists) {
 				qCDebug(logHyprlandIpc) << "New toplevel created with address" << address;
-				this->mToplevels.insertObject(toplevel);
+				this->trackToplevel(toplevel);
 			}
 
 			auto* workspace = toplevel->bindableWorkspace().value();
-			workspace->insertToplevel(toplevel);
+			if (oldWorkspace && oldWorkspace != workspace) oldWorkspace->removeToplevel(toplevel);
+			if (workspace) workspace->insertToplevel(toplevel);
 		}
 	});
 }
 
 HyprlandMonitor*
 HyprlandIpc::findMonitorByName(const QString& name, bool createIfMissing, qint32 id) {
-	const auto& mList = this->mMonitors.valueList();
-
-	auto monitorIter = std::ranges::find_if(mList, [name](HyprlandMonitor* m) {
-		return m->bindableName().value() == name;
-	});
-
-	if (monitorIter != mList.end()) {
-		return *monitorIter;
+	if (auto* monitor = this->monitorsByName.value(name)) {
+		return monitor;
 	} else if (createIfMissing) {
 		qCDebug(logHyprlandIpc) << "Monitor" << name
 		                        << "requested before creation, performing early init";
@@ -755,6 +744,23 @@ HyprlandIpc::findMonitorByName(const QString& name, bool createIfMissing, qint32
 	}
 }
 
+void HyprlandIpc::updateMonitorIndex(HyprlandMonitor* monitor, const QString& oldName) {
+	auto name = monitor->bindableName().value();
+
+	if (name != oldName && this->monitorsByName.value(oldName) == monitor) {
+		this->monitorsByName.remove(oldName);
+	}
+
+	this->monitorsByName.insert(name, monitor);
+}
+
+void HyprlandIpc::untrackMonitor(HyprlandMonitor* monitor) {
+	this->mMonitors.removeObject(monitor);
+
+	auto name = monitor->bindableName().value();
+	if (this->monitorsByName.value(name) == monitor) this->monitorsByName.remove(name);
+}
+
 HyprlandMonitor* HyprlandIpc::monitorFor(QuickshellScreenInfo* screen) {
 	// Wayland monitors appear after hyprland ones are created and disappear after destruction
 	// so simply not doing any preemptive creation is enough, however if this call creates
@@ -798,18 +804,14 @@ void HyprlandIpc::refreshMonitors(bool canCreate) {
 		qCDebug(logHyprlandIpc) << "parsing monitors response";
 		auto json = QJsonDocument::fromJson(resp).array();
 
-		const auto& mList = this->mMonitors.valueList();
-		auto names = QVector<QString>();
+		auto names = QSet<QString>();
+		names.reserve(json.size());
 
 		for (auto entry: json) {
 			auto object = entry.toObject().toVariantMap();
 			auto name = object.value("name").toString();
 
-			auto monitorIter = std::ranges::find_if(mList, [name](HyprlandMonitor* m) {
-				return m->bindableName().value() == name;
-			});
-
-			auto* monitor = monitorIter == mList.end() ? nullptr : *monitorIter;
+			auto* monitor = this->monitorsByName.value(name);
 			auto existed = monitor != nullptr;
 
 			if (monitor == nullptr) {
@@ -823,25 +825,48 @@ void HyprlandIpc::refreshMonitors(bool canCreate) {
 				this->mMonitors.insertObject(monitor);
 			}
 
-			names.push_back(name);
+			names.insert(name);
 		}
 
 		auto removedMonitors = QVector<HyprlandMonitor*>();
 
-		for (auto* monitor: mList) {
+		for (auto* monitor: this->mMonitors.valueList()) {
 			if (!names.contains(monitor->bindableName().value())) {
 				removedMonitors.push_back(monitor);
 			}
 		}
 
 		for (auto* monitor: removedMonitors) {
-			this->mMonitors.removeObject(monitor);
+			this->untrackMonitor(monitor);
 			// see comment in onEvent
 			monitor->deleteLater();
 		}
 	});
 }
 
+void HyprlandIpc::scheduleReconcile() {
+	auto remaining = this->reconcileTimer.remainingTime();
+
+	if (remaining == -1 || remaining > RECONCILE_DELAY_MS) {
+		qCDebug(logHyprlandIpc) << "Scheduling full refresh";
+		this->reconcileTimer.start(RECONCILE_DELAY_MS);
+	}
+}
+
+void HyprlandIpc::scheduleWorkspaceRefresh() {
+	if (!this->workspaceRefreshTimer.isActive()) this->workspaceRefreshTimer.start();
+}
+
+void HyprlandIpc::onWorkspaceRefreshTimeout() { this->refreshWorkspaces(false); }
+
+void HyprlandIpc::reconcile() {
+	// sent as a single batch
+	this->refreshMonitors(true);
+	this->refreshWorkspaces(true);
+	this->refreshToplevels();
+	this->reconcileTimer.start(RECONCILE_INTERVAL_MS);
+}
+
 bool HyprlandIpc::compareWorkspaces(HyprlandWorkspace* a, HyprlandWorkspace* b) {
 	return a->bindableId().value() > b->bindableId().value();
 }
@@ -2,6 +2,7 @@
 
 #include <functional>
 
+#include <qbytearray.h>
 #include <qbytearrayview.h>
 #include <qcontainerfwd.h>
 #include <qhash.h>
@@ -9,12 +10,14 @@
 #include <qobject.h>
 #include <qproperty.h>
 #include <qqmlintegration.h>
+#include <qtimer.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
 
 #include "../../../core/model.hpp"
 #include "../../../core/qmlscreen.hpp"
 #include "../../../wayland/toplevel_management/handle.hpp"
+#include "request.hpp"
 
 namespace qs::hyprland::ipc {
 
@@ -74,10 +77,13 @@ public:
 	[[nodiscard]] QString requestSocketPath() const;
 	[[nodiscard]] QString eventSocketPath() const;
 
+	// Requests made in the same event loop iteration are sent as a single batch.
 	void
 	makeRequest(const QByteArray& request, const std::function<void(bool, QByteArray)>& callback);
 	void dispatch(const QString& request);
 
+	[[nodiscard]] HyprlandRequestStats* requestStats() { return this->requests.stats(); }
+
 	[[nodiscard]] HyprlandMonitor* monitorFor(QuickshellScreenInfo* screen);
 
 	[[nodiscard]] QBindable<HyprlandMonitor*> bindableFocusedMonitor() const {
@@ -103,11 +109,26 @@ public:
 	HyprlandMonitor* findMonitorByName(const QString& name, bool createIfMissing, qint32 id = -1);
 	HyprlandToplevel* findToplevelByAddress(quint64 address, bool createIfMissing);
 
+	// Called when the id or name of a workspace or monitor changes to keep lookups current.
+	void updateWorkspaceIndex(HyprlandWorkspace* workspace, qint32 oldId, const QString& oldName);
+	void updateMonitorIndex(HyprlandMonitor* monitor, const QString& oldName);
+
 	// canCreate avoids making ghost workspaces when the connection races
 	void refreshWorkspaces(bool canCreate);
 	void refreshMonitors(bool canCreate);
 	void refreshToplevels();
 
+	// Events are applied as deltas to the existing state. Events that cannot be applied
+	// exactly schedule a full refresh shortly after, and a full refresh is made periodically
+	// to correct any drift.
+	void scheduleReconcile();
+	// Same as above for events that only leave workspace state inexact, which refreshes
+	// workspaces alone.
+	void scheduleWorkspaceRefresh();
+
+	// Unparsed lines of the most recent events, oldest first.
+	[[nodiscard]] const QList<QByteArray>& recentEvents() const { return this->mRecentEvents; }
+
 	// The last argument may contain commas, so the count is required.
 	[[nodiscard]] static QVector<QByteArrayView> parseEventArgs(QByteArrayView event, quint16 count);
 
@@ -130,15 +151,23 @@ private slots:
 	);
 
 	void onFocusedMonitorDestroyed();
+	void onWorkspaceRefreshTimeout();
+	void reconcile();
 
 private:
 	explicit HyprlandIpc();
 
 	void onEvent(HyprlandIpcEvent* event);
 
+	void trackToplevel(HyprlandToplevel* toplevel);
+	void untrackToplevel(HyprlandToplevel* toplevel);
+	void untrackWorkspace(HyprlandWorkspace* workspace);
+	void untrackMonitor(HyprlandMonitor* monitor);
+
 	static bool compareWorkspaces(HyprlandWorkspace* a, HyprlandWorkspace* b);
 
 	QLocalSocket eventSocket;
+	HyprlandRequestChannel requests {this};
 	QString mRequestSocketPath;
 	QString mEventSocketPath;
 	bool valid = false;
@@ -151,6 +180,15 @@ private:
 	ObjectModel<HyprlandWorkspace> mWorkspaces {this};
 	ObjectModel<HyprlandToplevel> mToplevels {this};
 
+	QHash<qint32, HyprlandWorkspace*> workspacesById;
+	QHash<QString, HyprlandWorkspace*> workspacesByName;
+	QHash<QString, HyprlandMonitor*> monitorsByName;
+	QHash<quint64, HyprlandToplevel*> toplevelsByAddress;
+
+	QTimer reconcileTimer;
+	QTimer workspaceRefreshTimer;
+	QList<QByteArray> mRecentEvents;
+
 	HyprlandIpcEvent event {this};
 
 	Q_OBJECT_BINDABLE_PROPERTY(
@@ -0,0 +1,103 @@
+#include "event_coalescer.hpp"
+#include <utility>
+
+#include <qbytearray.h>
+#include <qbytearrayview.h>
+#include <qlogging.h>
+#include <qloggingcategory.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qtimer.h>
+#include <qtypes.h>
+
+#include "../../../core/logcat.hpp"
+#include "connection.hpp"
+
+namespace qs::hyprland::ipc {
+
+namespace {
+QS_LOGGING_CATEGORY(logHyprlandCoalesce, "quickshell.hyprland.ipc.coalesce", QtWarningMsg);
+
+// Roughly one frame at 60hz.
+constexpr qint32 COALESCE_INTERVAL_MS = 16;
+
+// Events that fully describe the current state, so only the last one matters.
+constexpr QByteArrayView GLOBAL_EVENTS[] = {
+    "activewindow",
+    "activewindowv2",
+    "focusedmon",
+    "focusedmonv2",
+    "workspace",
+    "workspacev2",
+    "submap",
+};
+
+// Events that describe the state of the object named by their first argument.
+constexpr QByteArrayView KEYED_EVENTS[] = {
+    "windowtitle",
+    "windowtitlev2",
+    "activelayout",
+};
+
+} // namespace
+
+HyprlandEventCoalescer::HyprlandEventCoalescer(QObject* parent): QObject(parent) {
+	this->timer.setSingleShot(true);
+	this->timer.setTimerType(Qt::PreciseTimer);
+	QObject::connect(&this->timer, &QTimer::timeout, this, &HyprlandEventCoalescer::flush);
+}
+
+QByteArray HyprlandEventCoalescer::coalesceKey(QByteArrayView name, QByteArrayView data) {
+	for (auto event: GLOBAL_EVENTS) {
+		if (name == event) return name.toByteArray();
+	}
+
+	for (auto event: KEYED_EVENTS) {
+		if (name == event) {
+			auto end = data.indexOf(',');
+			auto object = end == -1 ? data : data.first(end);
+			return name.toByteArray() + '\0' + object.toByteArray();
+		}
+	}
+
+	return QByteArray();
+}
+
+void HyprlandEventCoalescer::addEvent(QByteArrayView name, QByteArrayView data) {
+	auto key = coalesceKey(name, data);
+
+	if (!key.isEmpty()) {
+		auto existing = this->latestByKey.find(key);
+
+		if (existing != this->latestByKey.end()) {
+			this->pending[existing.value()].superseded = true;
+			existing.value() = this->pending.length();
+		} else {
+			this->latestByKey.insert(std::move(key), this->pending.length());
+		}
+	}
+
+	this->pending.append({.name = name.toByteArray(), .data = data.toByteArray()});
+	if (!this->timer.isActive()) this->timer.start(COALESCE_INTERVAL_MS);
+}
+
+void HyprlandEventCoalescer::flush() {
+	auto pending = std::move(this->pending);
+	this->pending.clear();
+	this->latestByKey.clear();
+
+	qCDebug(logHyprlandCoalesce) << "Flushing" << pending.length() << "events";
+
+	for (const auto& event: pending) {
+		if (event.superseded) continue;
+
+		this->mEvent.name = event.name;
+		this->mEvent.data = event.data;
+		emit this->event(&this->mEvent);
+	}
+
+	this->mEvent.name = QByteArrayView();
+	this->mEvent.data = QByteArrayView();
+}
+
+} // namespace qs::hyprland::ipc
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <qbytearray.h>
+#include <qbytearrayview.h>
+#include <qcontainerfwd.h>
+#include <qhash.h>
+#include <qobject.h>
+#include <qtimer.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+
+#include "connection.hpp"
+
+namespace qs::hyprland::ipc {
+
+// Collapses events that are superseded by a later event of the same kind, such as bursts
+// of activewindowv2 or windowtitlev2 events, and emits the remaining events once per frame.
+//
+// Events that are not superseded keep their order. A superseding event takes the position
+// of the last event it replaces.
+class HyprlandEventCoalescer: public QObject {
+	Q_OBJECT;
+
+public:
+	explicit HyprlandEventCoalescer(QObject* parent = nullptr);
+
+	void addEvent(QByteArrayView name, QByteArrayView data);
+
+	// Returns the key identifying which events supersede each other, or an empty array
+	// if the event cannot be superseded.
+	[[nodiscard]] static QByteArray coalesceKey(QByteArrayView name, QByteArrayView data);
+
+signals:
+	void event(qs::hyprland::ipc::HyprlandIpcEvent* event);
+
+private slots:
+	void flush();
+
+private:
+	struct PendingEvent {
+		QByteArray name;
+		QByteArray data;
+		bool superseded = false;
+	};
+
+	QList<PendingEvent> pending;
+	QHash<QByteArray, qsizetype> latestByKey;
+	QTimer timer;
+	HyprlandIpcEvent mEvent {this};
+};
+
+} // namespace qs::hyprland::ipc
@@ -69,24 +69,25 @@ void HyprlandToplevel::updateFromObject(const QVariantMap& object) {
 	auto addressStr = object.value("address").value<QString>();
 	auto title = object.value("title").value<QString>();
 
-	Qt::beginPropertyUpdateGroup();
 	bool ok = false;
 	auto address = addressStr.toULongLong(&ok, 16);
 	if (!ok || !address) {
 		return;
 	}
 
-	this->setAddress(address);
-	this->bTitle = title;
-
 	auto workspaceMap = object.value("workspace").toMap();
 	auto workspaceName = workspaceMap.value("name").toString();
-
 	auto* workspace = this->ipc->findWorkspaceByName(workspaceName, false);
-	if (!workspace) return;
 
-	this->setWorkspace(workspace);
-	this->bLastIpcObject = object;
+	Qt::beginPropertyUpdateGroup();
+	this->setAddress(address);
+	this->bTitle = title;
+
+	if (workspace) {
+		this->setWorkspace(workspace);
+		this->bLastIpcObject = object;
+	}
+
 	Qt::endPropertyUpdateGroup();
 }
 
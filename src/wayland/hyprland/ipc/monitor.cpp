@@ -14,6 +14,8 @@ namespace qs::hyprland::ipc {
 QVariantMap HyprlandMonitor::lastIpcObject() const { return this->mLastIpcObject; }
 
 void HyprlandMonitor::updateInitial(qint32 id, const QString& name, const QString& description) {
+	auto oldName = this->bName.value();
+
 	Qt::beginPropertyUpdateGroup();
 	this->bId = id;
 	this->bName = name;
@@ -24,6 +26,8 @@ void HyprlandMonitor::updateInitial(qint32 id, const QString& name, const QStrin
 	});
 
 	Qt::endPropertyUpdateGroup();
+
+	this->ipc->updateMonitorIndex(this, oldName);
 }
 
 void HyprlandMonitor::updateFromObject(QVariantMap object) {
@@ -31,6 +35,7 @@ void HyprlandMonitor::updateFromObject(QVariantMap object) {
 	auto activeWorkspaceId = activeWorkspaceObj.value("id").value<qint32>();
 	auto activeWorkspaceName = activeWorkspaceObj.value("name").value<QString>();
 	auto focused = object.value("focused").value<bool>();
+	auto oldName = this->bName.value();
 
 	Qt::beginPropertyUpdateGroup();
 	this->bId = object.value("id").value<qint32>();
@@ -43,6 +48,8 @@ void HyprlandMonitor::updateFromObject(QVariantMap object) {
 	this->bScale = object.value("scale").value<qreal>();
 	Qt::endPropertyUpdateGroup();
 
+	this->ipc->updateMonitorIndex(this, oldName);
+
 	if (this->bActiveWorkspace == nullptr
 	    || this->bActiveWorkspace->bindableName().value() != activeWorkspaceName)
 	{
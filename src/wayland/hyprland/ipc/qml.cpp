@@ -1,12 +1,16 @@
 #include "qml.hpp"
 
+#include <qcontainerfwd.h>
 #include <qobject.h>
 #include <qproperty.h>
+#include <qvariant.h>
 
 #include "../../../core/model.hpp"
 #include "../../../core/qmlscreen.hpp"
 #include "connection.hpp"
+#include "event_coalescer.hpp"
 #include "monitor.hpp"
+#include "request.hpp"
 
 namespace qs::hyprland::ipc {
 
@@ -15,6 +19,10 @@ HyprlandIpcQml::HyprlandIpcQml() {
 
 	QObject::connect(instance, &HyprlandIpc::rawEvent, this, &HyprlandIpcQml::rawEvent);
 
+	QObject::connect(instance, &HyprlandIpc::rawEvent, this, [this](HyprlandIpcEvent* event) {
+		if (this->coalescer) this->coalescer->addEvent(event->name, event->data);
+	});
+
 	QObject::connect(
 	    instance,
 	    &HyprlandIpc::focusedMonitorChanged,
@@ -48,6 +56,46 @@ HyprlandMonitor* HyprlandIpcQml::monitorFor(QuickshellScreenInfo* screen) {
 void HyprlandIpcQml::refreshMonitors() { HyprlandIpc::instance()->refreshMonitors(false); }
 void HyprlandIpcQml::refreshWorkspaces() { HyprlandIpc::instance()->refreshWorkspaces(false); }
 void HyprlandIpcQml::refreshToplevels() { HyprlandIpc::instance()->refreshToplevels(); }
+
+QVariantList HyprlandIpcQml::recentEvents() {
+	auto events = QVariantList();
+
+	for (const auto& rawEvent: HyprlandIpc::instance()->recentEvents()) {
+		auto splitIdx = rawEvent.indexOf(">>");
+		// skipped defensively, as HyprlandIpc does not record malformed lines
+		if (splitIdx == -1) continue;
+
+		events.append(QVariantMap {
+		    {"name", QString::fromUtf8(rawEvent.first(splitIdx))},
+		    {"data", QString::fromUtf8(rawEvent.sliced(splitIdx + 2))},
+		});
+	}
+
+	return events;
+}
+
+void HyprlandIpcQml::setCoalesceEvents(bool coalesceEvents) {
+	if (coalesceEvents == this->coalesceEvents()) return;
+
+	if (coalesceEvents) {
+		this->coalescer = new HyprlandEventCoalescer(this);
+
+		QObject::connect(
+		    this->coalescer,
+		    &HyprlandEventCoalescer::event,
+		    this,
+		    &HyprlandIpcQml::coalescedEvent
+		);
+	} else {
+		// May be called from a coalescedEvent handler. Events waiting for the end of the
+		// frame are dropped.
+		QObject::disconnect(this->coalescer, nullptr, this, nullptr);
+		this->coalescer->deleteLater();
+		this->coalescer = nullptr;
+	}
+
+	emit this->coalesceEventsChanged();
+}
 QString HyprlandIpcQml::requestSocketPath() { return HyprlandIpc::instance()->requestSocketPath(); }
 QString HyprlandIpcQml::eventSocketPath() { return HyprlandIpc::instance()->eventSocketPath(); }
 
@@ -75,4 +123,8 @@ ObjectModel<HyprlandToplevel>* HyprlandIpcQml::toplevels() {
 	return HyprlandIpc::instance()->toplevels();
 }
 
+HyprlandRequestStats* HyprlandIpcQml::requestStats() {
+	return HyprlandIpc::instance()->requestStats();
+}
+
 } // namespace qs::hyprland::ipc
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <qbytearrayview.h>
+#include <qcontainerfwd.h>
 #include <qobject.h>
 #include <qqmlintegration.h>
 #include <qtmetamacros.h>
@@ -9,7 +10,9 @@
 #include "../../../core/model.hpp"
 #include "../../../core/qmlscreen.hpp"
 #include "connection.hpp"
+#include "event_coalescer.hpp"
 #include "monitor.hpp"
+#include "request.hpp"
 
 namespace qs::hyprland::ipc {
 
@@ -37,6 +40,15 @@ class HyprlandIpcQml: public QObject {
 	/// All hyprland toplevels
 	QSDOC_TYPE_OVERRIDE(ObjectModel<qs::hyprland::ipc::HyprlandToplevel>*);
 	Q_PROPERTY(UntypedObjectModel* toplevels READ toplevels CONSTANT);
+	/// If true, @@coalescedEvent(s) is emitted with the events of each frame, excluding events
+	/// superseded by a later event of the same kind. Defaults to false.
+	///
+	/// This avoids reevaluating bindings for every event in bursts such as `activewindowv2`
+	/// during fast window switching or `windowtitlev2` from a terminal updating its title.
+	/// @@rawEvent(s) is emitted for every event regardless.
+	Q_PROPERTY(bool coalesceEvents READ coalesceEvents WRITE setCoalesceEvents NOTIFY coalesceEventsChanged);
+	/// Latency statistics of requests made to the request socket.
+	Q_PROPERTY(qs::hyprland::ipc::HyprlandRequestStats* requestStats READ requestStats CONSTANT);
 	// clang-format on
 	QML_NAMED_ELEMENT(Hyprland);
 	QML_SINGLETON;
@@ -68,6 +80,16 @@ public:
 	/// so this function is available if required.
 	Q_INVOKABLE static void refreshToplevels();
 
+	/// Returns the most recent events received from the event socket, oldest first,
+	/// as objects with `name` and `data` strings.
+	///
+	/// Up to 128 events are kept, allowing objects created after an event was received
+	/// to catch up with it.
+	Q_INVOKABLE static QVariantList recentEvents();
+
+	[[nodiscard]] bool coalesceEvents() const { return this->coalescer != nullptr; }
+	void setCoalesceEvents(bool coalesceEvents);
+
 	[[nodiscard]] static QString requestSocketPath();
 	[[nodiscard]] static QString eventSocketPath();
 	[[nodiscard]] static QBindable<HyprlandMonitor*> bindableFocusedMonitor();
@@ -76,16 +98,29 @@ public:
 	[[nodiscard]] static ObjectModel<HyprlandMonitor>* monitors();
 	[[nodiscard]] static ObjectModel<HyprlandWorkspace>* workspaces();
 	[[nodiscard]] static ObjectModel<HyprlandToplevel>* toplevels();
+	[[nodiscard]] static HyprlandRequestStats* requestStats();
 
 signals:
 	/// Emitted for every event that comes in through the hyprland event socket (socket2).
 	///
 	/// See [Hyprland Wiki: IPC](https://wiki.hyprland.org/IPC/) for a list of events.
 	void rawEvent(qs::hyprland::ipc::HyprlandIpcEvent* event);
+	/// Emitted for events that were not superseded by a later event of the same kind in the
+	/// same frame, if @@coalesceEvents is true.
+	///
+	/// Only the last of a series of `activewindow`, `activewindowv2`, `focusedmon`,
+	/// `focusedmonv2`, `workspace`, `workspacev2` and `submap` events, and of
+	/// `windowtitle`, `windowtitlev2` and `activelayout` events for the same window or keyboard,
+	/// is emitted. Other events are emitted in order.
+	void coalescedEvent(qs::hyprland::ipc::HyprlandIpcEvent* event);
+	void coalesceEventsChanged();
 
 	void focusedMonitorChanged();
 	void focusedWorkspaceChanged();
 	void activeToplevelChanged();
+
+private:
+	HyprlandEventCoalescer* coalescer = nullptr;
 };
 
 } // namespace qs::hyprland::ipc
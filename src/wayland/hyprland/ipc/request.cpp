@@ -0,0 +1,234 @@
+#include "request.hpp"
+#include <utility>
+
+#include <qbytearray.h>
+#include <qbytearrayview.h>
+#include <qcontainerfwd.h>
+#include <qlocalsocket.h>
+#include <qlogging.h>
+#include <qloggingcategory.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qobjectdefs.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+
+#include "../../../core/logcat.hpp"
+
+namespace qs::hyprland::ipc {
+
+namespace {
+QS_LOGGING_CATEGORY(logHyprlandRequest, "quickshell.hyprland.ipc.request", QtWarningMsg);
+
+// Separator between the responses of a [[BATCH]] request.
+constexpr QByteArrayView BATCH_DELIMITER = "\n\n\n";
+constexpr qint32 REQUEST_TIMEOUT_MS = 5000;
+} // namespace
+
+void HyprlandRequestStats::recordRequest(qint64 latencyNs, bool success) {
+	this->mRequests++;
+	if (!success) this->mFailures++;
+	this->lastNs = latencyNs;
+	this->totalNs += latencyNs;
+	this->maxNs = qMax(this->maxNs, latencyNs);
+	emit this->updated();
+}
+
+void HyprlandRequestStats::recordConnection() {
+	this->mConnections++;
+	emit this->updated();
+}
+
+void HyprlandRequestStats::reset() {
+	this->mRequests = 0;
+	this->mConnections = 0;
+	this->mFailures = 0;
+	this->lastNs = 0;
+	this->totalNs = 0;
+	this->maxNs = 0;
+	emit this->updated();
+}
+
+qreal HyprlandRequestStats::lastLatency() const { return static_cast<qreal>(this->lastNs) / 1e6; }
+qreal HyprlandRequestStats::maxLatency() const { return static_cast<qreal>(this->maxNs) / 1e6; }
+
+qreal HyprlandRequestStats::averageLatency() const {
+	if (this->mRequests == 0) return 0;
+	return static_cast<qreal>(this->totalNs) / static_cast<qreal>(this->mRequests) / 1e6;
+}
+
+HyprlandRequestConnection::HyprlandRequestConnection(QByteArray request, QObject* parent)
+    : QObject(parent)
+    , request(std::move(request)) {
+	// clang-format off
+	QObject::connect(&this->socket, &QLocalSocket::connected, this, &HyprlandRequestConnection::onConnected);
+	QObject::connect(&this->socket, &QLocalSocket::readyRead, this, &HyprlandRequestConnection::onReadyRead);
+	QObject::connect(&this->socket, &QLocalSocket::disconnected, this, &HyprlandRequestConnection::onDisconnected);
+	QObject::connect(&this->socket, &QLocalSocket::errorOccurred, this, &HyprlandRequestConnection::onError);
+	QObject::connect(&this->timeout, &QTimer::timeout, this, &HyprlandRequestConnection::onTimeout);
+	// clang-format on
+
+	this->timeout.setSingleShot(true);
+}
+
+void HyprlandRequestConnection::start(const QString& socketPath) {
+	this->timeout.start(REQUEST_TIMEOUT_MS);
+	this->socket.connectToServer(socketPath);
+}
+
+void HyprlandRequestConnection::onConnected() {
+	this->socket.write(this->request);
+	this->socket.flush();
+}
+
+void HyprlandRequestConnection::onReadyRead() { this->response.append(this->socket.readAll()); }
+
+void HyprlandRequestConnection::onDisconnected() {
+	this->response.append(this->socket.readAll());
+	this->finish(true);
+}
+
+void HyprlandRequestConnection::onError(QLocalSocket::LocalSocketError error) {
+	// followed by disconnected once the response has been written
+	if (error == QLocalSocket::PeerClosedError) return;
+
+	qCWarning(logHyprlandRequest) << "Error making request:" << error << "request:" << this->request;
+	this->finish(false);
+}
+
+void HyprlandRequestConnection::onTimeout() {
+	qCWarning(logHyprlandRequest) << "Request timed out after" << REQUEST_TIMEOUT_MS
+	                              << "ms:" << this->request;
+	this->finish(false);
+}
+
+void HyprlandRequestConnection::finish(bool success) {
+	if (this->done) return;
+	this->done = true;
+	this->timeout.stop();
+
+	emit this->finished(success, this->response);
+	this->deleteLater();
+}
+
+void HyprlandRequestChannel::setSocketPath(QString socketPath) {
+	this->socketPath = std::move(socketPath);
+}
+
+void HyprlandRequestChannel::makeRequest(
+    const QByteArray& request,
+    HyprlandRequestCallback callback
+) {
+	qCDebug(logHyprlandRequest) << "Queueing request:" << request;
+
+	auto pending = PendingRequest {.request = request, .callback = std::move(callback)};
+	pending.timer.start();
+	this->queue.append(std::move(pending));
+
+	if (!this->flushQueued) {
+		this->flushQueued = true;
+		QMetaObject::invokeMethod(this, &HyprlandRequestChannel::flush, Qt::QueuedConnection);
+	}
+}
+
+bool HyprlandRequestChannel::canBatch(const QByteArray& request) {
+	// A batch is resent as separate requests if its responses cannot be split, so only json
+	// queries which are safe to repeat are batched. Batched commands are separated by
+	// semicolons, and batches cannot be nested.
+	return request.startsWith("j/") && !request.contains(';');
+}
+
+void HyprlandRequestChannel::flush() {
+	this->flushQueued = false;
+	auto queue = std::move(this->queue);
+	this->queue.clear();
+
+	auto batch = QList<PendingRequest>();
+
+	for (auto& request: queue) {
+		if (canBatch(request.request)) batch.append(std::move(request));
+		else this->send({std::move(request)});
+	}
+
+	if (!batch.isEmpty()) this->send(std::move(batch));
+}
+
+void HyprlandRequestChannel::send(QList<PendingRequest> requests) {
+	auto payload = requests.first().request;
+
+	if (requests.length() > 1) {
+		auto commands = QList<QByteArray>();
+		for (const auto& request: requests) commands.append(request.request);
+		payload = "[[BATCH]]" + commands.join(';');
+	}
+
+	qCDebug(logHyprlandRequest) << "Sending request:" << payload;
+
+	auto* connection = new HyprlandRequestConnection(payload, this);
+	this->mStats.recordConnection();
+
+	QObject::connect(
+	    connection,
+	    &HyprlandRequestConnection::finished,
+	    this,
+	    [this, requests = std::move(requests)](bool success, const QByteArray& response) mutable {
+		    this->onConnectionFinished(requests, success, response);
+	    }
+	);
+
+	// errors may be reported immediately
+	connection->start(this->socketPath);
+}
+
+void HyprlandRequestChannel::onConnectionFinished(
+    QList<PendingRequest>& requests,
+    bool success,
+    const QByteArray& response
+) {
+	if (!success || requests.length() == 1) {
+		for (auto& request: requests) this->finishRequest(request, success, response);
+		return;
+	}
+
+	auto responses = QList<QByteArray>();
+	qsizetype start = 0;
+
+	while (true) {
+		auto end = response.indexOf(BATCH_DELIMITER, start);
+		if (end == -1) break;
+		responses.append(response.sliced(start, end - start));
+		start = end + BATCH_DELIMITER.length();
+	}
+
+	responses.append(response.sliced(start));
+
+	if (responses.length() != requests.length()) {
+		// A response contained the delimiter. Retrying the requests separately is the
+		// only way to tell which response belongs to which request.
+		qCWarning(logHyprlandRequest) << "Batch returned" << responses.length() << "responses for"
+		                              << requests.length() << "requests, retrying separately.";
+
+		for (auto& request: requests) this->send({std::move(request)});
+		return;
+	}
+
+	for (auto i = 0; i != requests.length(); i++) {
+		this->finishRequest(requests[i], true, std::move(responses[i]));
+	}
+}
+
+void HyprlandRequestChannel::finishRequest(
+    PendingRequest& request,
+    bool success,
+    QByteArray response
+) {
+	auto latency = request.timer.nsecsElapsed();
+	this->mStats.recordRequest(latency, success);
+
+	qCDebug(logHyprlandRequest) << "Request" << request.request << "finished in"
+	                            << static_cast<qreal>(latency) / 1e6 << "ms";
+
+	request.callback(success, std::move(response));
+}
+
+} // namespace qs::hyprland::ipc
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <functional>
+
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
+#include <qelapsedtimer.h>
+#include <qlocalsocket.h>
+#include <qobject.h>
+#include <qqmlintegration.h>
+#include <qtimer.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+
+namespace qs::hyprland::ipc {
+
+using HyprlandRequestCallback = std::function<void(bool, QByteArray)>;
+
+///! Hyprland request socket statistics.
+/// Latency of requests made through the Hyprland request socket (.socket.sock),
+/// including requests made by @@Hyprland.dispatch() and the refresh functions.
+///
+/// Latencies are measured from when a request is made to when its full response has been read,
+/// and are in milliseconds.
+class HyprlandRequestStats: public QObject {
+	Q_OBJECT;
+	/// Number of finished requests, including failed ones.
+	Q_PROPERTY(qint64 requests READ requests NOTIFY updated);
+	/// Number of connections made to the request socket. Requests made in the same
+	/// event loop iteration are sent as a single batch, so this may be lower than @@requests.
+	Q_PROPERTY(qint64 connections READ connections NOTIFY updated);
+	/// Number of requests that failed to connect or did not receive a response.
+	Q_PROPERTY(qint64 failures READ failures NOTIFY updated);
+	/// Latency of the last finished request.
+	Q_PROPERTY(qreal lastLatency READ lastLatency NOTIFY updated);
+	/// Average latency of all finished requests.
+	Q_PROPERTY(qreal averageLatency READ averageLatency NOTIFY updated);
+	/// Highest latency of all finished requests.
+	Q_PROPERTY(qreal maxLatency READ maxLatency NOTIFY updated);
+	QML_ELEMENT;
+	QML_UNCREATABLE("HyprlandRequestStats must be retrieved from the Hyprland object.");
+
+public:
+	explicit HyprlandRequestStats(QObject* parent = nullptr): QObject(parent) {}
+
+	void recordRequest(qint64 latencyNs, bool success);
+	void recordConnection();
+
+	/// Reset all statistics to zero.
+	Q_INVOKABLE void reset();
+
+	[[nodiscard]] qint64 requests() const { return this->mRequests; }
+	[[nodiscard]] qint64 connections() const { return this->mConnections; }
+	[[nodiscard]] qint64 failures() const { return this->mFailures; }
+	[[nodiscard]] qreal lastLatency() const;
+	[[nodiscard]] qreal averageLatency() const;
+	[[nodiscard]] qreal maxLatency() const;
+
+signals:
+	void updated();
+
+private:
+	qint64 mRequests = 0;
+	qint64 mConnections = 0;
+	qint64 mFailures = 0;
+	qint64 lastNs = 0;
+	qint64 totalNs = 0;
+	qint64 maxNs = 0;
+};
+
+// A single connection to the request socket. Hyprland answers one request (or batch) per
+// connection and closes it after writing the response, so the response is read until the
+// socket disconnects instead of on the first readyRead.
+class HyprlandRequestConnection: public QObject {
+	Q_OBJECT;
+
+public:
+	explicit HyprlandRequestConnection(QByteArray request, QObject* parent = nullptr);
+
+	void start(const QString& socketPath);
+
+signals:
+	void finished(bool success, const QByteArray& response);
+
+private slots:
+	void onConnected();
+	void onReadyRead();
+	void onDisconnected();
+	void onError(QLocalSocket::LocalSocketError error);
+	void onTimeout();
+
+private:
+	void finish(bool success);
+
+	QLocalSocket socket;
+	QTimer timeout;
+	QByteArray request;
+	QByteArray response;
+	bool done = false;
+};
+
+// Queues requests to the Hyprland request socket, sending json queries made in the same event
+// loop iteration as a single `[[BATCH]]` request. Other requests are sent on their own.
+class HyprlandRequestChannel: public QObject {
+	Q_OBJECT;
+
+public:
+	explicit HyprlandRequestChannel(QObject* parent = nullptr): QObject(parent) {}
+
+	void setSocketPath(QString socketPath);
+	void makeRequest(const QByteArray& request, HyprlandRequestCallback callback);
+
+	[[nodiscard]] HyprlandRequestStats* stats() { return &this->mStats; }
+
+private slots:
+	void flush();
+
+private:
+	struct PendingRequest {
+		QByteArray request;
+		HyprlandRequestCallback callback;
+		QElapsedTimer timer;
+	};
+
+	void send(QList<PendingRequest> requests);
+	void onConnectionFinished(
+	    QList<PendingRequest>& requests,
+	    bool success,
+	    const QByteArray& response
+	);
+	void finishRequest(PendingRequest& request, bool success, QByteArray response);
+	static bool canBatch(const QByteArray& request);
+
+	QString socketPath;
+	QList<PendingRequest> queue;
+	bool flushQueued = false;
+	HyprlandRequestStats mStats {this};
+};
+
+} // namespace qs::hyprland::ipc
@@ -36,10 +36,15 @@ HyprlandWorkspace::HyprlandWorkspace(HyprlandIpc* ipc): QObject(ipc), ipc(ipc) {
 }
 
 void HyprlandWorkspace::updateInitial(qint32 id, const QString& name) {
+	auto oldId = this->bId.value();
+	auto oldName = this->bName.value();
+
 	Qt::beginPropertyUpdateGroup();
 	this->bId = id;
 	this->bName = name;
 	Qt::endPropertyUpdateGroup();
+
+	this->ipc->updateWorkspaceIndex(this, oldId, oldName);
 }
 
 void HyprlandWorkspace::updateFromObject(QVariantMap object) {
@@ -57,7 +62,9 @@ void HyprlandWorkspace::updateFromObject(QVariantMap object) {
 	// No events we currently handle give a workspace id but not a name,
 	// so we shouldn't set this if it isn't an initial query
 	if (initial) {
+		auto oldName = this->bName.value();
 		this->bName = object.value("name").value<QString>();
+		this->ipc->updateWorkspaceIndex(this, -1, oldName);
 	}
 
 	if (!monitorName.isEmpty()
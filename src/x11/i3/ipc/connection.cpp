@@ -1,13 +1,12 @@
 #include "connection.hpp"
 #include <array>
 #include <cstring>
-#include <tuple>
+#include <utility>
 
 #include <bit>
 #include <qbytearray.h>
 #include <qbytearrayview.h>
 #include <qcontainerfwd.h>
-#include <qdatastream.h>
 #include <qjsonarray.h>
 #include <qjsondocument.h>
 #include <qjsonobject.h>
@@ -17,7 +16,6 @@
 #include <qloggingcategory.h>
 #include <qnamespace.h>
 #include <qobject.h>
-#include <qsysinfo.h>
 #include <qtenvironmentvariables.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
@@ -29,10 +27,39 @@ namespace qs::i3::ipc {
 namespace {
 QS_LOGGING_CATEGORY(logI3Ipc, "quickshell.I3.ipc", QtWarningMsg);
 QS_LOGGING_CATEGORY(logI3IpcEvents, "quickshell.I3.ipc.events", QtWarningMsg);
+
+// magic string, payload length, payload type
+constexpr qsizetype HEADER_SIZE = 6 + 4 + 4;
 } // namespace
 
 QString I3IpcEvent::type() const { return I3IpcEvent::eventToString(this->mCode); }
-QString I3IpcEvent::data() const { return QString::fromUtf8(this->mData.toJson()); }
+QString I3IpcEvent::data() const { return QString::fromUtf8(this->mPayload); }
+
+const QJsonDocument& I3IpcEvent::json() const {
+	if (!this->jsonParsed) {
+		this->jsonParsed = true;
+
+		// Importing this makes CI builds fail for some reason.
+		QJsonParseError e; // NOLINT (misc-include-cleaner)
+
+		// the payload outlives the document's use, so it does not need to be copied
+		auto payload = QByteArray::fromRawData(this->mPayload.data(), this->mPayload.size());
+		this->mJson = QJsonDocument::fromJson(payload, &e);
+
+		if (e.error != QJsonParseError::NoError) {
+			qCWarning(logI3Ipc) << "Invalid JSON value:" << e.errorString();
+		}
+	}
+
+	return this->mJson;
+}
+
+void I3IpcEvent::setPayload(EventCode code, QByteArrayView payload) {
+	this->mCode = code;
+	this->mPayload = payload;
+	this->mJson = QJsonDocument();
+	this->jsonParsed = false;
+}
 
 EventCode I3IpcEvent::intToEvent(quint32 raw) {
 	if ((EventCode::Workspace <= raw && raw <= EventCode::Input)
@@ -89,9 +116,6 @@ I3Ipc::I3Ipc(const QList<QString>& events): mEvents(events) {
 	QObject::connect(&this->liveEventSocket, &QLocalSocket::readyRead, this, &I3Ipc::eventSocketReady);
 	QObject::connect(&this->liveEventSocket, &QLocalSocket::connected, this, &I3Ipc::subscribe);
 	// clang-format on
-
-	this->liveEventSocketDs.setDevice(&this->liveEventSocket);
-	this->liveEventSocketDs.setByteOrder(static_cast<QDataStream::ByteOrder>(QSysInfo::ByteOrder));
 }
 
 void I3Ipc::makeRequest(const QByteArray& request) {
@@ -128,12 +152,30 @@ void I3Ipc::subscribe() {
 }
 
 void I3Ipc::eventSocketReady() {
-	for (auto& [type, data]: this->parseResponse()) {
-		this->event.mCode = type;
-		this->event.mData = data;
+	if (this->readBuffer.isEmpty()) this->readBuffer = this->liveEventSocket.readAll();
+	else this->readBuffer.append(this->liveEventSocket.readAll());
+
+	auto frames = QList<I3IpcFrame>();
+	auto consumed = I3Ipc::parseFrames(this->readBuffer, frames);
 
+	if (consumed == -1) {
+		qCWarning(logI3Ipc) << "No magic sequence found in string.";
+		this->readBuffer.clear();
+		this->reconnectIPC();
+		return;
+	}
+
+	// Payloads reference the buffer, which is kept alive until all events are delivered.
+	// Only the incomplete message at the end, if any, is copied.
+	auto buffer = std::move(this->readBuffer);
+	this->readBuffer = consumed == buffer.length() ? QByteArray() : buffer.sliced(consumed);
+
+	for (const auto& frame: frames) {
+		this->event.setPayload(frame.code, frame.payload);
 		emit this->rawEvent(&this->event);
 	}
+
+	this->event.setPayload(EventCode::Unknown, QByteArrayView());
 }
 
 void I3Ipc::connect() { this->liveEventSocket.connectToServer(this->mSocketPath); }
@@ -144,54 +186,34 @@ void I3Ipc::reconnectIPC() {
 	this->connect();
 }
 
-QVector<Event> I3Ipc::parseResponse() {
-	QVector<std::tuple<EventCode, QJsonDocument>> events;
-	const int magicLen = 6;
-
-	while (!this->liveEventSocketDs.atEnd()) {
-		this->liveEventSocketDs.startTransaction();
-		this->liveEventSocketDs.startTransaction();
-
-		std::array<char, 6> buffer = {};
-		qint32 size = 0;
-		qint32 type = EventCode::Unknown;
-
-		this->liveEventSocketDs.readRawData(buffer.data(), magicLen);
-		this->liveEventSocketDs >> size;
-		this->liveEventSocketDs >> type;
-
-		if (!this->liveEventSocketDs.commitTransaction()) break;
+qsizetype I3Ipc::parseFrames(QByteArrayView data, QList<I3IpcFrame>& frames) {
+	qsizetype start = 0;
 
-		QByteArray payload(size, Qt::Uninitialized);
+	while (data.size() - start >= HEADER_SIZE) {
+		const auto* header = data.data() + start; // NOLINT
+		if (memcmp(header, MAGIC.data(), 6) != 0) return -1;
 
-		this->liveEventSocketDs.readRawData(payload.data(), size);
+		// both fields are in native byte order
+		quint32 length = 0;
+		quint32 type = 0;
+		memcpy(&length, header + 6, 4); // NOLINT
+		memcpy(&type, header + 10, 4);  // NOLINT
 
-		if (!this->liveEventSocketDs.commitTransaction()) break;
+		auto frameSize = HEADER_SIZE + static_cast<qsizetype>(length);
+		if (data.size() - start < frameSize) break;
 
-		if (strncmp(buffer.data(), MAGIC.data(), 6) != 0) {
-			qCWarning(logI3Ipc) << "No magic sequence found in string.";
-			this->reconnectIPC();
-			break;
-		};
+		auto code = I3IpcEvent::intToEvent(type);
 
-		if (I3IpcEvent::intToEvent(type) == EventCode::Unknown) {
-			qCWarning(logI3Ipc) << "Received unknown event";
-			break;
-		}
-
-		// Importing this makes CI builds fail for some reason.
-		QJsonParseError e; // NOLINT (misc-include-cleaner)
-
-		auto data = QJsonDocument::fromJson(payload, &e);
-		if (e.error != QJsonParseError::NoError) {
-			qCWarning(logI3Ipc) << "Invalid JSON value:" << e.errorString();
-			break;
+		if (code == EventCode::Unknown) {
+			qCWarning(logI3Ipc) << "Received unknown event" << type;
 		} else {
-			events.push_back(std::tuple(I3IpcEvent::intToEvent(type), data));
+			frames.append({.code = code, .payload = data.sliced(start + HEADER_SIZE, length)});
 		}
+
+		start += frameSize;
 	}
 
-	return events;
+	return start;
 }
 
 void I3Ipc::eventSocketError(QLocalSocket::LocalSocketError error) const {
@@ -1,7 +1,8 @@
 #pragma once
 
+#include <qbytearray.h>
 #include <qbytearrayview.h>
-#include <qdatastream.h>
+#include <qcontainerfwd.h>
 #include <qjsondocument.h>
 #include <qlocalsocket.h>
 #include <qobject.h>
@@ -33,7 +34,11 @@ enum EventCode {
 	Unknown = 999,
 };
 
-using Event = std::tuple<EventCode, QJsonDocument>;
+// A message read from the socket. The payload references the read buffer.
+struct I3IpcFrame {
+	EventCode code = EventCode::Unknown;
+	QByteArrayView payload;
+};
 
 ///! I3/Sway IPC Events
 /// Emitted by @@I3.rawEvent(s)
@@ -41,6 +46,7 @@ class I3IpcEvent: public QObject {
 	Q_OBJECT;
 
 	Q_PROPERTY(QString type READ type CONSTANT);
+	/// The JSON payload of the event, as received from the socket.
 	Q_PROPERTY(QString data READ data CONSTANT);
 
 	QML_NAMED_ELEMENT(I3Event);
@@ -52,11 +58,22 @@ public:
 	[[nodiscard]] QString type() const;
 	[[nodiscard]] QString data() const;
 
+	// The payload is only parsed when first requested, as most events are not read
+	// by every consumer.
+	[[nodiscard]] const QJsonDocument& json() const;
+
+	// The payload must outlive the event's current emission.
+	void setPayload(EventCode code, QByteArrayView payload);
+
 	EventCode mCode = EventCode::Unknown;
-	QJsonDocument mData;
+	QByteArrayView mPayload;
 
 	static EventCode intToEvent(uint32_t raw);
 	static QString eventToString(EventCode event);
+
+private:
+	mutable QJsonDocument mJson;
+	mutable bool jsonParsed = false;
 };
 
 /// Base class that manages the IPC socket, subscriptions and event reception.
@@ -77,6 +94,10 @@ public:
 	    const QByteArray& payload = QByteArray()
 	);
 
+	// Appends every complete message at the start of data to frames, returning the number
+	// of bytes consumed, or -1 if data does not start with a message header.
+	static qsizetype parseFrames(QByteArrayView data, QList<I3IpcFrame>& frames);
+
 signals:
 	void connected();
 	void rawEvent(I3IpcEvent* event);
@@ -89,10 +110,10 @@ protected slots:
 
 protected:
 	void reconnectIPC();
-	QVector<std::tuple<EventCode, QJsonDocument>> parseResponse();
 
 	QLocalSocket liveEventSocket;
-	QDataStream liveEventSocketDs;
+	// unconsumed data read from liveEventSocket
+	QByteArray readBuffer;
 
 	QString mSocketPath;
 	bool valid = false;
@@ -5,6 +5,7 @@
 #include <qbytearrayview.h>
 #include <qcontainerfwd.h>
 #include <qdatastream.h>
+#include <qhash.h>
 #include <qjsonarray.h>
 #include <qjsondocument.h>
 #include <qjsonobject.h>
@@ -13,8 +14,10 @@
 #include <qlogging.h>
 #include <qloggingcategory.h>
 #include <qobject.h>
+#include <qset.h>
 #include <qsysinfo.h>
 #include <qtenvironmentvariables.h>
+#include <qtimer.h>
 #include <qtypes.h>
 
 #include "../../../core/logcat.hpp"
@@ -22,6 +25,7 @@
 #include "../../../core/qmlscreen.hpp"
 #include "connection.hpp"
 #include "monitor.hpp"
+#include "toplevel.hpp"
 #include "workspace.hpp"
 
 namespace qs::i3::ipc {
@@ -29,9 +33,19 @@ namespace qs::i3::ipc {
 namespace {
 QS_LOGGING_CATEGORY(logI3Ipc, "quickshell.I3.ipc", QtWarningMsg);
 QS_LOGGING_CATEGORY(logI3IpcEvents, "quickshell.I3.ipc.events", QtWarningMsg);
+
+constexpr qint32 TREE_REFRESH_DELAY_MS = 50;
+
+bool isWindow(const QJsonObject& node) {
+	auto type = node.value("type").toString();
+	if (type != "con" && type != "floating_con") return false;
+
+	// i3 windows have an X11 window id, sway reports a pid for both wayland and X11 windows.
+	return !node.value("window").isNull() || node.contains("pid");
+}
 } // namespace
 
-I3IpcController::I3IpcController(): I3Ipc({"workspace", "output"}) {
+I3IpcController::I3IpcController(): I3Ipc({"workspace", "output", "window"}) {
 	// bind focused workspace to focused monitor's active workspace
 	this->bFocusedWorkspace.setBinding([this]() -> I3Workspace* {
 		if (!this->bFocusedMonitor) return nullptr;
@@ -41,7 +55,11 @@ I3IpcController::I3IpcController(): I3Ipc({"workspace", "output"}) {
 	// clang-format off
 	QObject::connect(this, &I3Ipc::rawEvent, this, &I3IpcController::onEvent);
 	QObject::connect(&this->liveEventSocket, &QLocalSocket::connected, this, &I3IpcController::onConnected);
+	QObject::connect(&this->treeRefreshTimer, &QTimer::timeout, this, &I3IpcController::refreshTree);
 	// clang-format on
+
+	this->treeRefreshTimer.setSingleShot(true);
+	this->treeRefreshTimer.setInterval(TREE_REFRESH_DELAY_MS);
 }
 
 void I3IpcController::onConnected() {
@@ -49,6 +67,8 @@ void I3IpcController::onConnected() {
 	// detected on launch.
 	this->refreshWorkspaces();
 	this->refreshMonitors();
+	// Replies are in request order, so workspaces exist by the time the tree is read.
+	this->refreshTree();
 }
 
 void I3IpcController::setFocusedMonitor(I3Monitor* monitor) {
@@ -89,7 +109,7 @@ void I3IpcController::refreshWorkspaces() {
 }
 
 void I3IpcController::handleGetWorkspacesEvent(I3IpcEvent* event) {
-	auto data = event->mData;
+	auto data = event->json();
 
 	auto workspaces = data.array();
 
@@ -146,7 +166,7 @@ void I3IpcController::refreshMonitors() {
 }
 
 void I3IpcController::handleGetOutputsEvent(I3IpcEvent* event) {
-	auto data = event->mData;
+	auto data = event->json();
 
 	auto monitors = data.array();
 	const auto& mList = this->mMonitors.valueList();
@@ -198,9 +218,125 @@ void I3IpcController::handleGetOutputsEvent(I3IpcEvent* event) {
 	}
 }
 
+void I3IpcController::refreshTree() {
+	this->treeRefreshTimer.stop();
+	this->makeRequest(I3Ipc::buildRequestMessage(EventCode::GetTree));
+}
+
+void I3IpcController::scheduleTreeRefresh() {
+	if (!this->treeRefreshTimer.isActive()) this->treeRefreshTimer.start();
+}
+
+void I3IpcController::handleGetTreeEvent(I3IpcEvent* event) {
+	auto seen = QSet<qint64>();
+	I3Toplevel* focused = nullptr;
+
+	this->updateTreeNode(event->json().object(), nullptr, seen, focused);
+
+	auto removedToplevels = QVector<I3Toplevel*>();
+
+	for (auto* toplevel: this->mToplevels.valueList()) {
+		if (!seen.contains(toplevel->id())) {
+			removedToplevels.push_back(toplevel);
+		}
+	}
+
+	qCDebug(logI3Ipc) << "There are" << seen.size() << "windows, removing"
+	                  << removedToplevels.length() << "closed windows.";
+
+	for (auto* toplevel: removedToplevels) {
+		this->removeToplevel(toplevel);
+	}
+
+	this->bFocusedToplevel = focused;
+}
+
+void I3IpcController::updateTreeNode(
+    const QJsonObject& node,
+    I3Workspace* workspace,
+    QSet<qint64>& seen,
+    I3Toplevel*& focused
+) {
+	if (node.value("type").toString() == "workspace") {
+		// The scratchpad workspace is not listed by get_workspaces, leaving its windows
+		// without a workspace.
+		workspace = this->findWorkspaceByName(node.value("name").toString());
+	} else if (isWindow(node)) {
+		auto id = node.value("id").toInteger(-1);
+		auto* toplevel = this->findToplevelById(id);
+
+		if (toplevel == nullptr) {
+			toplevel = new I3Toplevel(this, id);
+			this->toplevelsById.insert(id, toplevel);
+			this->mToplevels.insertObject(toplevel);
+		}
+
+		toplevel->updateFromObject(node);
+		toplevel->setWorkspace(workspace);
+
+		if (node.value("focused").toBool()) focused = toplevel;
+		seen.insert(id);
+		return;
+	}
+
+	for (auto child: node.value("nodes").toArray()) {
+		this->updateTreeNode(child.toObject(), workspace, seen, focused);
+	}
+
+	for (auto child: node.value("floating_nodes").toArray()) {
+		this->updateTreeNode(child.toObject(), workspace, seen, focused);
+	}
+}
+
+void I3IpcController::handleWindowEvent(I3IpcEvent* event) {
+	const auto& data = event->json();
+	auto change = data["change"].toString();
+	auto container = data["container"].toObject();
+	auto id = container.value("id").toInteger(-1);
+
+	auto* toplevel = this->findToplevelById(id);
+
+	if (change == "close") {
+		if (toplevel != nullptr) {
+			qCInfo(logI3IpcEvents) << "Window" << id << "closed";
+			this->removeToplevel(toplevel);
+		}
+
+		return;
+	}
+
+	if (toplevel == nullptr) {
+		// New windows and windows missed before the tree was read.
+		qCInfo(logI3IpcEvents) << "Window" << id << "added";
+
+		toplevel = new I3Toplevel(this, id);
+		this->toplevelsById.insert(id, toplevel);
+		this->mToplevels.insertObject(toplevel);
+		this->scheduleTreeRefresh();
+	}
+
+	toplevel->updateFromObject(container);
+
+	if (change == "focus") {
+		this->bFocusedToplevel = toplevel;
+	} else if (change == "move" || change == "floating") {
+		this->scheduleTreeRefresh();
+	}
+}
+
+void I3IpcController::removeToplevel(I3Toplevel* toplevel) {
+	if (this->bFocusedToplevel == toplevel) this->bFocusedToplevel = nullptr;
+
+	toplevel->setWorkspace(nullptr);
+	this->toplevelsById.remove(toplevel->id());
+	this->mToplevels.removeObject(toplevel);
+	delete toplevel;
+}
+
 void I3IpcController::onEvent(I3IpcEvent* event) {
 	switch (event->mCode) {
 	case EventCode::Workspace: this->handleWorkspaceEvent(event); return;
+	case EventCode::Window: this->handleWindowEvent(event); return;
 	case EventCode::Output:
 		/// I3 only sends an "unspecified" event, so we have to query the data changes ourselves
 		qCInfo(logI3Ipc) << "Refreshing Monitors...";
@@ -209,6 +345,7 @@ void I3IpcController::onEvent(I3IpcEvent* event) {
 	case EventCode::Subscribe: qCInfo(logI3Ipc) << "Connected to IPC"; return;
 	case EventCode::GetOutputs: this->handleGetOutputsEvent(event); return;
 	case EventCode::GetWorkspaces: this->handleGetWorkspacesEvent(event); return;
+	case EventCode::GetTree: this->handleGetTreeEvent(event); return;
 	case EventCode::RunCommand: I3IpcController::handleRunCommand(event); return;
 	case EventCode::Unknown:
 		qCWarning(logI3Ipc) << "Unknown event:" << event->type() << event->data();
@@ -218,7 +355,7 @@ void I3IpcController::onEvent(I3IpcEvent* event) {
 }
 
 void I3IpcController::handleRunCommand(I3IpcEvent* event) {
-	for (auto r: event->mData.array()) {
+	for (auto r: event->json().array()) {
 		auto obj = r.toObject();
 		const bool success = obj["success"].toBool();
 
@@ -232,12 +369,12 @@ void I3IpcController::handleRunCommand(I3IpcEvent* event) {
 void I3IpcController::handleWorkspaceEvent(I3IpcEvent* event) {
 	// If a workspace doesn't exist, and is being switch to, no focus change event is emited,
 	// only the init one, which does not contain the previously focused workspace
-	auto change = event->mData["change"];
+	auto change = event->json()["change"];
 
 	if (change == "init") {
 		qCInfo(logI3IpcEvents) << "New workspace has been created";
 
-		auto workspaceData = event->mData["current"];
+		auto workspaceData = event->json()["current"];
 
 		auto* workspace = this->findWorkspaceByID(workspaceData["id"].toInt(-1));
 		auto existed = workspace != nullptr;
@@ -255,8 +392,8 @@ void I3IpcController::handleWorkspaceEvent(I3IpcEvent* event) {
 			qCInfo(logI3Ipc) << "Added workspace" << workspace->bindableName().value() << "to list";
 		}
 	} else if (change == "focus") {
-		auto oldData = event->mData["old"];
-		auto newData = event->mData["current"];
+		auto oldData = event->json()["old"];
+		auto newData = event->json()["current"];
 		auto oldName = oldData["name"].toString();
 		auto newName = newData["name"].toString();
 
@@ -274,13 +411,19 @@ void I3IpcController::handleWorkspaceEvent(I3IpcEvent* event) {
 
 		newWorkspace->updateFromObject(newData.toObject().toVariantMap());
 
+		// A window focus event follows unless the workspace is empty.
+		auto* focusedToplevel = this->bFocusedToplevel.value();
+		if (focusedToplevel && focusedToplevel->bindableWorkspace().value() != newWorkspace) {
+			this->bFocusedToplevel = nullptr;
+		}
+
 		if (newWorkspace->bindableMonitor().value()) {
 			auto* monitor = newWorkspace->bindableMonitor().value();
 			monitor->setFocusedWorkspace(newWorkspace);
 			this->bFocusedMonitor = monitor;
 		}
 	} else if (change == "empty") {
-		auto name = event->mData["current"]["name"].toString();
+		auto name = event->json()["current"]["name"].toString();
 
 		auto* oldWorkspace = this->findWorkspaceByName(name);
 
@@ -298,12 +441,12 @@ void I3IpcController::handleWorkspaceEvent(I3IpcEvent* event) {
 			qCInfo(logI3Ipc) << "Workspace" << name << "has already been deleted";
 		}
 	} else if (change == "move" || change == "rename" || change == "urgent") {
-		auto name = event->mData["current"]["name"].toString();
+		auto name = event->json()["current"]["name"].toString();
 
 		auto* workspace = this->findWorkspaceByName(name);
 
 		if (workspace != nullptr) {
-			auto data = event->mData["current"].toObject().toVariantMap();
+			auto data = event->json()["current"].toObject().toVariantMap();
 
 			workspace->updateFromObject(data);
 		} else {
@@ -312,6 +455,7 @@ void I3IpcController::handleWorkspaceEvent(I3IpcEvent* event) {
 	} else if (change == "reload") {
 		qCInfo(logI3Ipc) << "Refreshing Workspaces...";
 		this->refreshWorkspaces();
+		this->refreshTree();
 	}
 }
 
@@ -329,6 +473,10 @@ I3Workspace* I3IpcController::findWorkspaceByID(qint32 id) {
 	return workspaceIter == list.end() ? nullptr : *workspaceIter;
 }
 
+I3Toplevel* I3IpcController::findToplevelById(qint64 id) const {
+	return this->toplevelsById.value(id);
+}
+
 I3Workspace* I3IpcController::findWorkspaceByName(const QString& name) {
 	auto list = this->mWorkspaces.valueList();
 	auto workspaceIter = std::ranges::find_if(list, [name](I3Workspace* m) {
@@ -359,6 +507,7 @@ I3Monitor* I3IpcController::findMonitorByName(const QString& name, bool createIf
 
 ObjectModel<I3Monitor>* I3IpcController::monitors() { return &this->mMonitors; }
 ObjectModel<I3Workspace>* I3IpcController::workspaces() { return &this->mWorkspaces; }
+ObjectModel<I3Toplevel>* I3IpcController::toplevels() { return &this->mToplevels; }
 
 bool I3IpcController::compareWorkspaces(I3Workspace* a, I3Workspace* b) {
 	return a->bindableNumber().value() > b->bindableNumber().value();
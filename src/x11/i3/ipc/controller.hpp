@@ -1,12 +1,15 @@
 #pragma once
 
 #include <qbytearrayview.h>
+#include <qhash.h>
 #include <qjsondocument.h>
 #include <qjsonobject.h>
 #include <qobject.h>
 #include <qproperty.h>
 #include <qqml.h>
 #include <qqmlintegration.h>
+#include <qset.h>
+#include <qtimer.h>
 #include <qtmetamacros.h>
 #include <qtypes.h>
 
@@ -18,14 +21,16 @@ namespace qs::i3::ipc {
 
 class I3Workspace;
 class I3Monitor;
+class I3Toplevel;
 } // namespace qs::i3::ipc
 
 Q_DECLARE_OPAQUE_POINTER(qs::i3::ipc::I3Workspace*);
 Q_DECLARE_OPAQUE_POINTER(qs::i3::ipc::I3Monitor*);
+Q_DECLARE_OPAQUE_POINTER(qs::i3::ipc::I3Toplevel*);
 
 namespace qs::i3::ipc {
 
-/// I3/Sway IPC controller that manages workspaces and monitors
+/// I3/Sway IPC controller that manages workspaces, monitors and windows
 class I3IpcController: public I3Ipc {
 	Q_OBJECT;
 
@@ -35,11 +40,17 @@ public:
 	I3Workspace* findWorkspaceByName(const QString& name);
 	I3Monitor* findMonitorByName(const QString& name, bool createIfMissing = false);
 	I3Workspace* findWorkspaceByID(qint32 id);
+	[[nodiscard]] I3Toplevel* findToplevelById(qint64 id) const;
 
 	void setFocusedMonitor(I3Monitor* monitor);
 
 	void refreshWorkspaces();
 	void refreshMonitors();
+	void refreshTree();
+
+	// Window events do not say which workspace a window is on, so events that may move a
+	// window refresh the tree shortly after. Bursts of events share a single refresh.
+	void scheduleTreeRefresh();
 
 	I3Monitor* monitorFor(QuickshellScreenInfo* screen);
 
@@ -51,12 +62,18 @@ public:
 		return &this->bFocusedWorkspace;
 	};
 
+	[[nodiscard]] QBindable<I3Toplevel*> bindableFocusedToplevel() const {
+		return &this->bFocusedToplevel;
+	};
+
 	[[nodiscard]] ObjectModel<I3Monitor>* monitors();
 	[[nodiscard]] ObjectModel<I3Workspace>* workspaces();
+	[[nodiscard]] ObjectModel<I3Toplevel>* toplevels();
 
 signals:
 	void focusedWorkspaceChanged();
 	void focusedMonitorChanged();
+	void focusedToplevelChanged();
 
 private slots:
 	void onFocusedMonitorDestroyed();
@@ -70,11 +87,24 @@ private:
 	void handleWorkspaceEvent(I3IpcEvent* event);
 	void handleGetWorkspacesEvent(I3IpcEvent* event);
 	void handleGetOutputsEvent(I3IpcEvent* event);
+	void handleGetTreeEvent(I3IpcEvent* event);
+	void handleWindowEvent(I3IpcEvent* event);
+	void updateTreeNode(
+	    const QJsonObject& node,
+	    I3Workspace* workspace,
+	    QSet<qint64>& seen,
+	    I3Toplevel*& focused
+	);
+	void removeToplevel(I3Toplevel* toplevel);
 	static void handleRunCommand(I3IpcEvent* event);
 	static bool compareWorkspaces(I3Workspace* a, I3Workspace* b);
 
 	ObjectModel<I3Monitor> mMonitors {this};
 	ObjectModel<I3Workspace> mWorkspaces {this};
+	ObjectModel<I3Toplevel> mToplevels {this};
+	QHash<qint64, I3Toplevel*> toplevelsById;
+
+	QTimer treeRefreshTimer;
 
 	Q_OBJECT_BINDABLE_PROPERTY(
 	    I3IpcController,
@@ -89,6 +119,13 @@ private:
 	    bFocusedWorkspace,
 	    &I3IpcController::focusedWorkspaceChanged
 	);
+
+	Q_OBJECT_BINDABLE_PROPERTY(
+	    I3IpcController,
+	    I3Toplevel*,
+	    bFocusedToplevel,
+	    &I3IpcController::focusedToplevelChanged
+	);
 };
 
 } // namespace qs::i3::ipc
@@ -8,6 +8,7 @@
 #include "../../../core/qmlscreen.hpp"
 #include "connection.hpp"
 #include "controller.hpp"
+#include "toplevel.hpp"
 #include "workspace.hpp"
 
 namespace qs::i3::ipc {
@@ -20,18 +21,22 @@ I3IpcQml::I3IpcQml() {
 	QObject::connect(instance, &I3Ipc::connected, this, &I3IpcQml::connected);
 	QObject::connect(instance, &I3IpcController::focusedWorkspaceChanged, this, &I3IpcQml::focusedWorkspaceChanged);
 	QObject::connect(instance, &I3IpcController::focusedMonitorChanged, this, &I3IpcQml::focusedMonitorChanged);
+	QObject::connect(instance, &I3IpcController::focusedToplevelChanged, this, &I3IpcQml::focusedToplevelChanged);
 	// clang-format on
 }
 
 void I3IpcQml::dispatch(const QString& request) { I3IpcController::instance()->dispatch(request); }
 void I3IpcQml::refreshMonitors() { I3IpcController::instance()->refreshMonitors(); }
 void I3IpcQml::refreshWorkspaces() { I3IpcController::instance()->refreshWorkspaces(); }
+void I3IpcQml::refreshToplevels() { I3IpcController::instance()->refreshTree(); }
 QString I3IpcQml::socketPath() { return I3IpcController::instance()->socketPath(); }
 ObjectModel<I3Monitor>* I3IpcQml::monitors() { return I3IpcController::instance()->monitors(); }
 ObjectModel<I3Workspace>* I3IpcQml::workspaces() {
 	return I3IpcController::instance()->workspaces();
 }
 
+ObjectModel<I3Toplevel>* I3IpcQml::toplevels() { return I3IpcController::instance()->toplevels(); }
+
 QBindable<I3Workspace*> I3IpcQml::bindableFocusedWorkspace() {
 	return I3IpcController::instance()->bindableFocusedWorkspace();
 }
@@ -40,6 +45,10 @@ QBindable<I3Monitor*> I3IpcQml::bindableFocusedMonitor() {
 	return I3IpcController::instance()->bindableFocusedMonitor();
 }
 
+QBindable<I3Toplevel*> I3IpcQml::bindableFocusedToplevel() {
+	return I3IpcController::instance()->bindableFocusedToplevel();
+}
+
 I3Workspace* I3IpcQml::findWorkspaceByName(const QString& name) {
 	return I3IpcController::instance()->findWorkspaceByName(name);
 }
@@ -48,6 +57,10 @@ I3Monitor* I3IpcQml::findMonitorByName(const QString& name) {
 	return I3IpcController::instance()->findMonitorByName(name);
 }
 
+I3Toplevel* I3IpcQml::findToplevelById(qint64 id) {
+	return I3IpcController::instance()->findToplevelById(id);
+}
+
 I3Monitor* I3IpcQml::monitorFor(QuickshellScreenInfo* screen) {
 	return I3IpcController::instance()->monitorFor(screen);
 }
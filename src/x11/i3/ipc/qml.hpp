@@ -20,12 +20,19 @@ class I3IpcQml: public QObject {
 
 	Q_PROPERTY(qs::i3::ipc::I3Workspace* focusedWorkspace READ default NOTIFY focusedWorkspaceChanged BINDABLE bindableFocusedWorkspace);
 	Q_PROPERTY(qs::i3::ipc::I3Monitor* focusedMonitor READ default NOTIFY focusedMonitorChanged BINDABLE bindableFocusedMonitor);
+	/// The currently focused window, or null if no window is focused.
+	Q_PROPERTY(qs::i3::ipc::I3Toplevel* focusedToplevel READ default NOTIFY focusedToplevelChanged BINDABLE bindableFocusedToplevel);
 	/// All I3 monitors.
 	QSDOC_TYPE_OVERRIDE(ObjectModel<qs::i3::ipc::I3Monitor>*);
 	Q_PROPERTY(UntypedObjectModel* monitors READ monitors CONSTANT);
 	/// All I3 workspaces.
 	QSDOC_TYPE_OVERRIDE(ObjectModel<qs::i3::ipc::I3Workspace>*);
 	Q_PROPERTY(UntypedObjectModel* workspaces READ workspaces CONSTANT);
+	/// All I3 windows, including floating and scratchpad windows.
+	///
+	/// Windows are kept up to date from `window` events instead of polling `get_tree`.
+	QSDOC_TYPE_OVERRIDE(ObjectModel<qs::i3::ipc::I3Toplevel>*);
+	Q_PROPERTY(UntypedObjectModel* toplevels READ toplevels CONSTANT);
 	// clang-format on
 	QML_NAMED_ELEMENT(I3);
 	QML_SINGLETON;
@@ -42,12 +49,21 @@ public:
 	/// Refresh workspace information.
 	Q_INVOKABLE static void refreshWorkspaces();
 
+	/// Refresh window information.
+	///
+	/// Windows are updated automatically, so this is only needed if they have drifted
+	/// from i3/Sway's state.
+	Q_INVOKABLE static void refreshToplevels();
+
 	/// Find an I3Workspace using its name, returns null if the workspace doesn't exist.
 	Q_INVOKABLE static I3Workspace* findWorkspaceByName(const QString& name);
 
 	/// Find an I3Monitor using its name, returns null if the monitor doesn't exist.
 	Q_INVOKABLE static I3Monitor* findMonitorByName(const QString& name);
 
+	/// Find an I3Toplevel using its con id, returns null if the window doesn't exist.
+	Q_INVOKABLE static I3Toplevel* findToplevelById(qint64 id);
+
 	/// Return the i3/Sway monitor associated with `screen`
 	Q_INVOKABLE static I3Monitor* monitorFor(QuickshellScreenInfo* screen);
 
@@ -60,17 +76,24 @@ public:
 	/// All I3Workspaces
 	[[nodiscard]] static ObjectModel<I3Workspace>* workspaces();
 
+	/// All I3Toplevels
+	[[nodiscard]] static ObjectModel<I3Toplevel>* toplevels();
+
 	/// The currently focused Workspace
 	[[nodiscard]] static QBindable<I3Workspace*> bindableFocusedWorkspace();
 
 	/// The currently focused Monitor
 	[[nodiscard]] static QBindable<I3Monitor*> bindableFocusedMonitor();
 
+	/// The currently focused Toplevel
+	[[nodiscard]] static QBindable<I3Toplevel*> bindableFocusedToplevel();
+
 signals:
 	void rawEvent(I3IpcEvent* event);
 	void connected();
 	void focusedWorkspaceChanged();
 	void focusedMonitorChanged();
+	void focusedToplevelChanged();
 };
 
 } // namespace qs::i3::ipc
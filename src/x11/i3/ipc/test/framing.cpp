@@ -0,0 +1,165 @@
+#include "framing.hpp"
+
+#include <qbytearray.h>
+#include <qcontainerfwd.h>
+#include <qjsondocument.h>
+#include <qlist.h>
+#include <qtest.h>
+#include <qtestcase.h>
+#include <qtypes.h>
+
+#include "../connection.hpp"
+
+using namespace qs::i3::ipc;
+
+namespace {
+
+QByteArray message(EventCode code, const QByteArray& payload) {
+	return I3Ipc::buildRequestMessage(code, payload);
+}
+
+// A stream shaped like the output of a busy sway session subscribed to window and
+// workspace events: mostly focus and title changes, with the odd workspace switch.
+QByteArray recordedStream(qsizetype events) {
+	auto stream = QByteArray();
+
+	for (qsizetype i = 0; i < events; i++) {
+		auto id = QByteArray::number(10 + (i % 24));
+
+		if (i % 16 == 0) {
+			stream.append(message(
+			    EventCode::Workspace,
+			    R"({"change":"focus","current":{"id":)" + id
+			        + R"(,"type":"workspace","name":"2","num":2,"focused":true,"urgent":false,)"
+			          R"("output":"DP-1","rect":{"x":0,"y":0,"width":2560,"height":1440},)"
+			          R"("nodes":[],"floating_nodes":[]},"old":{"id":4,"type":"workspace",)"
+			          R"("name":"1","num":1,"focused":false,"urgent":false,"output":"DP-1"}})"
+			));
+		} else {
+			auto change = i % 3 == 0 ? QByteArray("title") : QByteArray("focus");
+			stream.append(message(
+			    EventCode::Window,
+			    R"({"change":")" + change + R"(","container":{"id":)" + id
+			        + R"(,"type":"con","orientation":"none","percent":0.5,"urgent":false,)"
+			          R"("marks":[],"focused":true,"layout":"none","border":"pixel",)"
+			          R"("current_border_width":2,"rect":{"x":0,"y":0,"width":1280,"height":1440},)"
+			          R"("name":"Terminal )"
+			        + QByteArray::number(i)
+			        + R"(","app_id":"foot","pid":4242,"visible":true,"shell":"xdg_shell",)"
+			          R"("inhibit_idle":false,"nodes":[],"floating_nodes":[]}})"
+			));
+		}
+	}
+
+	return stream;
+}
+
+} // namespace
+
+void TestI3Framing::frames() {
+	auto data = message(EventCode::Window, R"({"change":"new"})")
+	          + message(EventCode::Workspace, R"({"change":"init"})")
+	          + message(EventCode::GetTree, "");
+
+	auto frames = QList<I3IpcFrame>();
+	auto consumed = I3Ipc::parseFrames(data, frames);
+
+	QCOMPARE(consumed, data.length());
+	QCOMPARE(frames.length(), 3);
+	QCOMPARE(frames[0].code, EventCode::Window);
+	QCOMPARE(frames[0].payload.toByteArray(), R"({"change":"new"})");
+	QCOMPARE(frames[1].code, EventCode::Workspace);
+	QCOMPARE(frames[1].payload.toByteArray(), R"({"change":"init"})");
+	QCOMPARE(frames[2].code, EventCode::GetTree);
+	QVERIFY(frames[2].payload.isEmpty());
+}
+
+void TestI3Framing::splitReads() {
+	auto data = recordedStream(64);
+
+	auto expected = QList<I3IpcFrame>();
+	QCOMPARE(I3Ipc::parseFrames(data, expected), data.length());
+	QCOMPARE(expected.length(), 64);
+
+	// feed the stream in reads that split headers and payloads at every offset
+	for (qsizetype readSize: {1, 5, 13, 14, 15, 97, 1024}) {
+		auto buffer = QByteArray();
+		auto payloads = QList<QByteArray>();
+
+		for (qsizetype offset = 0; offset < data.length(); offset += readSize) {
+			buffer.append(data.sliced(offset, qMin(readSize, data.length() - offset)));
+
+			auto frames = QList<I3IpcFrame>();
+			auto consumed = I3Ipc::parseFrames(buffer, frames);
+			QVERIFY(consumed != -1);
+
+			for (const auto& frame: frames) payloads.append(frame.payload.toByteArray());
+			buffer.remove(0, consumed);
+		}
+
+		QVERIFY(buffer.isEmpty());
+		QCOMPARE(payloads.length(), expected.length());
+		for (auto i = 0; i < payloads.length(); i++) QCOMPARE(payloads[i], expected[i].payload.toByteArray());
+	}
+}
+
+void TestI3Framing::badMagic() {
+	auto data = message(EventCode::Window, "{}") + QByteArray("i3-icp") + QByteArray(8, 0);
+
+	auto frames = QList<I3IpcFrame>();
+	QCOMPARE(I3Ipc::parseFrames(data, frames), -1);
+}
+
+void TestI3Framing::lazyJson() {
+	auto payload = QByteArray(R"({"change":"focus","container":{"id":7}})");
+
+	auto event = I3IpcEvent(nullptr);
+	event.setPayload(EventCode::Window, payload);
+
+	QCOMPARE(event.data(), QString::fromUtf8(payload));
+	QCOMPARE(event.json()["container"]["id"].toInt(), 7);
+
+	event.setPayload(EventCode::Window, R"({"change":"close"})");
+	QCOMPARE(event.json()["change"].toString(), "close");
+}
+
+void TestI3Framing::benchmarkReplay_data() {
+	QTest::addColumn<bool>("parseJson");
+
+	QTest::addRow("framing") << false;
+	QTest::addRow("framing + json") << true;
+}
+
+void TestI3Framing::benchmarkReplay() {
+	QFETCH(bool, parseJson);
+
+	constexpr qsizetype READ_SIZE = 64 * 1024;
+
+	auto data = recordedStream(20000);
+	auto event = I3IpcEvent(nullptr);
+	qsizetype count = 0;
+
+	QBENCHMARK {
+		auto buffer = QByteArray();
+		count = 0;
+
+		for (qsizetype offset = 0; offset < data.length(); offset += READ_SIZE) {
+			buffer.append(data.sliced(offset, qMin(READ_SIZE, data.length() - offset)));
+
+			auto frames = QList<I3IpcFrame>();
+			auto consumed = I3Ipc::parseFrames(buffer, frames);
+
+			for (const auto& frame: frames) {
+				event.setPayload(frame.code, frame.payload);
+				if (parseJson && event.json().isNull()) QFAIL("invalid json");
+				count++;
+			}
+
+			buffer.remove(0, consumed);
+		}
+	}
+
+	QCOMPARE(count, 20000);
+}
+
+QTEST_MAIN(TestI3Framing);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+class TestI3Framing: public QObject {
+	Q_OBJECT;
+
+private slots:
+	static void frames();
+	static void splitReads();
+	static void badMagic();
+	static void lazyJson();
+
+	static void benchmarkReplay_data(); // NOLINT
+	static void benchmarkReplay();
+};
@@ -0,0 +1,79 @@
+#include "toplevel.hpp"
+
+#include <qcontainerfwd.h>
+#include <qjsonarray.h>
+#include <qjsonobject.h>
+#include <qjsonvalue.h>
+#include <qobject.h>
+#include <qproperty.h>
+#include <qstring.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+
+#include "controller.hpp"
+#include "workspace.hpp"
+
+namespace qs::i3::ipc {
+
+I3Toplevel::I3Toplevel(I3IpcController* ipc, qint64 id): QObject(ipc), ipc(ipc), mId(id) {
+	this->bFocused.setBinding([this]() {
+		return this->ipc->bindableFocusedToplevel().value() == this;
+	});
+}
+
+QVariantMap I3Toplevel::lastIpcObject() const { return this->mLastIpcObject.toVariantMap(); }
+
+void I3Toplevel::updateFromObject(const QJsonObject& obj) {
+	if (obj != this->mLastIpcObject) {
+		this->mLastIpcObject = obj;
+		emit this->lastIpcObjectChanged();
+	}
+
+	// Sway reports xwayland and i3 windows without an app id.
+	auto appId = obj.value("app_id").toString();
+	if (appId.isEmpty()) appId = obj.value("window_properties")["class"].toString();
+
+	auto marks = QList<QString>();
+	for (auto mark: obj.value("marks").toArray()) {
+		marks.append(mark.toString());
+	}
+
+	// Sway marks floating windows by type, i3 by the floating state.
+	auto floating = obj.value("type").toString() == "floating_con"
+	             || obj.value("floating").toString().endsWith("_on");
+
+	Qt::beginPropertyUpdateGroup();
+
+	this->bTitle = obj.value("name").toString();
+	this->bAppId = appId;
+	this->bPid = obj.value("pid").toInt(-1);
+	this->bUrgent = obj.value("urgent").toBool();
+	this->bFullscreen = obj.value("fullscreen_mode").toInt() != 0;
+	this->bFloating = floating;
+	this->bMarks = marks;
+
+	Qt::endPropertyUpdateGroup();
+}
+
+void I3Toplevel::setWorkspace(I3Workspace* workspace) {
+	auto* oldWorkspace = this->bWorkspace.value();
+	if (workspace == oldWorkspace) return;
+
+	if (oldWorkspace != nullptr) {
+		oldWorkspace->removeToplevel(this);
+		QObject::disconnect(oldWorkspace, nullptr, this, nullptr);
+	}
+
+	if (workspace != nullptr) {
+		workspace->insertToplevel(this);
+		QObject::connect(workspace, &QObject::destroyed, this, &I3Toplevel::onWorkspaceDestroyed);
+	}
+
+	this->bWorkspace = workspace;
+}
+
+void I3Toplevel::onWorkspaceDestroyed() { this->bWorkspace = nullptr; }
+
+void I3Toplevel::activate() { this->ipc->dispatch(QString("[con_id=%1] focus").arg(this->mId)); }
+
+} // namespace qs::i3::ipc
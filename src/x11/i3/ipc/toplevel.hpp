@@ -0,0 +1,115 @@
+#pragma once
+
+#include <qcontainerfwd.h>
+#include <qjsonobject.h>
+#include <qobject.h>
+#include <qproperty.h>
+#include <qqmlintegration.h>
+#include <qtmetamacros.h>
+#include <qtypes.h>
+
+#include "controller.hpp"
+
+namespace qs::i3::ipc {
+
+class I3Workspace;
+
+///! I3/Sway windows
+/// A window in the i3/Sway layout tree.
+///
+/// Toplevels are created from the tree when quickshell connects and kept up to date
+/// by `window` events, so reading them does not require polling `get_tree`.
+class I3Toplevel: public QObject {
+	Q_OBJECT;
+	// clang-format off
+	/// The con ID of this window, it is unique for i3/Sway launch
+	Q_PROPERTY(qint64 id READ id CONSTANT);
+	/// The title of this window
+	Q_PROPERTY(QString title READ default NOTIFY titleChanged BINDABLE bindableTitle);
+	/// The wayland app id of this window, or its window class if it is an X11 window.
+	Q_PROPERTY(QString appId READ default NOTIFY appIdChanged BINDABLE bindableAppId);
+	/// The process id of this window, or -1 if i3/Sway does not report it
+	Q_PROPERTY(qint32 pid READ default NOTIFY pidChanged BINDABLE bindablePid);
+	/// If this window is currently focused
+	Q_PROPERTY(bool focused READ default NOTIFY focusedChanged BINDABLE bindableFocused);
+	/// If this window has an urgent notification
+	Q_PROPERTY(bool urgent READ default NOTIFY urgentChanged BINDABLE bindableUrgent);
+	/// If this window is fullscreen, either on its workspace or globally
+	Q_PROPERTY(bool fullscreen READ default NOTIFY fullscreenChanged BINDABLE bindableFullscreen);
+	/// If this window is floating
+	Q_PROPERTY(bool floating READ default NOTIFY floatingChanged BINDABLE bindableFloating);
+	/// The marks set on this window
+	Q_PROPERTY(QList<QString> marks READ default NOTIFY marksChanged BINDABLE bindableMarks);
+	/// The workspace this window is on. Null for scratchpad windows.
+	Q_PROPERTY(qs::i3::ipc::I3Workspace* workspace READ default NOTIFY workspaceChanged BINDABLE bindableWorkspace);
+	/// Last JSON returned for this window, as a JavaScript object.
+	///
+	/// This updates every time we receive a `window` event for this window from i3/Sway
+	Q_PROPERTY(QVariantMap lastIpcObject READ lastIpcObject NOTIFY lastIpcObjectChanged);
+	// clang-format on
+	QML_ELEMENT;
+	QML_UNCREATABLE("I3Toplevels must be retrieved from the I3 object.");
+
+public:
+	I3Toplevel(I3IpcController* ipc, qint64 id);
+
+	/// Focus the window.
+	///
+	/// > [!NOTE] This is equivalent to running
+	/// > ```qml
+	/// > I3.dispatch(`[con_id=${toplevel.id}] focus`);
+	/// > ```
+	Q_INVOKABLE void activate();
+
+	[[nodiscard]] qint64 id() const { return this->mId; }
+	[[nodiscard]] QBindable<QString> bindableTitle() { return &this->bTitle; }
+	[[nodiscard]] QBindable<QString> bindableAppId() { return &this->bAppId; }
+	[[nodiscard]] QBindable<qint32> bindablePid() { return &this->bPid; }
+	[[nodiscard]] QBindable<bool> bindableFocused() { return &this->bFocused; }
+	[[nodiscard]] QBindable<bool> bindableUrgent() { return &this->bUrgent; }
+	[[nodiscard]] QBindable<bool> bindableFullscreen() { return &this->bFullscreen; }
+	[[nodiscard]] QBindable<bool> bindableFloating() { return &this->bFloating; }
+	[[nodiscard]] QBindable<QList<QString>> bindableMarks() { return &this->bMarks; }
+	[[nodiscard]] QBindable<I3Workspace*> bindableWorkspace() { return &this->bWorkspace; }
+	[[nodiscard]] QVariantMap lastIpcObject() const;
+
+	// The object is a container node from get_tree or a window event.
+	void updateFromObject(const QJsonObject& obj);
+	void setWorkspace(I3Workspace* workspace);
+
+signals:
+	void titleChanged();
+	void appIdChanged();
+	void pidChanged();
+	void focusedChanged();
+	void urgentChanged();
+	void fullscreenChanged();
+	void floatingChanged();
+	void marksChanged();
+	void workspaceChanged();
+	void lastIpcObjectChanged();
+
+private slots:
+	void onWorkspaceDestroyed();
+
+private:
+	I3IpcController* ipc;
+	qint64 mId;
+
+	// Converted to a QVariantMap only when read, as most windows are never inspected.
+	QJsonObject mLastIpcObject;
+
+	// clang-format off
+	Q_OBJECT_BINDABLE_PROPERTY(I3Toplevel, QString, bTitle, &I3Toplevel::titleChanged);
+	Q_OBJECT_BINDABLE_PROPERTY(I3Toplevel, QString, bAppId, &I3Toplevel::appIdChanged);
+	Q_OBJECT_BINDABLE_PROPERTY_WITH_ARGS(I3Toplevel, qint32, bPid, -1, &I3Toplevel::pidChanged);
+	Q_OBJECT_BINDABLE_PROPERTY(I3Toplevel, bool, bFocused, &I3Toplevel::focusedChanged);
+	Q_OBJECT_BINDABLE_PROPERTY(I3Toplevel, bool, bUrgent, &I3Toplevel::urgentChanged);
+	Q_OBJECT_BINDABLE_PROPERTY(I3Toplevel, bool, bFullscreen, &I3Toplevel::fullscreenChanged);
+	Q_OBJECT_BINDABLE_PROPERTY(I3Toplevel, bool, bFloating, &I3Toplevel::floatingChanged);
+	Q_OBJECT_BINDABLE_PROPERTY(I3Toplevel, QList<QString>, bMarks, &I3Toplevel::marksChanged);
+	Q_OBJECT_BINDABLE_PROPERTY(I3Toplevel, I3Workspace*, bWorkspace, &I3Toplevel::workspaceChanged);
+	// clang-format on
+};
+
+} // namespace qs::i3::ipc
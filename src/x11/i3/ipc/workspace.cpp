@@ -9,6 +9,7 @@
 
 #include "controller.hpp"
 #include "monitor.hpp"
+#include "toplevel.hpp"
 
 namespace qs::i3::ipc {
 
@@ -54,6 +55,9 @@ void I3Workspace::updateFromObject(const QVariantMap& obj) {
 	Qt::endPropertyUpdateGroup();
 }
 
+void I3Workspace::insertToplevel(I3Toplevel* toplevel) { this->mToplevels.insertObject(toplevel); }
+void I3Workspace::removeToplevel(I3Toplevel* toplevel) { this->mToplevels.removeObject(toplevel); }
+
 void I3Workspace::activate() {
 	this->ipc->dispatch(QString("workspace number %1").arg(this->bNumber.value()));
 }
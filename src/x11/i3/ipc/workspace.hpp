@@ -4,12 +4,15 @@
 #include <qproperty.h>
 #include <qtypes.h>
 
+#include "../../../core/doc.hpp"
+#include "../../../core/model.hpp"
 #include "connection.hpp"
 #include "controller.hpp"
 
 namespace qs::i3::ipc {
 
 class I3Monitor;
+class I3Toplevel;
 
 ///! I3/Sway workspaces
 class I3Workspace: public QObject {
@@ -32,6 +35,9 @@ class I3Workspace: public QObject {
 	Q_PROPERTY(bool focused READ default NOTIFY focusedChanged BINDABLE bindableFocused);
 	/// The monitor this workspace is being displayed on
 	Q_PROPERTY(qs::i3::ipc::I3Monitor* monitor READ default NOTIFY monitorChanged BINDABLE bindableMonitor);
+	/// The windows on this workspace, including floating windows.
+	QSDOC_TYPE_OVERRIDE(ObjectModel<qs::i3::ipc::I3Toplevel>*);
+	Q_PROPERTY(UntypedObjectModel* toplevels READ toplevels CONSTANT);
 	/// Last JSON returned for this workspace, as a JavaScript object.
 	///
 	/// This updates every time we receive a `workspace` event from i3/Sway
@@ -59,9 +65,13 @@ public:
 	[[nodiscard]] QBindable<bool> bindableUrgent() { return &this->bUrgent; }
 	[[nodiscard]] QBindable<I3Monitor*> bindableMonitor() { return &this->bMonitor; }
 	[[nodiscard]] QVariantMap lastIpcObject() const;
+	[[nodiscard]] ObjectModel<I3Toplevel>* toplevels() { return &this->mToplevels; }
 
 	void updateFromObject(const QVariantMap& obj);
 
+	void insertToplevel(I3Toplevel* toplevel);
+	void removeToplevel(I3Toplevel* toplevel);
+
 signals:
 	void idChanged();
 	void nameChanged();
@@ -76,6 +86,7 @@ private:
 	I3IpcController* ipc;
 
 	QVariantMap mLastIpcObject;
+	ObjectModel<I3Toplevel> mToplevels {this};
 
 	// clang-format off
 	Q_OBJECT_BINDABLE_PROPERTY_WITH_ARGS(I3Workspace, qint32, bId, -1, &I3Workspace::idChanged);